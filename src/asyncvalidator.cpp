@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        asyncvalidator.cpp
+ * \brief       Source file implementing the asynchronous batching validator
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p AsyncValidator. A single thread
+ * collects the submitted IBANs and validates a batch once it is full or its
+ * oldest IBAN reaches the deadline.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <memory>
+#include "asyncvalidator.h"
+#include "libiban.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p AsyncValidator.
+     *
+     * @param maxBatch Batches are validated as soon as they reach this size
+     *        (default: 256)
+     * @param deadline Maximum time an IBAN waits for its batch to fill up
+     *        (default: 100 microseconds)
+     * @param executor Runs the completion of each batch, which calls the
+     *        callbacks of its IBANs; by default they are called in the
+     *        batching thread
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
+     */
+    AsyncValidator::AsyncValidator(size_t maxBatch,
+                                   std::chrono::microseconds deadline,
+                                   const Executor& executor,
+                                   bool checkNational) :
+            m_maxBatch(std::max<size_t>(1, maxBatch)), m_deadline(deadline),
+            m_executor(executor), m_checkNational(checkNational),
+            m_flushRequested(false), m_stop(false), m_batches(0) {
+        m_pending.reserve(m_maxBatch);
+        m_thread = std::thread(&AsyncValidator::run, this);
+    }
+
+    /**
+     * Destructor of \p AsyncValidator. Validates the pending IBANs and waits
+     * for the batching thread.
+     */
+    AsyncValidator::~AsyncValidator() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    /**
+     * Submits an IBAN for validation. The IBAN is copied, so \p data need not
+     * stay valid. \p callback is called with the result once the batch of
+     * the IBAN is validated.
+     *
+     * @param data The IBAN in machine or human readable form
+     * @param length The length of \p data
+     * @param callback Receives the result
+     */
+    void AsyncValidator::submit(const char* data, size_t length,
+                                const Callback& callback) {
+        PendingValidation pending;
+        pending.length = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (std::isspace(static_cast<unsigned char>(data[i]))) {
+                continue;
+            }
+            if (pending.length == sizeof(pending.iban)) {
+                pending.length = 0;
+                break;
+            }
+            pending.iban[pending.length++] = data[i];
+        }
+        pending.callback = callback;
+
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty()) {
+                m_oldest = std::chrono::steady_clock::now();
+            }
+            m_pending.push_back(std::move(pending));
+            // the first IBAN starts the deadline, a full batch ends it
+            wake = m_pending.size() == 1 || m_pending.size() == m_maxBatch;
+        }
+        if (wake) {
+            m_wake.notify_one();
+        }
+    }
+
+    /**
+     * Submits an IBAN for validation (see above) and returns a future
+     * receiving the result.
+     *
+     * @param data The IBAN in machine or human readable form
+     * @param length The length of \p data
+     * @return The future result
+     */
+    std::future<bool> AsyncValidator::submit(const char* data, size_t length) {
+        std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>());
+        submit(data, length, [promise](bool valid) {
+            promise->set_value(valid);
+        });
+        return promise->get_future();
+    }
+
+    /**
+     * Validates the pending IBANs without waiting for the deadline. Has no
+     * effect if no IBAN is pending, so later submissions keep their deadline.
+     */
+    void AsyncValidator::flush() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty()) {
+                return;
+            }
+            m_flushRequested = true;
+        }
+        m_wake.notify_one();
+    }
+
+    /**
+     * Returns the number of batches validated so far.
+     *
+     * @return The number of batches
+     */
+    size_t AsyncValidator::getBatchCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batches;
+    }
+
+    /**
+     * Main loop of the batching thread.
+     */
+    void AsyncValidator::run() {
+        std::vector<PendingValidation> batch;
+        batch.reserve(m_maxBatch);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+            if (m_pending.empty()) {
+                return;
+            }
+            m_wake.wait_until(lock, m_oldest + m_deadline, [this]() {
+                return m_stop || m_flushRequested || m_pending.size() >= m_maxBatch;
+            });
+            if (m_pending.size() > m_maxBatch) {
+                // keep the IBANs submitted while the batch was taken for the
+                // next one; their deadline still starts at the oldest IBAN
+                auto end = m_pending.begin() + static_cast<std::ptrdiff_t>(m_maxBatch);
+                batch.assign(std::make_move_iterator(m_pending.begin()),
+                             std::make_move_iterator(end));
+                m_pending.erase(m_pending.begin(), end);
+            } else {
+                batch.swap(m_pending);
+                m_flushRequested = false;
+            }
+            m_batches++;
+            lock.unlock();
+            process(batch);
+            batch.clear();
+            lock.lock();
+        }
+    }
+
+    /**
+     * Validates a batch and completes its IBANs. \p validateBatch() needs
+     * IBANs of equal length, so the batch is grouped by length first.
+     *
+     * @param batch The batch
+     */
+    void AsyncValidator::process(std::vector<PendingValidation>& batch) const {
+        std::shared_ptr<std::vector<unsigned char>> results(
+                new std::vector<unsigned char>(batch.size(), 0));
+        std::vector<size_t> order(batch.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return batch[a].length < batch[b].length;
+        });
+
+        std::vector<char> ibans;
+        std::unique_ptr<bool[]> valid(new bool[batch.size()]);
+        for (size_t begin = 0, end = 0; begin < order.size(); begin = end) {
+            size_t length = batch[order[begin]].length;
+            ibans.clear();
+            for (end = begin; end < order.size() && batch[order[end]].length == length; end++) {
+                ibans.insert(ibans.end(), batch[order[end]].iban,
+                             batch[order[end]].iban + length);
+            }
+            if (length == 0) {
+                continue;
+            }
+            IBAN::validateBatch(ibans.data(), length, end - begin, valid.get(),
+                                m_checkNational);
+            for (size_t i = begin; i < end; i++) {
+                (*results)[order[i]] = valid[i - begin] ? 1 : 0;
+            }
+        }
+
+        std::shared_ptr<std::vector<Callback>> callbacks(new std::vector<Callback>());
+        callbacks->reserve(batch.size());
+        for (auto& pending : batch) {
+            callbacks->push_back(std::move(pending.callback));
+        }
+        std::function<void()> complete = [callbacks, results]() {
+            for (size_t i = 0; i < callbacks->size(); i++) {
+                if ((*callbacks)[i]) {
+                    (*callbacks)[i]((*results)[i] != 0);
+                }
+            }
+        };
+        if (m_executor) {
+            m_executor(complete);
+        } else {
+            complete();
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        asyncvalidator.h
+ * \brief       Header file declaring the asynchronous batching validator
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a validator accepting single IBANs from many
+ * threads and validating them in micro-batches with \p validateBatch(),
+ * trading a bounded latency for throughput.
+ */
+
+#ifndef LIBIBAN_ASYNCVALIDATOR_H
+#define LIBIBAN_ASYNCVALIDATOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace IBAN {
+
+/// IBAN waiting for validation
+struct PendingValidation {
+    /// The machine form of the IBAN
+    char iban[34];
+    /// The length of \p iban; 0 if the input did not fit
+    size_t length;
+    /// Receives the result
+    std::function<void(bool)> callback;
+};
+
+/// Validates IBANs submitted by many threads in micro-batches
+class AsyncValidator {
+
+public:
+    /// Receives the result of a validation
+    typedef std::function<void(bool valid)> Callback;
+    /// Runs the completion of a batch, for example on the caller's executor
+    typedef std::function<void(std::function<void()>)> Executor;
+
+private:
+    /// Batches are validated as soon as they reach this size
+    size_t m_maxBatch;
+    /// Maximum time an IBAN waits for its batch to fill up
+    std::chrono::microseconds m_deadline;
+    /// Runs the completions; \p nullptr to run them in the batching thread
+    Executor m_executor;
+    /// Whether national check digits are checked
+    bool m_checkNational;
+    /// Protects the state below
+    std::mutex m_mutex;
+    /// Wakes the batching thread
+    std::condition_variable m_wake;
+    /// The IBANs of the next batch
+    std::vector<PendingValidation> m_pending;
+    /// Submission time of the first IBAN of the next batch
+    std::chrono::steady_clock::time_point m_oldest;
+    /// Whether the next batch should be validated without waiting
+    bool m_flushRequested;
+    /// Set when the validator is destroyed
+    bool m_stop;
+    /// Number of batches validated
+    size_t m_batches;
+    /// The batching thread
+    std::thread m_thread;
+
+    void run();
+    void process(std::vector<PendingValidation>& batch) const;
+
+public:
+    AsyncValidator(size_t maxBatch = 256,
+                   std::chrono::microseconds deadline = std::chrono::microseconds(100),
+                   const Executor& executor = nullptr, bool checkNational = false);
+    ~AsyncValidator();
+    AsyncValidator(const AsyncValidator&) = delete;
+    AsyncValidator& operator=(const AsyncValidator&) = delete;
+
+    void submit(const char* data, size_t length, const Callback& callback);
+    std::future<bool> submit(const char* data, size_t length);
+    void flush();
+    size_t getBatchCount();
+
+}; // end of class AsyncValidator
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_ASYNCVALIDATOR_H
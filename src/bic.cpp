@@ -0,0 +1,490 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        bic.cpp
+ * \brief       Source file implementing BICs and IBAN/BIC consistency checks
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p BIC, the \p BankDirectory and the
+ * consistency checks between IBANs and BICs.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include "bic.h"
+#include "conversion.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p BICParseException.
+     *
+     * @param bic The string causing the exception
+     */
+    BICParseException::BICParseException(const std::string& bic) noexcept :
+            m_bic(bic) {
+        m_message = "Cannot parse BIC " + m_bic;
+    }
+
+    /**
+     * Destructor of \p BICParseException
+     */
+    BICParseException::~BICParseException() {}
+
+    /**
+     * Overrides the function \p what() for this exception and returns a
+     * string describing the error.
+     *
+     * @return A string describing the error
+     */
+    const char* BICParseException::what() const noexcept {
+        return m_message.c_str();
+    }
+
+    /**
+     * Checks the structure of a BIC: four letters identifying the bank, two
+     * letters of the country code, two alphanumerical characters of the
+     * location code and optionally three alphanumerical characters of the
+     * branch code. Letters may be in either case.
+     *
+     * @param data Pointer to the first character
+     * @param length The number of characters
+     * @return \p true if the structure is valid, \p false otherwise
+     */
+    static bool isStructureValid(const char* data, size_t length) {
+        if (length != 8 && length != 11) {
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            int value = getCharValue(data[i]);
+            if (value < 0 || (i < 6 && value < 10)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Creates a BIC from a string. Whitespace is ignored and letters may be
+     * in either case. Throws a \p BICParseException if the string is not a
+     * structurally valid BIC.
+     *
+     * @param string The string to parse
+     * @return The BIC
+     */
+    BIC BIC::createFromString(const std::string& string) {
+        std::string s = string;
+        trim(s);
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        if (!isStructureValid(s.data(), s.length())) {
+            throw BICParseException(string);
+        }
+        return BIC(s);
+    }
+
+    /**
+     * Returns the four letters identifying the bank.
+     *
+     * @return The bank code
+     */
+    std::string BIC::getBankCode() const {
+        return m_bic.substr(0, 4);
+    }
+
+    /**
+     * Returns the country code of the BIC.
+     *
+     * @return The country code
+     */
+    std::string BIC::getCountryCode() const {
+        return m_bic.substr(4, 2);
+    }
+
+    /**
+     * Returns the location code of the BIC.
+     *
+     * @return The location code
+     */
+    std::string BIC::getLocationCode() const {
+        return m_bic.substr(6, 2);
+    }
+
+    /**
+     * Returns the branch code of the BIC. BICs with eight characters denote
+     * the primary office, so "XXX" is returned for them.
+     *
+     * @return The branch code
+     */
+    std::string BIC::getBranchCode() const {
+        return m_bic.length() == 11 ? m_bic.substr(8) : "XXX";
+    }
+
+    /**
+     * Returns the BIC as given (8 or 11 characters, upper case).
+     *
+     * @return The BIC
+     */
+    std::string BIC::toString() const {
+        return m_bic;
+    }
+
+    /**
+     * Checks whether the BIC is a test BIC, which is marked by a 0 as the
+     * second character of the location code.
+     *
+     * @return \p true for test BICs
+     */
+    bool BIC::isTestBIC() const {
+        return m_bic[7] == '0';
+    }
+
+    /**
+     * Validates the structure of a BIC given as a character sequence without
+     * creating an instance of \p BIC and without allocating memory. Leading
+     * and trailing whitespace is ignored.
+     *
+     * @param data Pointer to the first character
+     * @param length The number of characters
+     * @return \p true if the sequence is a valid BIC, \p false otherwise
+     */
+    bool BIC::validateString(const char* data, size_t length) {
+        while (length > 0 && std::isspace(static_cast<unsigned char>(*data))) {
+            data++;
+            length--;
+        }
+        while (length > 0 &&
+               std::isspace(static_cast<unsigned char>(data[length - 1]))) {
+            length--;
+        }
+        return isStructureValid(data, length);
+    }
+
+    /**
+     * Validates many BICs stored in fixed width records without allocating
+     * memory. BICs with eight characters may be padded with spaces.
+     *
+     * @param bics Pointer to the first record
+     * @param recordLength The length of each record
+     * @param count The number of records
+     * @param results Output array receiving \p count results
+     * @return The number of valid BICs
+     */
+    size_t BIC::validateBatch(const char* bics, size_t recordLength,
+                              size_t count, bool* results) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++) {
+            results[i] = validateString(bics + i * recordLength, recordLength);
+            if (results[i]) {
+                valid++;
+            }
+        }
+        return valid;
+    }
+
+    /**
+     * Returns the IBAN country used by the BIC country of a territory. Some
+     * territories have BICs with their own country code, but use the IBANs
+     * of another country.
+     *
+     * @param first The first letter of the BIC country (upper case)
+     * @param second The second letter of the BIC country (upper case)
+     * @return The IBAN country as two letters packed into an integer
+     */
+    static unsigned getIBANCountry(char first, char second) {
+        static const char* const territories[][2] = {
+            {"GF", "FR"}, {"GP", "FR"}, {"MQ", "FR"}, {"RE", "FR"},
+            {"PF", "FR"}, {"TF", "FR"}, {"YT", "FR"}, {"NC", "FR"},
+            {"BL", "FR"}, {"MF", "FR"}, {"PM", "FR"}, {"WF", "FR"},
+            {"GG", "GB"}, {"JE", "GB"}, {"IM", "GB"}, {"AX", "FI"}
+        };
+        for (const auto& territory : territories) {
+            if (territory[0][0] == first && territory[0][1] == second) {
+                first = territory[1][0];
+                second = territory[1][1];
+                break;
+            }
+        }
+        return static_cast<unsigned>(first) << 8 | static_cast<unsigned>(second);
+    }
+
+    /**
+     * Packs up to twelve alphanumerical characters into an integer (upper and
+     * lower case letters are equal).
+     *
+     * @param data Pointer to the characters
+     * @param length The number of characters
+     * @param packed The packed characters preceding \p data (default: 0)
+     * @return The packed characters
+     */
+    static uint64_t pack(const char* data, size_t length, uint64_t packed = 0) {
+        for (size_t i = 0; i < length; i++) {
+            packed = packed * 37 + static_cast<uint64_t>(getCharValue(data[i]) + 1);
+        }
+        return packed;
+    }
+
+    /**
+     * Adds a BIC for a bank code. A bank code may have several BICs; for the
+     * consistency check, only the first eight characters of a BIC matter.
+     * Throws an \p IBANInvalidCountryCodeException if bank codes of the
+     * country cannot be located inside IBANs, a \p std::invalid_argument if
+     * the bank code does not fit and a \p BICParseException if the BIC is
+     * malformed.
+     *
+     * @param countryCode The country code of the IBANs
+     * @param bankCode The bank code as it appears in the IBANs
+     * @param bic The BIC of the bank
+     */
+    void BankDirectory::add(const std::string& countryCode,
+                            const std::string& bankCode,
+                            const std::string& bic) {
+        size_t offset, length;
+        if (countryCode.length() != 2 ||
+                !getBankCodeField(countryCode[0], countryCode[1], offset, length)) {
+            throw IBANInvalidCountryCodeException(countryCode);
+        }
+        if (bankCode.length() != length ||
+                !std::all_of(bankCode.begin(), bankCode.end(),
+                             [](char ch) { return getCharValue(ch) >= 0; })) {
+            throw std::invalid_argument("Invalid bank code " + bankCode);
+        }
+        BIC parsed = BIC::createFromString(bic);
+        auto entry = std::make_pair(
+                pack(bankCode.data(), length, pack(countryCode.data(), 2)),
+                pack(parsed.toString().data(), 8));
+        auto it = std::lower_bound(m_entries.begin(), m_entries.end(), entry);
+        if (it == m_entries.end() || *it != entry) {
+            m_entries.insert(it, entry);
+        }
+    }
+
+    /**
+     * Loads a directory file with one entry per line: country code, bank code
+     * and BIC separated by \p separator. Malformed lines are skipped. Throws
+     * a \p std::runtime_error if the file cannot be read.
+     *
+     * @param path The path of the file
+     * @param separator The field separator (default: ';')
+     * @return The number of entries loaded
+     */
+    size_t BankDirectory::loadFile(const std::string& path, char separator) {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot open bank directory " + path);
+        }
+        size_t loaded = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t first = line.find(separator);
+            size_t second = line.find(separator, first + 1);
+            if (first == std::string::npos || second == std::string::npos) {
+                continue;
+            }
+            std::string bic = line.substr(second + 1);
+            trim(bic);
+            try {
+                add(line.substr(0, first), line.substr(first + 1, second - first - 1),
+                    bic);
+                loaded++;
+            } catch (const BICParseException&) {
+            } catch (const IBANInvalidCountryCodeException&) {
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        return loaded;
+    }
+
+    /**
+     * Loads the BICs from the bank code file published by the Deutsche
+     * Bundesbank. The bank code occupies the first eight characters of a
+     * record and the BIC the characters 140 to 150; records without a BIC are
+     * skipped. Throws a \p std::runtime_error if the file cannot be read.
+     *
+     * @param path The path of the file
+     * @return The number of entries loaded
+     */
+    size_t BankDirectory::loadBundesbankFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open bank code file " + path);
+        }
+        size_t loaded = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.length() < 150) {
+                continue;
+            }
+            std::string bic = line.substr(139, 11);
+            trim(bic);
+            if (bic.empty()) {
+                continue;
+            }
+            try {
+                add("DE", line.substr(0, 8), bic);
+                loaded++;
+            } catch (const BICParseException&) {
+            } catch (const IBANInvalidCountryCodeException&) {
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        return loaded;
+    }
+
+    /**
+     * Checks whether the directory lists the BIC for the bank code of an IBAN
+     * in machine form. IBAN and BIC must be structurally valid.
+     *
+     * @param iban Pointer to the IBAN
+     * @param ibanLength The length of the IBAN
+     * @param bic Pointer to the BIC
+     * @param bicLength The length of the BIC
+     * @return \p ConsistencyResult::BankMismatch if the directory lists other
+     *         BICs for the bank code, otherwise \p ConsistencyResult::Consistent
+     */
+    ConsistencyResult BankDirectory::check(const char* iban, size_t ibanLength,
+                                           const char* bic,
+                                           size_t bicLength) const {
+        size_t offset, length;
+        if (bicLength < 8 || !getBankCodeField(iban[0], iban[1], offset, length) ||
+                4 + offset + length > ibanLength) {
+            return ConsistencyResult::Consistent;
+        }
+        uint64_t key = pack(iban + 4 + offset, length, pack(iban, 2));
+        auto range = std::equal_range(m_entries.begin(), m_entries.end(),
+                std::make_pair(key, uint64_t(0)),
+                [](const std::pair<uint64_t, uint64_t>& a,
+                   const std::pair<uint64_t, uint64_t>& b) {
+                    return a.first < b.first;
+                });
+        if (range.first == range.second) {
+            return ConsistencyResult::Consistent;
+        }
+        uint64_t packed = pack(bic, 8);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == packed) {
+                return ConsistencyResult::Consistent;
+            }
+        }
+        return ConsistencyResult::BankMismatch;
+    }
+
+    /**
+     * Returns the number of entries in the directory.
+     *
+     * @return The number of entries
+     */
+    size_t BankDirectory::size() const {
+        return m_entries.size();
+    }
+
+    /**
+     * Checks whether an IBAN in machine form and a BIC belong together without
+     * allocating memory. The country of the BIC must use the IBANs of the
+     * country of the IBAN and, if a directory is given and knows the bank
+     * code of the IBAN, the BIC must be listed for it. The checksum of the
+     * IBAN is not checked.
+     *
+     * @param iban Pointer to the IBAN
+     * @param ibanLength The length of the IBAN
+     * @param bic Pointer to the BIC
+     * @param bicLength The length of the BIC
+     * @param directory The bank directory or \p nullptr (default)
+     * @return The result of the check
+     */
+    ConsistencyResult checkConsistency(const char* iban, size_t ibanLength,
+                                       const char* bic, size_t bicLength,
+                                       const BankDirectory* directory) {
+        if (!isStructureValid(bic, bicLength) || ibanLength < 4 ||
+                IBAN::getLengthForCountry(iban[0], iban[1]) != ibanLength) {
+            return ConsistencyResult::Malformed;
+        }
+        char ibanFirst = static_cast<char>(std::toupper(static_cast<unsigned char>(iban[0])));
+        char ibanSecond = static_cast<char>(std::toupper(static_cast<unsigned char>(iban[1])));
+        char bicFirst = static_cast<char>(std::toupper(static_cast<unsigned char>(bic[4])));
+        char bicSecond = static_cast<char>(std::toupper(static_cast<unsigned char>(bic[5])));
+        if (getIBANCountry(bicFirst, bicSecond) != getIBANCountry(ibanFirst, ibanSecond)) {
+            return ConsistencyResult::CountryMismatch;
+        }
+        if (directory != nullptr) {
+            return directory->check(iban, ibanLength, bic, bicLength);
+        }
+        return ConsistencyResult::Consistent;
+    }
+
+    /**
+     * Checks whether an IBAN and a BIC belong together (see
+     * \p checkConsistency()).
+     *
+     * @param iban The IBAN
+     * @param bic The BIC
+     * @param directory The bank directory or \p nullptr (default)
+     * @return \p true if IBAN and BIC are consistent
+     */
+    bool consistent(const IBAN& iban, const BIC& bic,
+                    const BankDirectory* directory) {
+        std::string machine = iban.getMachineForm();
+        std::string code = bic.toString();
+        return checkConsistency(machine.data(), machine.length(), code.data(),
+                                code.length(), directory) ==
+               ConsistencyResult::Consistent;
+    }
+
+    /**
+     * Checks many pairs of IBANs in machine form and BICs stored in two
+     * arrays of fixed width records without allocating memory. BIC records
+     * may be padded with spaces.
+     *
+     * @param ibans Pointer to the first IBAN
+     * @param ibanLength The length of each IBAN record
+     * @param bics Pointer to the first BIC
+     * @param bicLength The length of each BIC record
+     * @param count The number of pairs
+     * @param results Output array receiving \p count results
+     * @param directory The bank directory or \p nullptr (default)
+     * @return The number of consistent pairs
+     */
+    size_t checkConsistencyBatch(const char* ibans, size_t ibanLength,
+                                 const char* bics, size_t bicLength, size_t count,
+                                 ConsistencyResult* results,
+                                 const BankDirectory* directory) {
+        size_t consistentCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            const char* bic = bics + i * bicLength;
+            size_t length = bicLength;
+            while (length > 0 && bic[length - 1] == ' ') {
+                length--;
+            }
+            results[i] = checkConsistency(ibans + i * ibanLength, ibanLength,
+                                          bic, length, directory);
+            if (results[i] == ConsistencyResult::Consistent) {
+                consistentCount++;
+            }
+        }
+        return consistentCount;
+    }
+}
@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        bic.h
+ * \brief       Header file declaring BICs and IBAN/BIC consistency checks
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a class representing Business Identifier Codes
+ * (BIC, ISO 9362) and functions checking whether an IBAN and a BIC belong
+ * together.
+ */
+
+#ifndef LIBIBAN_BIC_H
+#define LIBIBAN_BIC_H
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "libiban.h"
+
+namespace IBAN {
+
+/// Exception to be thrown when parsing a BIC fails
+class BICParseException : public std::exception {
+
+private:
+    /// Holds the BIC causing the error
+    std::string m_bic;
+    /// The exception message
+    std::string m_message;
+
+public:
+    BICParseException(const std::string& bic) noexcept;
+    virtual ~BICParseException();
+    virtual const char* what() const noexcept;
+
+    /// Copy constructor for \p BICParseException. Uses the default copy
+    /// constructor
+    BICParseException(const BICParseException& other)=default;
+};
+
+/// Business Identifier Code according to ISO 9362
+class BIC {
+
+private:
+    /// Holds the BIC with 8 or 11 characters (upper case)
+    std::string m_bic {};
+    BIC(const std::string& bic) : m_bic(bic) {}
+
+public:
+    /// Copy constructor for \p BIC. Uses the default copy constructor
+    BIC(const BIC&)=default;
+    bool operator==(const BIC& other) const;
+    bool operator!=(const BIC& other) const;
+    static BIC createFromString(const std::string& string);
+    std::string getBankCode() const;
+    std::string getCountryCode() const;
+    std::string getLocationCode() const;
+    std::string getBranchCode() const;
+    std::string toString() const;
+    bool isTestBIC() const;
+    static bool validateString(const char* data, size_t length);
+    static size_t validateBatch(const char* bics, size_t recordLength,
+                                size_t count, bool* results);
+
+}; // end of class BIC
+
+/// Result of an IBAN/BIC consistency check
+enum class ConsistencyResult : unsigned char {
+    /// IBAN and BIC belong together (as far as it can be checked)
+    Consistent,
+    /// IBAN or BIC is malformed
+    Malformed,
+    /// The countries of IBAN and BIC differ
+    CountryMismatch,
+    /// The bank directory lists other BICs for the bank code of the IBAN
+    BankMismatch
+};
+
+/// Maps the bank codes inside IBANs to the BICs of the banks
+class BankDirectory {
+
+private:
+    /// Pairs of packed country and bank code and packed BIC (8 characters),
+    /// sorted
+    std::vector<std::pair<uint64_t, uint64_t>> m_entries;
+
+public:
+    void add(const std::string& countryCode, const std::string& bankCode,
+             const std::string& bic);
+    size_t loadFile(const std::string& path, char separator = ';');
+    size_t loadBundesbankFile(const std::string& path);
+    ConsistencyResult check(const char* iban, size_t ibanLength,
+                            const char* bic, size_t bicLength) const;
+    size_t size() const;
+
+}; // end of class BankDirectory
+
+ConsistencyResult checkConsistency(const char* iban, size_t ibanLength,
+                                   const char* bic, size_t bicLength,
+                                   const BankDirectory* directory = nullptr);
+bool consistent(const IBAN& iban, const BIC& bic,
+                const BankDirectory* directory = nullptr);
+size_t checkConsistencyBatch(const char* ibans, size_t ibanLength,
+                             const char* bics, size_t bicLength, size_t count,
+                             ConsistencyResult* results,
+                             const BankDirectory* directory = nullptr);
+
+/**
+ * Overloads the comparison operator ==.
+ *
+ * @param other The object to compare with
+ * @return \p true if both objects are equal, \p false otherwise
+ */
+inline bool BIC::operator==(const BIC& other) const {
+    return m_bic == other.m_bic;
+}
+
+/**
+ * Overloads the comparison operator !=.
+ *
+ * @param other The object to compare with
+ * @return \p true if the objects are not equal, \p false if they are equal
+ */
+inline bool BIC::operator!=(const BIC& other) const {
+    return !(*this == other);
+}
+
+/**
+ * Overrides the stream operator << for BIC.
+ *
+ * @param stream The stream to write to
+ * @param elem The element to write to the stream
+ * @return The stream written to
+ */
+inline std::ostream& operator<<(std::ostream& stream, const BIC& elem) {
+    stream << "BIC (" << elem.toString() << ")";
+    return stream;
+}
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_BIC_H
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        camtscanner.cpp
+ * \brief       Source file implementing the bank statement scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p CamtScanner. Entries are
+ * independent of each other, so large documents are split at entry
+ * boundaries and the parts are scanned in parallel.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "camtscanner.h"
+#include "libiban.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include "xmltags.h"
+
+namespace IBAN {
+
+    /// Start tag of an entry as searched for when splitting documents
+    static const char entryTag[] = "<Ntry>";
+
+    /**
+     * Counts the entries of a part of a document the way \p scanRange()
+     * finds them: by their start tags, with or without namespace prefix,
+     * outside of comments and CDATA sections.
+     *
+     * @param data The document
+     * @param begin The start of the part
+     * @param end The end of the part
+     * @return The number of entries starting in the part
+     */
+    static size_t countEntries(const char* data, size_t begin, size_t end) {
+        size_t entries = 0;
+        size_t pos = begin;
+        XMLTag tag;
+        while (nextXMLTag(data, end, pos, tag)) {
+            if (!tag.closing && !tag.empty && isXMLName(tag, "Ntry")) {
+                entries++;
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * Constructor of \p CamtScanner.
+     *
+     * @param threads Number of threads scanning entries in parallel
+     *        (default: 1); 0 selects the number of hardware threads
+     */
+    CamtScanner::CamtScanner(unsigned threads) : m_threads(threads), m_pool(nullptr) {
+        if (m_threads == 0) {
+            m_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**
+     * Constructor of \p CamtScanner scanning entries on the workers of a
+     * pool. The pool must outlive the scanner and callbacks must not use it.
+     *
+     * @param pool The pool
+     */
+    CamtScanner::CamtScanner(ThreadPool& pool) :
+            m_threads(static_cast<unsigned>(pool.getThreadCount())), m_pool(&pool) {
+    }
+
+    /**
+     * Scans a camt.053 or camt.054 document for the counterparty accounts of
+     * its entries: the IBANs inside \p DbtrAcct and \p CdtrAcct elements of
+     * each \p Ntry. Every IBAN is validated and passed to \p callback together
+     * with the index, the amount and the credit/debit indicator of its entry.
+     *
+     * With several threads, the document is split at unprefixed \p <Ntry>
+     * start tags and the parts are scanned in parallel; \p callback is then
+     * called concurrently and must be thread-safe. Calls for the same entry
+     * are always made by the same thread in document order. Entries are
+     * numbered across parts by counting their tags like they are scanned.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param callback Receives the counterparty accounts
+     * @return The number of entries
+     */
+    size_t CamtScanner::scan(const char* data, size_t length,
+                             const Callback& callback) const {
+        return scanInParallel(m_pool, m_threads, data, length, entryTag, false,
+                [data](size_t begin, size_t end) {
+                    return countEntries(data, begin, end);
+                },
+                [&](size_t begin, size_t end, size_t first) {
+                    return scanRange(data, begin, end, first, callback);
+                });
+    }
+
+    /**
+     * Scans a part of a document that starts outside of any entry or at the
+     * start tag of an entry.
+     *
+     * @param data The document
+     * @param begin The start of the part
+     * @param end The end of the part
+     * @param firstEntry The index of the first entry of the part
+     * @param callback Receives the counterparty accounts
+     * @return The number of entries in the part
+     */
+    size_t CamtScanner::scanRange(const char* data, size_t begin, size_t end,
+                                  size_t firstEntry,
+                                  const Callback& callback) const {
+        CounterpartyAccount account = {0, PartyRole::Debtor, false, false,
+                                       nullptr, 0, 0, nullptr, 0, nullptr, 0};
+        size_t entries = 0;
+        bool inEntry = false, inAccount = false;
+        bool haveAmount = false, haveIndicator = false;
+        size_t pos = begin;
+        XMLTag tag;
+        while (nextXMLTag(data, end, pos, tag)) {
+            if (tag.closing || tag.empty) {
+                if (isXMLName(tag, "Ntry")) {
+                    inEntry = false;
+                } else if (isXMLName(tag, "DbtrAcct") || isXMLName(tag, "CdtrAcct")) {
+                    inAccount = false;
+                }
+                continue;
+            }
+            if (isXMLName(tag, "Ntry")) {
+                account.entry = firstEntry + entries++;
+                account.amount = account.currency = nullptr;
+                account.amountLength = account.currencyLength = 0;
+                account.credit = false;
+                inEntry = true;
+                inAccount = haveAmount = haveIndicator = false;
+            } else if (!inEntry) {
+                continue;
+            } else if (isXMLName(tag, "DbtrAcct") || isXMLName(tag, "CdtrAcct")) {
+                account.role = tag.name[0] == 'D' ? PartyRole::Debtor :
+                                                    PartyRole::Creditor;
+                inAccount = true;
+            } else if (isXMLName(tag, "Amt") && !haveAmount) {
+                // the first amount of an entry is the amount of the entry,
+                // later ones belong to its transaction details
+                size_t text;
+                account.amountLength = getXMLText(data, end, pos, text);
+                account.amount = data + text;
+                account.currencyLength = getXMLAttribute(tag, "Ccy",
+                                                         account.currency);
+                if (account.currencyLength == 0) {
+                    account.currency = nullptr;
+                }
+                haveAmount = true;
+            } else if (isXMLName(tag, "CdtDbtInd") && !haveIndicator) {
+                size_t text;
+                size_t textLength = getXMLText(data, end, pos, text);
+                account.credit = textLength == 4 &&
+                                 std::memcmp(data + text, "CRDT", 4) == 0;
+                haveIndicator = true;
+            } else if (inAccount && isXMLName(tag, "IBAN")) {
+                size_t text;
+                account.length = getXMLText(data, end, pos, text);
+                account.iban = data + text;
+                account.offset = text;
+                account.valid = IBAN::validateString(account.iban, account.length);
+                if (callback) {
+                    callback(account);
+                }
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * Scans a statement file (see \p scan()). The file is mapped into memory
+     * and the pointers passed to \p callback are only valid during the call.
+     * Throws a \p std::runtime_error if the file cannot be mapped.
+     *
+     * @param path The path of the file
+     * @param callback Receives the counterparty accounts
+     * @return The number of entries
+     */
+    size_t CamtScanner::scanFile(const std::string& path,
+                                 const Callback& callback) const {
+        MappedFile file(path);
+        return scan(file.data(), file.size(), callback);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        camtscanner.h
+ * \brief       Header file declaring the bank statement scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a streaming scanner extracting the counterparty
+ * IBANs and amounts of the entries of ISO 20022 camt.053 and camt.054 bank
+ * statements and notifications.
+ */
+
+#ifndef LIBIBAN_CAMTSCANNER_H
+#define LIBIBAN_CAMTSCANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace IBAN {
+
+class ThreadPool;
+
+/// Role of a counterparty account in a statement entry
+enum class PartyRole : unsigned char {
+    /// The account of the debtor (element \p DbtrAcct)
+    Debtor,
+    /// The account of the creditor (element \p CdtrAcct)
+    Creditor
+};
+
+/// Counterparty account of a statement entry; all pointers refer to the
+/// scanned data
+struct CounterpartyAccount {
+    /// Index of the entry (element \p Ntry) in the document, counted from 0
+    size_t entry;
+    /// The role of the account
+    PartyRole role;
+    /// Whether the IBAN is valid
+    bool valid;
+    /// Whether the entry is a credit (\p CdtDbtInd is \p CRDT)
+    bool credit;
+    /// The IBAN without surrounding whitespace
+    const char* iban;
+    /// The length of \p iban
+    size_t length;
+    /// Byte offset of the IBAN inside the scanned data
+    size_t offset;
+    /// The amount of the entry (\p nullptr if none)
+    const char* amount;
+    /// The length of \p amount
+    size_t amountLength;
+    /// The currency of the amount (\p nullptr if none)
+    const char* currency;
+    /// The length of \p currency
+    size_t currencyLength;
+};
+
+/// Extracts the counterparty IBANs of camt.053 and camt.054 documents
+class CamtScanner {
+
+private:
+    /// Number of threads scanning entries in parallel
+    unsigned m_threads;
+    /// The pool running the parallel scans or \p nullptr for own threads
+    ThreadPool* m_pool;
+
+    size_t scanRange(const char* data, size_t begin, size_t end,
+                     size_t firstEntry,
+                     const std::function<void(const CounterpartyAccount&)>& callback) const;
+
+public:
+    /// Receives the counterparty accounts found by a scan
+    typedef std::function<void(const CounterpartyAccount&)> Callback;
+
+    CamtScanner(unsigned threads = 1);
+    explicit CamtScanner(ThreadPool& pool);
+    size_t scan(const char* data, size_t length,
+                const Callback& callback) const;
+    size_t scanFile(const std::string& path, const Callback& callback) const;
+
+}; // end of class CamtScanner
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_CAMTSCANNER_H
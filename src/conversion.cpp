@@ -0,0 +1,379 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        conversion.cpp
+ * \brief       Source file implementing the conversion of national accounts
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the conversion of national account data to
+ * IBANs using the BBAN layout of each supported country.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <unordered_map>
+#include "conversion.h"
+#include "national.h"
+#include "registry.h"
+#include "utils.h"
+
+/**
+ * Lists the BBAN layouts of all countries supported by the conversion. The
+ * layout uses the notation of the registry formats, but the groups name the
+ * fields of the BBAN: \p b (bank code), \p s (branch code), \p k (account
+ * number) and \p x (national check digits calculated during the conversion).
+ * Check digits that are part of the account number (as in NO) are not
+ * calculated but verified with the registered national check.
+ */
+#define LIBIBAN_LAYOUTS(X) \
+    X(AT, "5b11k") X(BE, "3b7k2x") X(CH, "5b12k") X(DE, "8b10k") \
+    X(DK, "4b10k") X(ES, "4b4s2x10k") X(FR, "5b5s11k2x") X(GB, "4b6s8k") \
+    X(IE, "4b6s8k") X(IT, "1x5b5s12k") X(LI, "5b12k") X(LU, "3b13k") \
+    X(MC, "5b5s11k2x") X(NL, "4b10k") X(NO, "4b7k") X(PL, "8b16k") \
+    X(PT, "4b4s11k2x") X(SE, "3b17k")
+
+namespace IBAN {
+
+/// Verifies that a layout matches the BBAN length of its country
+#define LIBIBAN_LAYOUT_CHECK(code, layout) \
+    static_assert(getFormatLength(layout) == \
+                  getFormatLength(lookupCountryFormat(#code[0], #code[1])), \
+                  "BBAN layout of " #code " does not match the registry");
+
+    LIBIBAN_LAYOUTS(LIBIBAN_LAYOUT_CHECK)
+
+#undef LIBIBAN_LAYOUT_CHECK
+
+    /// Fields of a BBAN in the order of the layout notation
+    enum LayoutField { Bank, Branch, Account, Check, FieldCount };
+
+    /// Parsed BBAN layout of a country
+    struct BBANLayout {
+        /// The BBAN format of the registry, \p nullptr if there is no layout
+        const char* format;
+        /// The length of the BBAN
+        size_t length;
+        /// The offset of each field inside the BBAN
+        size_t offset[FieldCount];
+        /// The length of each field, 0 if the country does not use it
+        size_t size[FieldCount];
+    };
+
+    /**
+     * Parses a layout in the notation of \p LIBIBAN_LAYOUTS.
+     *
+     * @param code The country code
+     * @param layout The layout
+     * @return The parsed layout
+     */
+    static BBANLayout parseLayout(const char* code, const char* layout) {
+        BBANLayout result = {lookupCountryFormat(code[0], code[1]), 0, {}, {}};
+        while (*layout != '\0') {
+            size_t count = getFormatCount(layout);
+            layout = getFormatClassPointer(layout);
+            LayoutField field = *layout == 'b' ? Bank : *layout == 's' ? Branch :
+                                *layout == 'k' ? Account : Check;
+            result.offset[field] = result.length;
+            result.size[field] = count;
+            result.length += count;
+            layout++;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the layout of a country from a table indexed by the country
+     * code which is built on first use.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return The layout or \p nullptr if the country is not supported
+     */
+    static const BBANLayout* getLayout(char first, char second) {
+        static const std::array<BBANLayout, 26 * 26> layouts = [] {
+            std::array<BBANLayout, 26 * 26> table;
+            table.fill(BBANLayout{nullptr, 0, {}, {}});
+#define LIBIBAN_LAYOUT_ENTRY(code, layout) \
+            table[(#code[0] - 'A') * 26 + (#code[1] - 'A')] = parseLayout(#code, layout);
+            LIBIBAN_LAYOUTS(LIBIBAN_LAYOUT_ENTRY)
+#undef LIBIBAN_LAYOUT_ENTRY
+            return table;
+        }();
+
+        int a = getCharValue(first) - 10;
+        int b = getCharValue(second) - 10;
+        if (a < 0 || b < 0) {
+            return nullptr;
+        }
+        const BBANLayout& layout = layouts[static_cast<size_t>(a * 26 + b)];
+        return layout.format == nullptr ? nullptr : &layout;
+    }
+
+    /**
+     * Returns the registry of conversion rules keyed by country code followed
+     * by bank code.
+     *
+     * @return The registry
+     */
+    static std::unordered_map<std::string, ConversionRule>& getRules() {
+        static std::unordered_map<std::string, ConversionRule> rules;
+        return rules;
+    }
+
+    /**
+     * Registers a rule applied to all accounts of a bank, replacing any rule
+     * registered for it already; \p nullptr removes the rule. Rules are used
+     * for bank specific conversions such as the German IBAN rules. The
+     * registry is not synchronized, so rules should be registered before
+     * converting from several threads.
+     *
+     * @param countryCode The country code (upper case)
+     * @param bankCode The bank code as it appears in the BBAN
+     * @param rule The rule
+     */
+    void registerConversionRule(const std::string& countryCode,
+                                const std::string& bankCode,
+                                ConversionRule rule) {
+        if (rule == nullptr) {
+            getRules().erase(countryCode + bankCode);
+        } else {
+            getRules()[countryCode + bankCode] = rule;
+        }
+    }
+
+    /**
+     * Checks whether national account data of a country can be converted.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return \p true if the country is supported
+     */
+    bool hasNationalLayout(char first, char second) {
+        return getLayout(first, second) != nullptr;
+    }
+
+    /**
+     * Returns the position of the bank code inside the BBAN of a country.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @param offset Receives the offset of the bank code inside the BBAN
+     * @param length Receives the length of the bank code
+     * @return \p false if the layout of the country is unknown
+     */
+    bool getBankCodeField(char first, char second, size_t& offset,
+                          size_t& length) {
+        const BBANLayout* layout = getLayout(first, second);
+        if (layout == nullptr) {
+            return false;
+        }
+        offset = layout->offset[Bank];
+        length = layout->size[Bank];
+        return true;
+    }
+
+    /**
+     * Copies a field into its place in the BBAN. Spaces and dashes are
+     * removed, letters are converted to upper case and shorter values are
+     * padded with leading zeros.
+     *
+     * @param source The value of the field
+     * @param length The length of the value
+     * @param target Pointer to the field in the BBAN
+     * @param size The size of the field
+     * @return \p false if the value does not fit into the field
+     */
+    static bool copyField(const char* source, size_t length, char* target,
+                          size_t size) {
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (source[i] != ' ' && source[i] != '-') {
+                count++;
+            }
+        }
+        if (count > size) {
+            return false;
+        }
+        std::fill(target, target + size - count, '0');
+        target += size - count;
+        for (size_t i = 0; i < length; i++) {
+            if (source[i] != ' ' && source[i] != '-') {
+                *target++ = static_cast<char>(
+                        std::toupper(static_cast<unsigned char>(source[i])));
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Converts national account data to an IBAN in machine form without
+     * allocating memory (unless conversion rules are registered). The fields
+     * are padded to the BBAN layout of the country, national check digits are
+     * calculated where the layout contains them (or verified where they are
+     * part of the account number), bank specific rules are applied and
+     * finally the IBAN check digits are calculated.
+     *
+     * @param countryCode Pointer to the two letters of the country code
+     * @param bankCode Pointer to the bank code
+     * @param bankLength The length of the bank code
+     * @param branch Pointer to the branch code
+     * @param branchLength The length of the branch code (0 if there is none)
+     * @param account Pointer to the account number
+     * @param accountLength The length of the account number
+     * @param iban Output buffer of at least 34 characters
+     * @return The length of the IBAN or 0 if the data cannot be converted
+     */
+    size_t convertNational(const char* countryCode, const char* bankCode,
+                           size_t bankLength, const char* branch,
+                           size_t branchLength, const char* account,
+                           size_t accountLength, char* iban) {
+        const BBANLayout* layout = getLayout(countryCode[0], countryCode[1]);
+        if (layout == nullptr) {
+            return 0;
+        }
+        char* bban = iban + 4;
+        iban[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(countryCode[0])));
+        iban[1] = static_cast<char>(std::toupper(static_cast<unsigned char>(countryCode[1])));
+        if (!copyField(bankCode, bankLength, bban + layout->offset[Bank],
+                       layout->size[Bank]) ||
+            !copyField(branch, branchLength, bban + layout->offset[Branch],
+                       layout->size[Branch]) ||
+            !copyField(account, accountLength, bban + layout->offset[Account],
+                       layout->size[Account])) {
+            return 0;
+        }
+        std::fill(bban + layout->offset[Check],
+                  bban + layout->offset[Check] + layout->size[Check], '0');
+
+        if (!getRules().empty()) {
+            auto rule = getRules().find(std::string(iban, 2) +
+                    std::string(bban + layout->offset[Bank], layout->size[Bank]));
+            if (rule != getRules().end() && !rule->second(bban, layout->length)) {
+                return 0;
+            }
+        }
+        if (layout->size[Check] > 0 &&
+                !fillNationalCheckDigits(iban[0], iban[1], bban, layout->length)) {
+            return 0;
+        }
+        // the check digit of the account number is taken as given, so it
+        // must be correct
+        if (layout->size[Check] == 0 &&
+                checkNationalDigits(iban, layout->length + 4) == NationalCheckResult::Invalid) {
+            return 0;
+        }
+        for (size_t i = 0; i < layout->length; i++) {
+            if (!matchesFormatClass(getFormatClass(layout->format, i),
+                                    getCharValue(bban[i]))) {
+                return 0;
+            }
+        }
+
+        long digits = getCheckDigits(iban, bban, layout->length);
+        if (digits < 0) {
+            return 0;
+        }
+        iban[2] = static_cast<char>('0' + digits / 10);
+        iban[3] = static_cast<char>('0' + digits % 10);
+        return layout->length + 4;
+    }
+
+    /**
+     * Converts national account data to an IBAN. Throws an
+     * \p IBANInvalidCountryCodeException if the country is not supported and
+     * an \p IBANParseException if the data does not fit the BBAN layout.
+     *
+     * @param countryCode The country code
+     * @param bankCode The bank code
+     * @param branch The branch code (empty if the country does not use one)
+     * @param account The account number
+     * @return The IBAN
+     */
+    IBAN fromNational(const std::string& countryCode, const std::string& bankCode,
+                      const std::string& branch, const std::string& account) {
+        if (countryCode.length() != 2 ||
+                getLayout(countryCode[0], countryCode[1]) == nullptr) {
+            throw IBANInvalidCountryCodeException(countryCode);
+        }
+        char iban[34];
+        size_t length = convertNational(countryCode.data(), bankCode.data(),
+                                        bankCode.length(), branch.data(),
+                                        branch.length(), account.data(),
+                                        account.length(), iban);
+        if (length == 0) {
+            throw IBANParseException(countryCode + " " + bankCode + " " +
+                                     branch + " " + account);
+        }
+        return IBAN::createFromString(std::string(iban, length));
+    }
+
+    /**
+     * Converts a stream of national account records to IBANs in one pass.
+     * Every input line holds country code, bank code, branch code and account
+     * number separated by \p separator. For every line the IBAN in machine
+     * form is written, or an empty line if the record cannot be converted, so
+     * the output lines correspond to the input lines.
+     *
+     * @param input The stream of records
+     * @param output The stream receiving the IBANs
+     * @param separator The field separator (default: ';')
+     * @return The number of converted records
+     */
+    size_t convertNationalStream(std::istream& input, std::ostream& output,
+                                 char separator) {
+        size_t converted = 0;
+        std::string line;
+        char iban[35];
+        while (std::getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            const char* fields[4];
+            size_t lengths[4];
+            size_t field = 0, start = 0;
+            for (size_t i = 0; i <= line.length() && field < 4; i++) {
+                if (i == line.length() || line[i] == separator) {
+                    fields[field] = line.data() + start;
+                    lengths[field++] = i - start;
+                    start = i + 1;
+                }
+            }
+            size_t length = 0;
+            if (field == 4 && start == line.length() + 1 && lengths[0] == 2) {
+                length = convertNational(fields[0], fields[1], lengths[1],
+                                         fields[2], lengths[2], fields[3],
+                                         lengths[3], iban);
+            }
+            if (length > 0) {
+                converted++;
+            }
+            iban[length] = '\n';
+            output.write(iban, static_cast<std::streamsize>(length + 1));
+        }
+        return converted;
+    }
+}
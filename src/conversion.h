@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        conversion.h
+ * \brief       Header file declaring the conversion of national accounts
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares functions converting national account data (bank
+ * code, branch code and account number) to IBANs.
+ */
+
+#ifndef LIBIBAN_CONVERSION_H
+#define LIBIBAN_CONVERSION_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "libiban.h"
+
+namespace IBAN {
+
+/// Rewrites an assembled BBAN in place before its check digits are computed,
+/// for example to apply bank specific rules; returns \p false if the account
+/// cannot be converted
+typedef bool (*ConversionRule)(char* bban, size_t length);
+
+void registerConversionRule(const std::string& countryCode,
+                            const std::string& bankCode, ConversionRule rule);
+bool hasNationalLayout(char first, char second);
+bool getBankCodeField(char first, char second, size_t& offset, size_t& length);
+size_t convertNational(const char* countryCode, const char* bankCode,
+                       size_t bankLength, const char* branch,
+                       size_t branchLength, const char* account,
+                       size_t accountLength, char* iban);
+IBAN fromNational(const std::string& countryCode, const std::string& bankCode,
+                  const std::string& branch, const std::string& account);
+size_t convertNationalStream(std::istream& input, std::ostream& output,
+                             char separator = ';');
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_CONVERSION_H
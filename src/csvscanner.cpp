@@ -0,0 +1,391 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        csvscanner.cpp
+ * \brief       Source file implementing the CSV column scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p CSVScanner. Separators, quotes and
+ * line breaks are located 16 bytes at a time with SSE2 where available.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <thread>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "csvscanner.h"
+#include "libiban.h"
+#include "mappedfile.h"
+#include "parallel.h"
+
+namespace IBAN {
+
+    /// The quote character of CSV documents
+    static const char quote = '"';
+
+    /**
+     * Finds the next occurrence of any of three characters.
+     *
+     * @param data The document
+     * @param pos The position to start at
+     * @param end The end of the part to search
+     * @param a The first character
+     * @param b The second character
+     * @param c The third character
+     * @return The position of the character or \p end if there is none
+     */
+    static size_t findSpecial(const char* data, size_t pos, size_t end,
+                              char a, char b, char c) {
+#if defined(__SSE2__)
+        const __m128i first = _mm_set1_epi8(a);
+        const __m128i second = _mm_set1_epi8(b);
+        const __m128i third = _mm_set1_epi8(c);
+        while (pos + 16 <= end) {
+            __m128i block = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(data + pos));
+            int mask = _mm_movemask_epi8(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, first),
+                                 _mm_cmpeq_epi8(block, second)),
+                    _mm_cmpeq_epi8(block, third)));
+            if (mask != 0) {
+                return pos + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+            pos += 16;
+        }
+#endif
+        for (; pos < end; pos++) {
+            if (data[pos] == a || data[pos] == b || data[pos] == c) {
+                return pos;
+            }
+        }
+        return end;
+    }
+
+    /**
+     * Skips a quoted field. Quotes inside the field are escaped by doubling.
+     *
+     * @param data The document
+     * @param pos The position after the opening quote
+     * @param end The end of the part
+     * @return The position after the closing quote or \p end
+     */
+    static size_t skipQuoted(const char* data, size_t pos, size_t end) {
+        while (pos < end) {
+            const void* found = std::memchr(data + pos, quote, end - pos);
+            if (found == nullptr) {
+                return end;
+            }
+            pos = static_cast<size_t>(static_cast<const char*>(found) - data) + 1;
+            if (pos == end || data[pos] != quote) {
+                return pos;
+            }
+            pos++;
+        }
+        return end;
+    }
+
+    /**
+     * Removes whitespace at both ends of a field.
+     *
+     * @param data The document
+     * @param start The start of the field, moved to the first other character
+     * @param end The end of the field, moved behind the last other character
+     */
+    static void trimField(const char* data, size_t& start, size_t& end) {
+        while (start < end && std::isspace(static_cast<unsigned char>(data[start]))) {
+            start++;
+        }
+        while (end > start && std::isspace(static_cast<unsigned char>(data[end - 1]))) {
+            end--;
+        }
+    }
+
+    /**
+     * Constructor of \p CSVScanner.
+     *
+     * @param column Index of the IBAN column, counted from 0
+     * @param separator The field separator (default: ',')
+     * @param header Whether the first row is a header (default: \p false)
+     * @param threads Number of threads scanning chunks in parallel
+     *        (default: 1); 0 selects the number of hardware threads
+     */
+    CSVScanner::CSVScanner(size_t column, char separator, bool header,
+                           unsigned threads) :
+            m_column(column), m_separator(separator), m_header(header),
+            m_threads(threads), m_pool(nullptr) {
+        if (m_threads == 0) {
+            m_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**
+     * Constructor of \p CSVScanner scanning chunks on the workers of a pool,
+     * so that their placement and statistics apply to the scans. The pool
+     * must outlive the scanner and callbacks must not use it.
+     *
+     * @param column Index of the IBAN column, counted from 0
+     * @param separator The field separator
+     * @param header Whether the first row is a header
+     * @param pool The pool
+     */
+    CSVScanner::CSVScanner(size_t column, char separator, bool header,
+                           ThreadPool& pool) :
+            m_column(column), m_separator(separator), m_header(header),
+            m_threads(static_cast<unsigned>(pool.getThreadCount())), m_pool(&pool) {
+    }
+
+    /**
+     * Counts the rows starting in a part of a document that starts at the
+     * beginning of a row.
+     *
+     * @param data The document
+     * @param begin The start of the part
+     * @param end The end of the part
+     * @return The number of rows
+     */
+    size_t CSVScanner::countRows(const char* data, size_t begin,
+                                 size_t end) const {
+        size_t rows = 0, pos = begin, rowStart = begin;
+        while ((pos = findSpecial(data, pos, end, quote, '\n', '\n')) < end) {
+            if (data[pos] == quote) {
+                pos = skipQuoted(data, pos + 1, end);
+            } else {
+                rows++;
+                rowStart = ++pos;
+            }
+        }
+        return rows + (rowStart < end ? 1 : 0);
+    }
+
+    /**
+     * Splits a document into at most \p parts chunks of roughly equal size
+     * starting at row boundaries. Line breaks inside quoted fields are no
+     * row boundaries: the quotes in front of each tentative boundary are
+     * counted in parallel, which tells whether the boundary lies inside a
+     * quoted field. Small documents are not split.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param parts The maximum number of chunks
+     * @return The chunks with their first row and number of rows
+     */
+    std::vector<CSVChunk> CSVScanner::split(const char* data, size_t length,
+                                            size_t parts) const {
+        parts = std::max<size_t>(1, std::min(parts, length / minimumPartSize));
+        std::vector<size_t> starts(parts + 1, length);
+        for (size_t i = 0; i < parts; i++) {
+            starts[i] = length / parts * i;
+        }
+        std::vector<size_t> quotes(parts, 0);
+        runInParallel(m_pool, parts, [&](size_t i) {
+            quotes[i] = static_cast<size_t>(std::count(data + starts[i],
+                                                       data + starts[i + 1], quote));
+        });
+
+        // move every boundary behind the next line break outside of quotes
+        std::vector<size_t> bounds(1, 0);
+        size_t quoteCount = 0;
+        for (size_t i = 1; i < parts; i++) {
+            quoteCount += quotes[i - 1];
+            bool quoted = quoteCount % 2 == 1;
+            size_t pos = starts[i];
+            if (bounds.back() > pos) {
+                // the previous boundary lies behind this one at a row start
+                quoted = false;
+                pos = bounds.back();
+            }
+            for (; pos < length; pos++) {
+                if (data[pos] == quote) {
+                    quoted = !quoted;
+                } else if (data[pos] == '\n' && !quoted) {
+                    break;
+                }
+            }
+            if (pos + 1 >= length) {
+                break;
+            }
+            bounds.push_back(pos + 1);
+        }
+        bounds.push_back(length);
+
+        std::vector<CSVChunk> chunks(bounds.size() - 1);
+        runInParallel(m_pool, chunks.size(), [&](size_t i) {
+            chunks[i].begin = bounds[i];
+            chunks[i].end = bounds[i + 1];
+            chunks[i].rows = countRows(data, bounds[i], bounds[i + 1]);
+        });
+        size_t rows = 0;
+        for (auto& chunk : chunks) {
+            chunk.firstRow = rows;
+            rows += chunk.rows;
+        }
+        return chunks;
+    }
+
+    /**
+     * Scans a chunk of a document and passes the field of the IBAN column of
+     * every row to \p callback. Rows without the column are reported as
+     * invalid with an empty value. The header row is skipped.
+     *
+     * @param data The document
+     * @param chunk The chunk as returned by \p split()
+     * @param callback Receives the fields
+     * @return The number of rows reported
+     */
+    size_t CSVScanner::scanChunk(const char* data, const CSVChunk& chunk,
+                                 const Callback& callback) const {
+        CSVField field = {0, false, nullptr, 0, nullptr, 0};
+        size_t row = chunk.firstRow, reported = 0;
+        size_t pos = chunk.begin, end = chunk.end;
+        while (pos < end) {
+            size_t rowStart = pos, fieldStart = pos, column = 0;
+            size_t valueStart = 0, valueEnd = 0, rowEnd = end;
+            bool found = false;
+            while ((pos = findSpecial(data, pos, end, m_separator, quote, '\n')) < end) {
+                if (data[pos] == quote) {
+                    pos = skipQuoted(data, pos + 1, end);
+                    continue;
+                } else if (data[pos] == '\n') {
+                    rowEnd = pos;
+                    break;
+                }
+                if (column == m_column) {
+                    valueStart = fieldStart;
+                    valueEnd = pos;
+                    found = true;
+                }
+                column++;
+                fieldStart = ++pos;
+            }
+            size_t lineEnd = rowEnd;
+            if (lineEnd > rowStart && data[lineEnd - 1] == '\r') {
+                lineEnd--;
+            }
+            if (!found && column == m_column) {
+                valueStart = fieldStart;
+                valueEnd = std::max(fieldStart, lineEnd);
+                found = true;
+            }
+            pos = rowEnd + 1;
+            size_t index = row++;
+            if (m_header && index == 0) {
+                continue;
+            }
+
+            // strip whitespace outside and inside of quotes around the value
+            trimField(data, valueStart, valueEnd);
+            if (valueEnd - valueStart >= 2 && data[valueStart] == quote &&
+                    data[valueEnd - 1] == quote) {
+                trimField(data, ++valueStart, --valueEnd);
+            }
+            field.row = m_header ? index - 1 : index;
+            field.value = data + valueStart;
+            field.length = valueEnd - valueStart;
+            field.valid = found && IBAN::validateString(field.value, field.length);
+            field.line = data + rowStart;
+            field.lineLength = lineEnd - rowStart;
+            if (callback) {
+                callback(field);
+            }
+            reported++;
+        }
+        return reported;
+    }
+
+    /**
+     * Scans a document (see \p scanChunk()). With several threads, the
+     * chunks are scanned in parallel and \p callback is called concurrently
+     * and must be thread-safe.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param callback Receives the fields
+     * @return The number of rows reported
+     */
+    size_t CSVScanner::scan(const char* data, size_t length,
+                            const Callback& callback) const {
+        std::vector<CSVChunk> chunks = split(data, length, m_threads);
+        std::vector<size_t> reported(chunks.size(), 0);
+        runInParallel(m_pool, chunks.size(), [&](size_t i) {
+            reported[i] = scanChunk(data, chunks[i], callback);
+        });
+        size_t total = 0;
+        for (size_t value : reported) {
+            total += value;
+        }
+        return total;
+    }
+
+    /**
+     * Scans a CSV file (see \p scan()). The file is mapped into memory and
+     * the pointers passed to \p callback are only valid during the call.
+     * Throws a \p std::runtime_error if the file cannot be mapped.
+     *
+     * @param path The path of the file
+     * @param callback Receives the fields
+     * @return The number of rows reported
+     */
+    size_t CSVScanner::scanFile(const std::string& path,
+                                const Callback& callback) const {
+        MappedFile file(path);
+        return scan(file.data(), file.size(), callback);
+    }
+
+    /**
+     * Validates the IBAN column of a document and stores the results in a
+     * bitmap with one bit per row; bit \p i % 8 of byte \p i / 8 is set if
+     * row \p i is valid.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param bitmap Receives the bitmap
+     * @return The number of rows
+     */
+    size_t CSVScanner::validateColumn(const char* data, size_t length,
+                                      std::vector<unsigned char>& bitmap) const {
+        std::vector<CSVChunk> chunks = split(data, length, m_threads);
+        size_t rows = chunks.back().firstRow + chunks.back().rows;
+        if (m_header && rows > 0) {
+            rows--;
+        }
+
+        // one byte per row avoids sharing bytes of the bitmap between threads
+        std::vector<unsigned char> valid(rows, 0);
+        runInParallel(m_pool, chunks.size(), [&](size_t i) {
+            scanChunk(data, chunks[i], [&](const CSVField& field) {
+                valid[field.row] = field.valid ? 1 : 0;
+            });
+        });
+        bitmap.assign((rows + 7) / 8, 0);
+        for (size_t i = 0; i < rows; i++) {
+            bitmap[i / 8] = static_cast<unsigned char>(bitmap[i / 8] | (valid[i] << (i % 8)));
+        }
+        return rows;
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        csvscanner.h
+ * \brief       Header file declaring the CSV column scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a scanner validating the IBANs of one column of
+ * a CSV document. Large documents are split into chunks at row boundaries
+ * (outside of quoted fields) and the chunks are scanned in parallel.
+ */
+
+#ifndef LIBIBAN_CSVSCANNER_H
+#define LIBIBAN_CSVSCANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace IBAN {
+
+class ThreadPool;
+
+/// Field of the IBAN column of a row; all pointers refer to the scanned data
+struct CSVField {
+    /// Index of the row, counted from 0 (after the header if there is one)
+    size_t row;
+    /// Whether the field contains a valid IBAN
+    bool valid;
+    /// The value of the field without quotes and surrounding whitespace
+    const char* value;
+    /// The length of \p value
+    size_t length;
+    /// The whole row without its line break
+    const char* line;
+    /// The length of \p line
+    size_t lineLength;
+};
+
+/// Part of a CSV document starting at the beginning of a row
+struct CSVChunk {
+    /// The start of the chunk
+    size_t begin;
+    /// The end of the chunk
+    size_t end;
+    /// Index of the first row of the chunk, counting a header as row 0
+    size_t firstRow;
+    /// Number of rows starting in the chunk
+    size_t rows;
+};
+
+/// Validates the IBANs of one column of CSV documents
+class CSVScanner {
+
+private:
+    /// Index of the IBAN column, counted from 0
+    size_t m_column;
+    /// The field separator
+    char m_separator;
+    /// Whether the first row is a header
+    bool m_header;
+    /// Number of threads scanning chunks in parallel
+    unsigned m_threads;
+    /// The pool running the parallel scans or \p nullptr for own threads
+    ThreadPool* m_pool;
+
+    size_t countRows(const char* data, size_t begin, size_t end) const;
+
+public:
+    /// Receives the fields of the IBAN column
+    typedef std::function<void(const CSVField&)> Callback;
+
+    CSVScanner(size_t column, char separator = ',', bool header = false,
+               unsigned threads = 1);
+    CSVScanner(size_t column, char separator, bool header, ThreadPool& pool);
+    std::vector<CSVChunk> split(const char* data, size_t length,
+                                size_t parts) const;
+    size_t scanChunk(const char* data, const CSVChunk& chunk,
+                     const Callback& callback) const;
+    size_t scan(const char* data, size_t length,
+                const Callback& callback) const;
+    size_t scanFile(const std::string& path, const Callback& callback) const;
+    size_t validateColumn(const char* data, size_t length,
+                          std::vector<unsigned char>& bitmap) const;
+
+}; // end of class CSVScanner
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_CSVSCANNER_H
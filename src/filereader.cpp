@@ -0,0 +1,561 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        filereader.cpp
+ * \brief       Source file implementing the asynchronous file reader
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p FileReader. io_uring is used
+ * through its system calls directly, so no additional library is needed.
+ * Every buffer serves one file at a time with a single read in flight, which
+ * keeps the chunks of each file in order while many files are read at once.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register)
+#define LIBIBAN_HAVE_URING 1
+#endif
+#endif
+#endif
+#include "filereader.h"
+
+namespace IBAN {
+
+    /// A buffer serving one file at a time
+    struct ReadSlot {
+        /// The memory including the headroom
+        char* memory;
+        /// The descriptor of the current file or -1
+        int fd;
+        /// Index of the current file
+        size_t file;
+        /// Size of the current file
+        uint64_t size;
+        /// Offset of the next read
+        uint64_t offset;
+        /// Describes the buffer for vectored reads
+        iovec vector;
+    };
+
+    /// Frees the buffers of the slots
+    struct SlotBuffers {
+        std::vector<ReadSlot> slots;
+
+        SlotBuffers(unsigned count, size_t size) : slots(count) {
+            for (auto& slot : slots) {
+                void* memory = nullptr;
+                // page alignment lets the kernel pin the buffers cheaply
+                if (posix_memalign(&memory, 4096, size) != 0) {
+                    memory = nullptr;
+                }
+                slot = ReadSlot{static_cast<char*>(memory), -1, 0, 0, 0,
+                                iovec{nullptr, 0}};
+            }
+        }
+
+        ~SlotBuffers() {
+            for (auto& slot : slots) {
+                if (slot.fd >= 0) {
+                    close(slot.fd);
+                }
+                std::free(slot.memory);
+            }
+        }
+    };
+
+    /**
+     * Opens the next file that can be opened and assigns it to a slot.
+     * Files that cannot be opened are reported to \p callback.
+     *
+     * @param slot The slot
+     * @param paths The paths of the files
+     * @param next Index of the next file; advanced past the opened file
+     * @param callback Receives errors
+     * @return \p false if there are no more files
+     */
+    static bool openNext(ReadSlot& slot, const std::vector<std::string>& paths,
+                         size_t& next,
+                         const std::function<void(FileChunk&)>& callback) {
+        while (next < paths.size()) {
+            size_t file = next++;
+            int fd = open(paths[file].c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat info;
+            if (fd >= 0 && fstat(fd, &info) == 0) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+                posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                slot.fd = fd;
+                slot.file = file;
+                slot.size = static_cast<uint64_t>(info.st_size);
+                slot.offset = 0;
+                return true;
+            }
+            FileChunk chunk = {file, nullptr, 0, 0, true, errno};
+            if (fd >= 0) {
+                close(fd);
+            }
+            if (callback) {
+                callback(chunk);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Passes a completed read to the callback.
+     *
+     * @param slot The slot
+     * @param length The number of bytes read
+     * @param callback Receives the chunk
+     * @return Whether the chunk was the last one of the file
+     */
+    static bool deliver(ReadSlot& slot, size_t length,
+                        const std::function<void(FileChunk&)>& callback) {
+        // a read shorter than the buffer may also be a short read before
+        // the end, so the end of the file is taken from its size
+        bool last = length == 0 || slot.offset + length >= slot.size;
+        FileChunk chunk = {slot.file, slot.memory + FileReader::headroom, length,
+                           slot.offset, last, 0};
+        if (callback) {
+            callback(chunk);
+        }
+        slot.offset += length;
+        if (last) {
+            close(slot.fd);
+            slot.fd = -1;
+        }
+        return last;
+    }
+
+#if defined(LIBIBAN_HAVE_URING)
+    /// Submission and completion queue of an io_uring instance
+    struct UringQueue {
+        int fd;
+        void* sqRing;
+        size_t sqRingSize;
+        void* cqRing;
+        size_t cqRingSize;
+        io_uring_sqe* sqes;
+        size_t sqesSize;
+        unsigned* sqHead;
+        unsigned* sqTail;
+        unsigned* sqMask;
+        unsigned* sqArray;
+        unsigned* cqHead;
+        unsigned* cqTail;
+        unsigned* cqMask;
+        io_uring_cqe* cqes;
+        /// Whether the buffers are registered for fixed reads
+        bool fixed;
+        /// Number of entries queued but not yet submitted
+        unsigned pending;
+
+        UringQueue() : fd(-1), sqRing(MAP_FAILED), sqRingSize(0),
+                       cqRing(MAP_FAILED), cqRingSize(0),
+                       sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), sqesSize(0),
+                       sqHead(nullptr), sqTail(nullptr), sqMask(nullptr),
+                       sqArray(nullptr), cqHead(nullptr), cqTail(nullptr),
+                       cqMask(nullptr), cqes(nullptr), fixed(false), pending(0) {}
+
+        ~UringQueue() {
+            if (sqes != MAP_FAILED) {
+                munmap(sqes, sqesSize);
+            }
+            if (cqRing != MAP_FAILED && cqRing != sqRing) {
+                munmap(cqRing, cqRingSize);
+            }
+            if (sqRing != MAP_FAILED) {
+                munmap(sqRing, sqRingSize);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        /**
+         * Creates the io_uring instance and maps its queues.
+         *
+         * @param entries The number of submission queue entries
+         * @return \p false if io_uring is not available
+         */
+        bool setup(unsigned entries) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) {
+                return false;
+            }
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) {
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            }
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) {
+                return false;
+            }
+            cqRing = single ? sqRing :
+                     mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                return false;
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(
+                    mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (sqes == MAP_FAILED) {
+                return false;
+            }
+            char* sq = static_cast<char*>(sqRing);
+            char* cq = static_cast<char*>(cqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        /**
+         * Registers the buffers of the slots for fixed reads, which saves
+         * mapping them for every read. Fails for example if the buffers
+         * exceed the limit of locked memory; plain reads are used then.
+         *
+         * @param slots The slots
+         * @param size The size of each buffer
+         */
+        void registerBuffers(const std::vector<ReadSlot>& slots, size_t size) {
+            std::vector<iovec> vectors(slots.size());
+            for (size_t i = 0; i < slots.size(); i++) {
+                vectors[i].iov_base = slots[i].memory;
+                vectors[i].iov_len = size;
+            }
+            fixed = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                            vectors.data(), static_cast<unsigned>(vectors.size())) == 0;
+        }
+
+        /**
+         * Queues a read of the next part of the file of a slot.
+         *
+         * @param slots The slots
+         * @param index The index of the slot
+         * @param bufferSize The size of the buffer without the headroom
+         */
+        void queueRead(std::vector<ReadSlot>& slots, size_t index,
+                       size_t bufferSize) {
+            ReadSlot& slot = slots[index];
+            unsigned tail = *sqTail;
+            unsigned position = tail & *sqMask;
+            io_uring_sqe& sqe = sqes[position];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.fd = slot.fd;
+            sqe.off = slot.offset;
+            if (fixed) {
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.addr = reinterpret_cast<uint64_t>(slot.memory + FileReader::headroom);
+                sqe.len = static_cast<unsigned>(bufferSize);
+                sqe.buf_index = static_cast<uint16_t>(index);
+            } else {
+                slot.vector.iov_base = slot.memory + FileReader::headroom;
+                slot.vector.iov_len = bufferSize;
+                sqe.opcode = IORING_OP_READV;
+                sqe.addr = reinterpret_cast<uint64_t>(&slot.vector);
+                sqe.len = 1;
+            }
+            sqe.user_data = index;
+            sqArray[position] = position;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            pending++;
+        }
+
+        /**
+         * Submits the queued reads and waits for at least one completion.
+         *
+         * @return \p false on failure
+         */
+        bool submitAndWait() {
+            while (true) {
+                long result = syscall(__NR_io_uring_enter, fd, pending, 1,
+                                      IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (result >= 0) {
+                    pending -= std::min(pending, static_cast<unsigned>(result));
+                    return true;
+                }
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    return false;
+                }
+            }
+        }
+
+        /**
+         * Waits for the completions of submitted reads and discards them, so
+         * that no read still writes into a buffer that is released. Closing
+         * the ring does not wait for them. Waits in the kernel where possible
+         * and polls the completion queue otherwise.
+         *
+         * @param count The number of submitted reads not yet completed
+         */
+        void drain(unsigned count) {
+            unsigned head = *cqHead;
+            while (count > 0) {
+                if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                    if (syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS,
+                                nullptr, 0) < 0 && errno != EINTR) {
+                        usleep(1000);
+                    }
+                    continue;
+                }
+                __atomic_store_n(cqHead, ++head, __ATOMIC_RELEASE);
+                count--;
+            }
+        }
+
+        /**
+         * Unregisters the buffers registered by \p registerBuffers(), which
+         * keep their pages pinned while the ring is open.
+         */
+        void unregisterBuffers() {
+            if (fixed) {
+                syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+                fixed = false;
+            }
+        }
+    };
+
+    /**
+     * Reads the files with io_uring.
+     *
+     * @param queue The io_uring instance
+     * @param depth The number of reads in flight
+     * @param paths The paths of the files
+     * @param callback Receives the chunks
+     * @return The number of bytes read
+     */
+    uint64_t FileReader::readWithUring(UringQueue& queue, unsigned depth,
+                                       const std::vector<std::string>& paths,
+                                       const Callback& callback) const {
+        SlotBuffers buffers(depth, m_bufferSize + headroom);
+        std::vector<ReadSlot>& slots = buffers.slots;
+        queue.registerBuffers(slots, m_bufferSize + headroom);
+        size_t next = 0;
+        unsigned inFlight = 0;
+        uint64_t total = 0;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].memory != nullptr && openNext(slots[i], paths, next, callback)) {
+                queue.queueRead(slots, i, m_bufferSize);
+                inFlight++;
+            }
+        }
+        while (inFlight > 0) {
+            if (!queue.submitAndWait()) {
+                // every slot in flight has one read that is either queued or
+                // submitted; wait for the submitted ones before the files
+                // are closed and the buffers are released
+                int error = errno;
+                queue.drain(inFlight - queue.pending);
+                queue.unregisterBuffers();
+
+                // report the open files as failed and read the remaining
+                // ones synchronously
+                for (auto& slot : slots) {
+                    if (slot.fd < 0) {
+                        continue;
+                    }
+                    FileChunk chunk = {slot.file, nullptr, 0, slot.offset, true, error};
+                    close(slot.fd);
+                    slot.fd = -1;
+                    if (callback) {
+                        callback(chunk);
+                    }
+                }
+                std::vector<std::string> rest(paths.begin() + static_cast<std::ptrdiff_t>(next),
+                                              paths.end());
+                return total + readWithPread(rest, [&](FileChunk& chunk) {
+                    chunk.file += next;
+                    if (callback) {
+                        callback(chunk);
+                    }
+                });
+            }
+            unsigned head = *queue.cqHead;
+            while (head != __atomic_load_n(queue.cqTail, __ATOMIC_ACQUIRE)) {
+                io_uring_cqe& cqe = queue.cqes[head & *queue.cqMask];
+                size_t index = static_cast<size_t>(cqe.user_data);
+                int result = cqe.res;
+                __atomic_store_n(queue.cqHead, ++head, __ATOMIC_RELEASE);
+
+                ReadSlot& slot = slots[index];
+                if (result == -EINTR || result == -EAGAIN) {
+                    queue.queueRead(slots, index, m_bufferSize);
+                    continue;
+                }
+                bool last = true;
+                if (result < 0) {
+                    FileChunk chunk = {slot.file, nullptr, 0, slot.offset, true, -result};
+                    close(slot.fd);
+                    slot.fd = -1;
+                    if (callback) {
+                        callback(chunk);
+                    }
+                } else {
+                    total += static_cast<uint64_t>(result);
+                    last = deliver(slot, static_cast<size_t>(result), callback);
+                }
+                if (!last || openNext(slot, paths, next, callback)) {
+                    queue.queueRead(slots, index, m_bufferSize);
+                } else {
+                    inFlight--;
+                }
+            }
+        }
+        queue.unregisterBuffers();
+        return total;
+    }
+#else
+    /// Placeholder where io_uring is not available
+    struct UringQueue {};
+
+    uint64_t FileReader::readWithUring(UringQueue&, unsigned,
+                                       const std::vector<std::string>& paths,
+                                       const Callback& callback) const {
+        return readWithPread(paths, callback);
+    }
+#endif
+
+    /**
+     * Reads the files one after the other with \p pread().
+     *
+     * @param paths The paths of the files
+     * @param callback Receives the chunks
+     * @return The number of bytes read
+     */
+    uint64_t FileReader::readWithPread(const std::vector<std::string>& paths,
+                                       const Callback& callback) const {
+        SlotBuffers buffers(1, m_bufferSize + headroom);
+        ReadSlot& slot = buffers.slots.front();
+        size_t next = 0;
+        uint64_t total = 0;
+        while (slot.memory != nullptr && openNext(slot, paths, next, callback)) {
+            bool last = false;
+            while (!last) {
+                ssize_t result = pread(slot.fd, slot.memory + headroom, m_bufferSize,
+                                       static_cast<off_t>(slot.offset));
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result < 0) {
+                    FileChunk chunk = {slot.file, nullptr, 0, slot.offset, true, errno};
+                    close(slot.fd);
+                    slot.fd = -1;
+                    if (callback) {
+                        callback(chunk);
+                    }
+                    break;
+                }
+                total += static_cast<uint64_t>(result);
+                last = deliver(slot, static_cast<size_t>(result), callback);
+            }
+        }
+        return total;
+    }
+
+    /**
+     * Constructor of \p FileReader.
+     *
+     * @param bufferSize Size of each buffer, the maximum length of a chunk
+     *        (default: 1 MiB)
+     * @param depth Number of buffers and thus of reads in flight
+     *        (default: 64)
+     * @param useUring Whether io_uring is used if available
+     *        (default: \p true)
+     */
+    FileReader::FileReader(size_t bufferSize, unsigned depth, bool useUring) :
+            m_bufferSize(std::max<size_t>(4096, bufferSize)),
+            m_depth(std::max(1u, std::min(depth, 4096u))),
+            m_useUring(useUring) {}
+
+    /**
+     * Reads files and passes their contents to \p callback in chunks of at
+     * most the buffer size. The chunks of each file arrive in order and the
+     * last one has \p last set; an empty file yields a single empty chunk.
+     * Files that cannot be read yield a chunk with \p error set. Chunks of
+     * different files may be interleaved. The data of a chunk is only valid
+     * during the call, after which its buffer is reused.
+     *
+     * @param paths The paths of the files
+     * @param callback Receives the chunks
+     * @return The number of bytes read
+     */
+    uint64_t FileReader::readFiles(const std::vector<std::string>& paths,
+                                   const Callback& callback) const {
+#if defined(LIBIBAN_HAVE_URING)
+        if (m_useUring && !paths.empty()) {
+            UringQueue queue;
+            unsigned depth = static_cast<unsigned>(
+                    std::min<size_t>(m_depth, paths.size()));
+            if (queue.setup(depth)) {
+                return readWithUring(queue, depth, paths, callback);
+            }
+        }
+#endif
+        return readWithPread(paths, callback);
+    }
+
+    /**
+     * Checks whether io_uring can be used on this system; it may be missing
+     * from the kernel or blocked by a sandbox.
+     *
+     * @return \p true if io_uring is available
+     */
+    bool FileReader::isUringAvailable() {
+#if defined(LIBIBAN_HAVE_URING)
+        UringQueue queue;
+        return queue.setup(1);
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        filereader.h
+ * \brief       Header file declaring the asynchronous file reader
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a reader keeping many reads of many files in
+ * flight with io_uring on Linux. The data is read into a fixed set of
+ * buffers registered with the kernel and handed to a callback in place.
+ * Where io_uring is not available, the files are read with \p pread().
+ */
+
+#ifndef LIBIBAN_FILEREADER_H
+#define LIBIBAN_FILEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace IBAN {
+
+/// Part of a file read by a \p FileReader
+struct FileChunk {
+    /// Index of the file in the list passed to \p FileReader::readFiles()
+    size_t file;
+    /// The data; may be modified by the callback
+    char* data;
+    /// The length of \p data
+    size_t length;
+    /// Offset of \p data inside the file
+    uint64_t offset;
+    /// Whether this is the last chunk of the file
+    bool last;
+    /// The \p errno value if the file could not be read, 0 otherwise
+    int error;
+};
+
+struct UringQueue;
+
+/// Reads many files with many reads in flight
+class FileReader {
+
+private:
+    /// Size of each buffer
+    size_t m_bufferSize;
+    /// Number of buffers and thus of reads in flight
+    unsigned m_depth;
+    /// Whether io_uring may be used
+    bool m_useUring;
+
+    uint64_t readWithUring(UringQueue& queue, unsigned depth,
+                           const std::vector<std::string>& paths,
+                           const std::function<void(FileChunk&)>& callback) const;
+    uint64_t readWithPread(const std::vector<std::string>& paths,
+                           const std::function<void(FileChunk&)>& callback) const;
+
+public:
+    /// Number of writable bytes in front of the data of every chunk, for
+    /// example to prepend the end of the previous chunk
+    static const size_t headroom = 64;
+
+    /// Receives the chunks in the thread calling \p readFiles()
+    typedef std::function<void(FileChunk&)> Callback;
+
+    FileReader(size_t bufferSize = 1 << 20, unsigned depth = 64,
+               bool useUring = true);
+    uint64_t readFiles(const std::vector<std::string>& paths,
+                       const Callback& callback) const;
+    static bool isUringAvailable();
+
+}; // end of class FileReader
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_FILEREADER_H
@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        incremental.cpp
+ * \brief       Source file implementing the incremental IBAN validator
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p IncrementalValidator.
+ */
+
+#include <cctype>
+#include "incremental.h"
+#include "libiban.h"
+#include "registry.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /// Marks the absence of a structural error
+    static const size_t none = static_cast<size_t>(-1);
+
+    /**
+     * Constructor of \p IncrementalValidator. Creates a validator for an
+     * empty input.
+     */
+    IncrementalValidator::IncrementalValidator() {
+        reset();
+    }
+
+    /**
+     * Discards all characters entered so far.
+     */
+    void IncrementalValidator::reset() {
+        m_count = 0;
+        m_expected = 0;
+        m_format = "";
+        m_badPosition = none;
+        m_errorPosition = 0;
+        m_remainders[0] = 0;
+        m_state = ValidationState::Incomplete;
+    }
+
+    /**
+     * Appends a single character to the input and returns the new state.
+     * Whitespace is ignored and letters may be in either case. Only a
+     * constant amount of work is done per character, because the remainder
+     * of the BBAN is updated incrementally.
+     *
+     * @param ch The character to append
+     * @return The state of the input after appending \p ch
+     */
+    ValidationState IncrementalValidator::push(char ch) {
+        if (std::isspace(static_cast<unsigned char>(ch))) {
+            return m_state;
+        }
+        int value = getCharValue(ch);
+        size_t position = m_count++;
+        if (position < capacity) {
+            m_values[position] = value;
+        }
+        if (m_badPosition != none) {
+            return m_state;
+        }
+
+        bool bad = value < 0 || position >= capacity ||
+                   (position < 2 && value < 10) ||
+                   (position >= 2 && position < 4 && value >= 10) ||
+                   (m_expected != 0 && position >= m_expected);
+        if (!bad && position == 1) {
+            char first = static_cast<char>('A' + m_values[0] - 10);
+            char second = static_cast<char>('A' + m_values[1] - 10);
+            m_expected = IBAN::getLengthForCountry(first, second);
+            m_format = lookupCountryFormat(first, second);
+            bad = m_expected == 0;
+        }
+        if (!bad && position >= 4) {
+            bad = !matchesFormatClass(getFormatClass(m_format, position - 4),
+                                      value);
+        }
+        if (bad) {
+            m_badPosition = position;
+        } else if (position >= 4) {
+            m_remainders[position - 3] =
+                    foldRemainder(m_remainders[position - 4], value);
+        }
+        return evaluate();
+    }
+
+    /**
+     * Appends several characters, for example pasted text, to the input.
+     *
+     * @param data Pointer to the first character
+     * @param length The number of characters
+     * @return The state of the input after appending all characters
+     */
+    ValidationState IncrementalValidator::push(const char* data, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            push(data[i]);
+        }
+        return m_state;
+    }
+
+    /**
+     * Removes the last character (whitespace excluded) from the input, which
+     * corresponds to pressing backspace.
+     *
+     * @return The state of the input after removing the character
+     */
+    ValidationState IncrementalValidator::pop() {
+        if (m_count == 0) {
+            return m_state;
+        }
+        m_count--;
+        if (m_badPosition != none && m_badPosition >= m_count) {
+            m_badPosition = none;
+        }
+        if (m_count < 2) {
+            m_expected = 0;
+            m_format = "";
+        }
+        return evaluate();
+    }
+
+    /**
+     * Returns the state of the input entered so far.
+     *
+     * @return The current state
+     */
+    ValidationState IncrementalValidator::getState() const {
+        return m_state;
+    }
+
+    /**
+     * Returns the position (whitespace excluded) at which the input became
+     * invalid. For a structural error this is the offending character. If the
+     * checksum does not match, the position of the checksum (2) is returned.
+     * If the last missing character cannot complete a valid IBAN anymore, the
+     * position of that character is returned. The value is meaningless
+     * unless the state is \p ValidationState::Invalid.
+     *
+     * @return The position of the error
+     */
+    size_t IncrementalValidator::getErrorPosition() const {
+        return m_errorPosition;
+    }
+
+    /**
+     * Returns the number of characters (whitespace excluded) entered so far.
+     *
+     * @return The length of the input
+     */
+    size_t IncrementalValidator::getLength() const {
+        return m_count;
+    }
+
+    /**
+     * Determines the state of the input from the stored remainders.
+     *
+     * @return The new state
+     */
+    ValidationState IncrementalValidator::evaluate() {
+        m_state = ValidationState::Incomplete;
+        if (m_badPosition != none) {
+            m_state = ValidationState::Invalid;
+            m_errorPosition = m_badPosition;
+        } else if (m_expected != 0 && m_count == m_expected) {
+            if (finalRemainder(m_remainders[m_count - 4]) == 1) {
+                m_state = ValidationState::Valid;
+            } else {
+                m_state = ValidationState::Invalid;
+                m_errorPosition = 2;
+            }
+        } else if (m_expected != 0 && m_count + 1 == m_expected) {
+            // a single character is missing, so only 36 completions remain
+            char type = getFormatClass(m_format, m_count - 4);
+            for (int value = 0; value < 36; value++) {
+                if (!matchesFormatClass(type, value)) {
+                    continue;
+                }
+                unsigned remainder = foldRemainder(m_remainders[m_count - 4],
+                                                   value);
+                if (finalRemainder(remainder) == 1) {
+                    return m_state;
+                }
+            }
+            m_state = ValidationState::Invalid;
+            m_errorPosition = m_count;
+        }
+        return m_state;
+    }
+
+    /**
+     * Calculates the remainder of the complete IBAN from the remainder of its
+     * BBAN by appending the country code and the checksum.
+     *
+     * @param bbanRemainder The remainder of the BBAN
+     * @return The remainder of the whole IBAN
+     */
+    unsigned IncrementalValidator::finalRemainder(unsigned bbanRemainder) const {
+        // country code and checksum always form six decimal digits
+        unsigned remainder = bbanRemainder * getPowerOfTen(6) % 97;
+        unsigned head = 0;
+        for (size_t i = 0; i < 4; i++) {
+            head = foldRemainder(head, m_values[i]);
+        }
+        return (remainder + head) % 97;
+    }
+}
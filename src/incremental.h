@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        incremental.h
+ * \brief       Header file declaring the incremental IBAN validator
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a validator that checks an IBAN character by
+ * character while it is being typed.
+ */
+
+#ifndef LIBIBAN_INCREMENTAL_H
+#define LIBIBAN_INCREMENTAL_H
+
+#include <cstddef>
+
+namespace IBAN {
+
+/// State of an IBAN entered so far
+enum class ValidationState {
+    /// The input can still become a valid IBAN
+    Incomplete,
+    /// The input cannot become a valid IBAN anymore
+    Invalid,
+    /// The input is a complete and valid IBAN
+    Valid
+};
+
+/// Validates an IBAN incrementally with constant work per character
+class IncrementalValidator {
+
+private:
+    /// Maximum number of characters stored
+    static const size_t capacity = 34;
+    /// Values of the characters entered so far
+    int m_values[capacity];
+    /// Remainders of the BBAN after each of its characters
+    unsigned m_remainders[capacity - 3];
+    /// Number of characters entered so far (whitespace excluded)
+    size_t m_count;
+    /// Length required for the entered country, 0 while unknown
+    size_t m_expected;
+    /// BBAN format of the entered country
+    const char* m_format;
+    /// Position of the first character violating the IBAN structure
+    size_t m_badPosition;
+    /// Position reported by \p getErrorPosition()
+    size_t m_errorPosition;
+    /// Current state
+    ValidationState m_state;
+
+    ValidationState evaluate();
+    unsigned finalRemainder(unsigned bbanRemainder) const;
+
+public:
+    IncrementalValidator();
+    ValidationState push(char ch);
+    ValidationState push(const char* data, size_t length);
+    ValidationState pop();
+    void reset();
+    ValidationState getState() const;
+    size_t getErrorPosition() const;
+    size_t getLength() const;
+
+}; // end of class IncrementalValidator
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_INCREMENTAL_H
@@ -0,0 +1,413 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        jsonlscanner.cpp
+ * \brief       Source file implementing the JSON Lines scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p JSONLScanner. Every line is parsed
+ * once; values outside of the configured paths are skipped without looking
+ * at their structure more closely than needed to find their end.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "jsonlscanner.h"
+#include "libiban.h"
+#include "mappedfile.h"
+#include "parallel.h"
+
+namespace IBAN {
+
+    /// Returned by the parsing functions for malformed input
+    static const size_t malformed = static_cast<size_t>(-1);
+
+    /// Bit mask of the paths still matching the current position
+    typedef uint64_t PathMask;
+
+    /// Parsing state of a single line
+    struct LineParser {
+        /// The scanned data
+        const char* data;
+        /// The end of the line
+        size_t end;
+        /// The paths
+        const std::vector<std::vector<JSONPathSegment>>& paths;
+        /// The fields of the line
+        std::vector<JSONField>& fields;
+    };
+
+    /**
+     * Skips whitespace.
+     *
+     * @param data The data
+     * @param pos The position to start at
+     * @param end The end of the line
+     * @return The position of the next other character
+     */
+    static size_t skipSpace(const char* data, size_t pos, size_t end) {
+        while (pos < end && (data[pos] == ' ' || data[pos] == '\t' ||
+                             data[pos] == '\r' || data[pos] == '\n')) {
+            pos++;
+        }
+        return pos;
+    }
+
+    /**
+     * Skips a string.
+     *
+     * @param data The data
+     * @param pos The position after the opening quote
+     * @param end The end of the line
+     * @return The position of the closing quote or \p malformed
+     */
+    static size_t skipString(const char* data, size_t pos, size_t end) {
+        while (pos < end) {
+            const void* found = std::memchr(data + pos, '"', end - pos);
+            if (found == nullptr) {
+                return malformed;
+            }
+            size_t quote = static_cast<size_t>(static_cast<const char*>(found) - data);
+            // the quote is escaped if an odd number of backslashes precedes it
+            size_t backslashes = 0;
+            while (quote - backslashes > pos && data[quote - backslashes - 1] == '\\') {
+                backslashes++;
+            }
+            if (backslashes % 2 == 0) {
+                return quote;
+            }
+            pos = quote + 1;
+        }
+        return malformed;
+    }
+
+    /**
+     * Skips a value without checking its contents beyond the nesting of
+     * objects and arrays.
+     *
+     * @param data The data
+     * @param pos The position of the first character of the value
+     * @param end The end of the line
+     * @return The position after the value or \p malformed
+     */
+    static size_t skipValue(const char* data, size_t pos, size_t end) {
+        size_t depth = 0;
+        while (pos < end) {
+            char ch = data[pos];
+            if (ch == '"') {
+                pos = skipString(data, pos + 1, end);
+                if (pos == malformed) {
+                    return malformed;
+                }
+                pos++;
+            } else if (ch == '{' || ch == '[') {
+                depth++;
+                pos++;
+            } else if (ch == '}' || ch == ']') {
+                if (depth == 0) {
+                    return pos;
+                }
+                depth--;
+                pos++;
+            } else if (depth == 0 && (ch == ',' || ch == ' ' || ch == '\t' ||
+                                      ch == '\r' || ch == '\n')) {
+                return pos;
+            } else {
+                pos++;
+            }
+            if (depth == 0 && (ch == '"' || ch == '}' || ch == ']')) {
+                return pos;
+            }
+        }
+        return depth == 0 ? pos : malformed;
+    }
+
+    /**
+     * Parses a value and records the strings at the end of matching paths.
+     *
+     * @param parser The state of the line
+     * @param pos The position of the first character of the value
+     * @param depth The number of path segments leading to the value
+     * @param mask The paths leading to the value
+     * @return The position after the value or \p malformed
+     */
+    static size_t parseValue(LineParser& parser, size_t pos, size_t depth,
+                             PathMask mask) {
+        const char* data = parser.data;
+        if (mask == 0 || pos >= parser.end) {
+            return skipValue(data, pos, parser.end);
+        }
+        char ch = data[pos];
+        if (ch == '"') {
+            size_t close = skipString(data, pos + 1, parser.end);
+            if (close == malformed) {
+                return malformed;
+            }
+            for (size_t i = 0; i < parser.paths.size(); i++) {
+                if ((mask >> i & 1) != 0 && parser.paths[i].size() == depth) {
+                    JSONField& field = parser.fields[i];
+                    field.found = true;
+                    field.value = data + pos + 1;
+                    field.length = close - pos - 1;
+                    field.offset = pos + 1;
+                    field.valid = IBAN::validateString(field.value, field.length);
+                }
+            }
+            return close + 1;
+        }
+        if (ch != '{' && ch != '[') {
+            return skipValue(data, pos, parser.end);
+        }
+
+        bool object = ch == '{';
+        char closing = object ? '}' : ']';
+        size_t index = 0;
+        pos = skipSpace(data, pos + 1, parser.end);
+        if (pos < parser.end && data[pos] == closing) {
+            return pos + 1;
+        }
+        while (pos < parser.end) {
+            // select the paths continuing with this member or element
+            PathMask next = 0;
+            if (object) {
+                if (data[pos] != '"') {
+                    return malformed;
+                }
+                size_t close = skipString(data, pos + 1, parser.end);
+                if (close == malformed) {
+                    return malformed;
+                }
+                const char* key = data + pos + 1;
+                size_t keyLength = close - pos - 1;
+                for (size_t i = 0; i < parser.paths.size(); i++) {
+                    if ((mask >> i & 1) == 0 || parser.paths[i].size() <= depth) {
+                        continue;
+                    }
+                    const JSONPathSegment& segment = parser.paths[i][depth];
+                    if (!segment.element && segment.key.length() == keyLength &&
+                            std::memcmp(segment.key.data(), key, keyLength) == 0) {
+                        next |= PathMask(1) << i;
+                    }
+                }
+                pos = skipSpace(data, close + 1, parser.end);
+                if (pos >= parser.end || data[pos] != ':') {
+                    return malformed;
+                }
+                pos = skipSpace(data, pos + 1, parser.end);
+            } else {
+                for (size_t i = 0; i < parser.paths.size(); i++) {
+                    if ((mask >> i & 1) != 0 && parser.paths[i].size() > depth &&
+                            parser.paths[i][depth].element &&
+                            parser.paths[i][depth].index == index) {
+                        next |= PathMask(1) << i;
+                    }
+                }
+                index++;
+            }
+
+            pos = parseValue(parser, pos, depth + 1, next);
+            if (pos == malformed) {
+                return malformed;
+            }
+            pos = skipSpace(data, pos, parser.end);
+            if (pos >= parser.end) {
+                return malformed;
+            }
+            if (data[pos] == closing) {
+                return pos + 1;
+            }
+            if (data[pos] != ',') {
+                return malformed;
+            }
+            pos = skipSpace(data, pos + 1, parser.end);
+        }
+        return malformed;
+    }
+
+    /**
+     * Parses a field path like \p $.creditor.account.iban or
+     * \p $.parties[1].iban. The leading \p $ is optional.
+     *
+     * @param path The path
+     * @return The segments of the path
+     * @throws invalid_argument If the path is malformed
+     */
+    static std::vector<JSONPathSegment> parsePath(const std::string& path) {
+        std::vector<JSONPathSegment> segments;
+        size_t pos = !path.empty() && path[0] == '$' ? 1 : 0;
+        while (pos < path.length()) {
+            JSONPathSegment segment = {"", 0, false};
+            if (path[pos] == '.') {
+                size_t end = path.find_first_of(".[", pos + 1);
+                if (end == std::string::npos) {
+                    end = path.length();
+                }
+                segment.key = path.substr(pos + 1, end - pos - 1);
+                if (segment.key.empty()) {
+                    throw std::invalid_argument("Empty member name in path " + path);
+                }
+                pos = end;
+            } else if (path[pos] == '[') {
+                size_t end = path.find(']', pos);
+                if (end == std::string::npos || end == pos + 1 ||
+                        path.find_first_not_of("0123456789", pos + 1) != end) {
+                    throw std::invalid_argument("Invalid array index in path " + path);
+                }
+                segment.element = true;
+                segment.index = std::stoul(path.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+            } else {
+                throw std::invalid_argument("Unexpected character in path " + path);
+            }
+            segments.push_back(segment);
+        }
+        if (segments.empty()) {
+            throw std::invalid_argument("Empty path");
+        }
+        return segments;
+    }
+
+    /**
+     * Constructor of \p JSONLScanner. Throws a \p std::invalid_argument if a
+     * path is malformed or if there are more than \p maxPaths paths.
+     *
+     * @param paths The paths of the fields, like \p $.creditor.account.iban
+     * @param threads Number of threads scanning lines in parallel
+     *        (default: 1); 0 selects the number of hardware threads
+     */
+    JSONLScanner::JSONLScanner(const std::vector<std::string>& paths,
+                               unsigned threads) : m_threads(threads), m_pool(nullptr) {
+        if (paths.empty() || paths.size() > maxPaths) {
+            throw std::invalid_argument("Expected 1 to 64 paths");
+        }
+        for (auto& path : paths) {
+            m_paths.push_back(parsePath(path));
+        }
+        if (m_threads == 0) {
+            m_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**
+     * Constructor of \p JSONLScanner scanning lines on the workers of a
+     * pool. Throws a \p std::invalid_argument if a path is malformed or if
+     * there are more than \p maxPaths paths. The pool must outlive the
+     * scanner and callbacks must not use it.
+     *
+     * @param paths The paths of the fields, like \p $.creditor.account.iban
+     * @param pool The pool
+     */
+    JSONLScanner::JSONLScanner(const std::vector<std::string>& paths,
+                               ThreadPool& pool) : JSONLScanner(paths, 1) {
+        m_threads = static_cast<unsigned>(pool.getThreadCount());
+        m_pool = &pool;
+    }
+
+    /**
+     * Scans a JSON Lines document. Every line holding a JSON value is passed
+     * to \p callback with the strings found at the configured paths and
+     * their validity; empty lines are skipped but counted. The strings are
+     * not copied, so escape sequences inside them make them invalid.
+     *
+     * With several threads, large documents are split at line breaks and
+     * the parts are scanned in parallel; \p callback is then called
+     * concurrently and must be thread-safe.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param callback Receives the results of the lines
+     * @return The number of lines
+     */
+    size_t JSONLScanner::scan(const char* data, size_t length,
+                              const Callback& callback) const {
+        return scanInParallel(m_pool, m_threads, data, length, "\n", true,
+                [&](size_t begin, size_t end, size_t first) {
+                    return scanRange(data, begin, end, first, callback);
+                });
+    }
+
+    /**
+     * Scans the lines of a part of a document.
+     *
+     * @param data The document
+     * @param begin The start of the part
+     * @param end The end of the part
+     * @param firstLine The index of the first line of the part
+     * @param callback Receives the results of the lines
+     * @return The number of lines in the part
+     */
+    size_t JSONLScanner::scanRange(const char* data, size_t begin, size_t end,
+                                   size_t firstLine,
+                                   const Callback& callback) const {
+        std::vector<JSONField> fields(m_paths.size());
+        PathMask all = m_paths.size() == maxPaths ? ~PathMask(0) :
+                       (PathMask(1) << m_paths.size()) - 1;
+        size_t lines = 0, pos = begin;
+        while (pos < end) {
+            const void* found = std::memchr(data + pos, '\n', end - pos);
+            size_t lineEnd = found == nullptr ? end :
+                    static_cast<size_t>(static_cast<const char*>(found) - data);
+            size_t start = skipSpace(data, pos, lineEnd);
+            size_t index = firstLine + lines++;
+            pos = lineEnd + 1;
+            if (start == lineEnd) {
+                continue;
+            }
+
+            std::fill(fields.begin(), fields.end(), JSONField{false, false, nullptr, 0, 0});
+            LineParser parser = {data, lineEnd, m_paths, fields};
+            size_t after = parseValue(parser, start, 0, all);
+            bool broken = after == malformed || skipSpace(data, after, lineEnd) != lineEnd;
+            if (broken) {
+                std::fill(fields.begin(), fields.end(), JSONField{false, false, nullptr, 0, 0});
+            }
+            JSONLine line = {index, broken, fields.data(), fields.size()};
+            if (callback) {
+                callback(line);
+            }
+        }
+        return lines;
+    }
+
+    /**
+     * Scans a JSON Lines file (see \p scan()). The file is mapped into
+     * memory and the pointers passed to \p callback are only valid during
+     * the call. Throws a \p std::runtime_error if the file cannot be mapped.
+     *
+     * @param path The path of the file
+     * @param callback Receives the results of the lines
+     * @return The number of lines
+     */
+    size_t JSONLScanner::scanFile(const std::string& path,
+                                  const Callback& callback) const {
+        MappedFile file(path);
+        return scan(file.data(), file.size(), callback);
+    }
+}
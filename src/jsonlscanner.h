@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        jsonlscanner.h
+ * \brief       Header file declaring the JSON Lines scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a streaming scanner locating string fields given
+ * by paths like \p $.creditor.account.iban in JSON Lines documents and
+ * validating them as IBANs, without building a document tree.
+ */
+
+#ifndef LIBIBAN_JSONLSCANNER_H
+#define LIBIBAN_JSONLSCANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace IBAN {
+
+class ThreadPool;
+
+/// Field of a JSON line selected by a path; pointers refer to the scanned data
+struct JSONField {
+    /// Whether the line contains a string at the path
+    bool found;
+    /// Whether the string is a valid IBAN
+    bool valid;
+    /// The string without quotes; escape sequences are not decoded
+    const char* value;
+    /// The length of \p value
+    size_t length;
+    /// Byte offset of the string inside the scanned data
+    size_t offset;
+};
+
+/// Result of a JSON line
+struct JSONLine {
+    /// Index of the line, counted from 0
+    size_t line;
+    /// Whether the line is no well-formed JSON value
+    bool malformed;
+    /// The fields in the order of the paths given to the scanner
+    const JSONField* fields;
+    /// Number of fields
+    size_t count;
+};
+
+/// Segment of a field path: an object member or an array element
+struct JSONPathSegment {
+    /// The name of the member; empty for array elements
+    std::string key;
+    /// The index of the array element
+    size_t index;
+    /// Whether the segment selects an array element
+    bool element;
+};
+
+/// Locates and validates IBAN fields of JSON Lines documents
+class JSONLScanner {
+
+private:
+    /// The parsed paths
+    std::vector<std::vector<JSONPathSegment>> m_paths;
+    /// Number of threads scanning lines in parallel
+    unsigned m_threads;
+    /// The pool running the parallel scans or \p nullptr for own threads
+    ThreadPool* m_pool;
+
+    size_t scanRange(const char* data, size_t begin, size_t end,
+                     size_t firstLine,
+                     const std::function<void(const JSONLine&)>& callback) const;
+
+public:
+    /// Maximum number of paths of a scanner
+    static const size_t maxPaths = 64;
+
+    /// Receives the results of the lines
+    typedef std::function<void(const JSONLine&)> Callback;
+
+    JSONLScanner(const std::vector<std::string>& paths, unsigned threads = 1);
+    JSONLScanner(const std::vector<std::string>& paths, ThreadPool& pool);
+    size_t scan(const char* data, size_t length,
+                const Callback& callback) const;
+    size_t scanFile(const std::string& path, const Callback& callback) const;
+
+}; // end of class JSONLScanner
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_JSONLSCANNER_H
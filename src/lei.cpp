@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        lei.cpp
+ * \brief       Source file implementing ISO 17442 Legal Entity Identifiers
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p LEI on top of the MOD 97-10
+ * functions shared with the IBAN implementation.
+ */
+
+#include <cctype>
+#include "lei.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p LEIParseException.
+     *
+     * @param lei The string causing the exception
+     */
+    LEIParseException::LEIParseException(const std::string& lei) noexcept :
+            m_lei(lei) {
+        m_message = "Cannot parse LEI " + m_lei;
+    }
+
+    /**
+     * Destructor of \p LEIParseException
+     */
+    LEIParseException::~LEIParseException() {}
+
+    /**
+     * Overrides the function \p what() for this exception and returns a
+     * string describing the error.
+     *
+     * @return A string describing the error
+     */
+    const char* LEIParseException::what() const noexcept {
+        return m_message.c_str();
+    }
+
+    /**
+     * Checks whether the characters of an identifier are alphanumerical and
+     * its check digits are digits.
+     *
+     * @param data Pointer to the first character
+     * @param length The number of characters
+     * @param checkDigits Whether the identifier ends with check digits
+     * @return \p true if the structure is valid, \p false otherwise
+     */
+    static bool isStructureValid(const char* data, size_t length,
+                                 bool checkDigits) {
+        size_t baseLength = LEI::length - 2;
+        if (length != (checkDigits ? LEI::length : baseLength)) {
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            int value = getCharValue(data[i]);
+            if (value < 0 || (i >= baseLength && value > 9)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Creates an LEI from a string. Whitespace is ignored and letters may be
+     * in either case. Throws an \p LEIParseException if the string is not
+     * structurally valid; use \p validate() to check the checksum.
+     *
+     * @param string The string to parse
+     * @return The LEI
+     */
+    LEI LEI::createFromString(const std::string& string) {
+        std::string s = string;
+        trim(s);
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        if (!isStructureValid(s.data(), s.length(), true)) {
+            throw LEIParseException(string);
+        }
+        return LEI(s.substr(0, length - 2), s.substr(length - 2));
+    }
+
+    /**
+     * Calculates the check digits for the first 18 characters of an LEI.
+     * Throws an \p LEIParseException if \p base does not consist of exactly 18
+     * alphanumerical characters.
+     *
+     * @param base The characters in front of the check digits
+     * @return The two check digits
+     */
+    std::string LEI::computeCheckDigits(const std::string& base) {
+        if (!isStructureValid(base.data(), base.length(), false)) {
+            throw LEIParseException(base);
+        }
+        long remainder = getRemainder(base.data(), base.length());
+        long digits = 98 - static_cast<long>(
+                static_cast<unsigned long>(remainder) * getPowerOfTen(2) % 97);
+        return std::string(1, static_cast<char>('0' + digits / 10)) +
+               static_cast<char>('0' + digits % 10);
+    }
+
+    /**
+     * Creates an LEI with correct check digits from its first 18 characters.
+     * Throws an \p LEIParseException if \p base is malformed.
+     *
+     * @param base The characters in front of the check digits
+     * @return The LEI
+     */
+    LEI LEI::generate(const std::string& base) {
+        std::string s = base;
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        return LEI(s, computeCheckDigits(s));
+    }
+
+    /**
+     * Returns the prefix identifying the Local Operating Unit that issued the
+     * LEI (the first four characters).
+     *
+     * @return The LOU prefix
+     */
+    std::string LEI::getLOUPrefix() const {
+        return m_base.substr(0, 4);
+    }
+
+    /**
+     * Returns the entity specific part of the LEI (characters 5 to 18).
+     *
+     * @return The entity code
+     */
+    std::string LEI::getEntityCode() const {
+        return m_base.substr(4);
+    }
+
+    /**
+     * Returns the check digits of the LEI.
+     *
+     * @return The check digits
+     */
+    std::string LEI::getChecksum() const {
+        return m_checkSum;
+    }
+
+    /**
+     * Returns the LEI as a string of 20 characters.
+     *
+     * @return The LEI
+     */
+    std::string LEI::toString() const {
+        return m_base + m_checkSum;
+    }
+
+    /**
+     * Validates the checksum of the LEI.
+     *
+     * @return \p true if the LEI is valid, \p false otherwise
+     */
+    bool LEI::validate() const {
+        std::string lei = toString();
+        return validateString(lei.data(), lei.length());
+    }
+
+    /**
+     * Validates an LEI given as a character sequence without creating an
+     * instance of \p LEI and without allocating memory. Whitespace is ignored
+     * and letters may be in either case.
+     *
+     * @param data Pointer to the first character of the LEI
+     * @param length The number of characters
+     * @return \p true if the sequence is a valid LEI, \p false otherwise
+     */
+    bool LEI::validateString(const char* data, size_t length) {
+        char compact[LEI::length];
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (std::isspace(static_cast<unsigned char>(data[i]))) {
+                continue;
+            }
+            if (count == LEI::length) {
+                return false;
+            }
+            compact[count++] = data[i];
+        }
+        return isStructureValid(compact, count, true) &&
+               hasValidMod97Checksum(compact, count, 0);
+    }
+
+    /**
+     * Validates many LEIs stored in fixed width records without allocating
+     * memory. Whitespace inside a record is ignored, so records may contain
+     * separators or padding.
+     *
+     * @param leis Pointer to the first record
+     * @param recordLength The length of each record
+     * @param count The number of records
+     * @param results Output array receiving \p count results
+     * @return The number of valid LEIs
+     */
+    size_t LEI::validateBatch(const char* leis, size_t recordLength,
+                              size_t count, bool* results) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++) {
+            results[i] = validateString(leis + i * recordLength, recordLength);
+            if (results[i]) {
+                valid++;
+            }
+        }
+        return valid;
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        lei.h
+ * \brief       Header file declaring ISO 17442 Legal Entity Identifiers
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a class representing Legal Entity Identifiers
+ * (LEI) according to ISO 17442. Their two trailing check digits use the same
+ * MOD 97-10 checksum as IBANs.
+ */
+
+#ifndef LIBIBAN_LEI_H
+#define LIBIBAN_LEI_H
+
+#include <string>
+#include <ostream>
+#include <stdexcept>
+
+namespace IBAN {
+
+/// Exception to be thrown when parsing a Legal Entity Identifier fails
+class LEIParseException : public std::exception {
+
+private:
+    /// Holds the identifier causing the error
+    std::string m_lei;
+    /// The exception message
+    std::string m_message;
+
+public:
+    LEIParseException(const std::string& lei) noexcept;
+    virtual ~LEIParseException();
+    virtual const char* what() const noexcept;
+
+    /// Copy constructor for \p LEIParseException. Uses the default copy
+    /// constructor
+    LEIParseException(const LEIParseException& other)=default;
+};
+
+/// Legal Entity Identifier according to ISO 17442
+class LEI {
+
+private:
+    /// Holds the 18 characters in front of the check digits
+    std::string m_base {};
+    /// Holds the check digits
+    std::string m_checkSum {};
+    LEI(const std::string& base, const std::string& checkSum) :
+            m_base(base), m_checkSum(checkSum) {}
+
+public:
+    /// Length of a Legal Entity Identifier
+    static const size_t length = 20;
+
+    /// Copy constructor for \p LEI. Uses the default copy constructor
+    LEI(const LEI&)=default;
+    bool operator==(const LEI& other) const;
+    bool operator!=(const LEI& other) const;
+    static LEI createFromString(const std::string& string);
+    static LEI generate(const std::string& base);
+    static std::string computeCheckDigits(const std::string& base);
+    std::string getLOUPrefix() const;
+    std::string getEntityCode() const;
+    std::string getChecksum() const;
+    std::string toString() const;
+    bool validate() const;
+    static bool validateString(const char* data, size_t length);
+    static size_t validateBatch(const char* leis, size_t recordLength,
+                                size_t count, bool* results);
+
+}; // end of class LEI
+
+/**
+ * Overloads the comparison operator ==.
+ *
+ * @param other The object to compare with
+ * @return \p true if both objects are equal, \p false otherwise
+ */
+inline bool LEI::operator==(const LEI& other) const {
+    return m_base == other.m_base && m_checkSum == other.m_checkSum;
+}
+
+/**
+ * Overloads the comparison operator !=.
+ *
+ * @param other The object to compare with
+ * @return \p true if the objects are not equal, \p false if they are equal
+ */
+inline bool LEI::operator!=(const LEI& other) const {
+    return !(*this == other);
+}
+
+/**
+ * Overrides the stream operator << for LEI.
+ *
+ * @param stream The stream to write to
+ * @param elem The element to write to the stream
+ * @return The stream written to
+ */
+inline std::ostream& operator<<(std::ostream& stream, const LEI& elem) {
+    stream << "LEI (" << elem.toString() << ")";
+    return stream;
+}
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_LEI_H
@@ -32,12 +32,20 @@
  * classes and functions of the library.
  */
 
+#include <atomic>
 #include <iostream>
 #include "libiban.h"
+#include "registry.h"
 #include "utils.h"
+#include "validator.h"
+#include "national.h"
+#include "threadpool.h"
 
 namespace IBAN {
 
+    /// Number of IBANs per chunk of the batch functions running on a pool
+    static const size_t batchGrain = 4096;
+
     /**
      * Constructor of \p IBANParseException.
      *
@@ -89,31 +97,44 @@ namespace IBAN {
         return m_message.c_str();
     }
 
-    // initialize country code map
+    /// Expands a registry entry to an element of \p m_countryCodes
+    #define LIBIBAN_COUNTRY_ENTRY(code, length, format) {#code, length},
+
+    // initialize country code map from the registry
     const map_t IBAN::m_countryCodes = {
-        {"AL", 28}, {"AD", 24}, {"AT", 20}, {"AZ", 28}, {"BE", 16},
-        {"BH", 22}, {"BA", 20}, {"BR", 29}, {"BG", 22}, {"CR", 22},
-        {"HR", 21}, {"CY", 28}, {"CZ", 24}, {"DK", 18}, {"DO", 28},
-        {"EE", 20}, {"FO", 18}, {"FI", 18}, {"FR", 27}, {"GE", 22},
-        {"DE", 22}, {"GI", 23}, {"GR", 27}, {"GL", 18}, {"GT", 28},
-        {"HU", 28}, {"IS", 26}, {"IE", 22}, {"IL", 23}, {"IT", 27},
-        {"KZ", 20}, {"KW", 30}, {"LV", 21}, {"LB", 28}, {"LI", 21},
-        {"LT", 20}, {"LU", 20}, {"MK", 19}, {"MT", 31}, {"MR", 27},
-        {"MU", 30}, {"MC", 27}, {"MD", 24}, {"ME", 22}, {"NL", 18},
-        {"NO", 15}, {"PK", 24}, {"PS", 29}, {"PL", 28}, {"PT", 25},
-        {"RO", 24}, {"SM", 27}, {"SA", 24}, {"RS", 22}, {"SK", 24},
-        {"SI", 19}, {"ES", 24}, {"SE", 24}, {"CH", 21}, {"TN", 24},
-        {"TR", 26}, {"AE", 23}, {"GB", 22}, {"VG", 24}, {"BJ", 28},
-        {"BF", 28}, {"BI", 16}, {"CM", 27}, {"CV", 25}, {"TL", 23},
-        {"IR", 26}, {"CI", 28}, {"JO", 30}, {"SA", 24}, {"MG", 27},
-        {"ML", 28}, {"MZ", 25}, {"QA", 29}, {"XK", 20}, {"SN", 28},
-        {"LC", 32}, {"ST", 25}, {"UA", 29}, {"SC", 31}, {"IQ", 23},
-        {"BY", 28}, {"SV", 28}, {"AO", 25}, {"CF", 27}, {"CG", 27},
-        {"EG", 27}, {"DJ", 27}, {"DZ", 24}, {"GA", 27}, {"GQ", 27},
-        {"GW", 25}, {"MA", 28}, {"NE", 28}, {"TD", 27}, {"TG", 28},
-        {"KM", 27}, {"HN", 28}, {"NI", 32},
+        LIBIBAN_COUNTRIES(LIBIBAN_COUNTRY_ENTRY)
     };
 
+    #undef LIBIBAN_COUNTRY_ENTRY
+
+    /**
+     * Checks whether an IBAN in machine form (upper case) is structurally
+     * valid: the country code must be known, the checksum must consist of
+     * digits and the BBAN must match the length and format of the country.
+     *
+     * @param data Pointer to the first character of the IBAN
+     * @param length The number of characters
+     * @return \p true if the structure is valid, \p false otherwise
+     */
+    static bool isStructureValid(const char* data, size_t length) {
+        if (length < 5 || getCharValue(data[2]) < 0 ||
+            getCharValue(data[2]) >= 10 || getCharValue(data[3]) < 0 ||
+            getCharValue(data[3]) >= 10) {
+            return false;
+        }
+        if (IBAN::getLengthForCountry(data[0], data[1]) != length) {
+            return false;
+        }
+        const char* format = lookupCountryFormat(data[0], data[1]);
+        for (size_t i = 4; i < length; i++) {
+            if (!matchesFormatClass(getFormatClass(format, i - 4),
+                                    getCharValue(data[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /**
      * Tries to create a new instance of \p IBAN from a string parameter. If
      * parsing fails, the methods throws an \p IBANParseException. This happens
@@ -215,24 +236,191 @@ namespace IBAN {
     /**
      * Validates the underlying object according to the IBAN format
      * specification and returns a boolean value indicating validation status.
+     * Optionally, the national check digits of the BBAN are checked as well
+     * for countries with a registered national check (see
+     * \p registerNationalCheck()). National checks that cannot be carried
+     * out (\p NationalCheckResult::Unsupported) do not fail the validation;
+     * \p checkNationalBatch() reports them.
      *
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
      * @return \p true if IBAN is valid, \p false otherwise
      */
-    bool IBAN::validate() const {
-        // invalid country code
-        if (m_countryCodes.find(m_countryCode) == m_countryCodes.end()) {
+    bool IBAN::validate(bool checkNational) const {
+        char compact[34];
+        size_t length = m_countryCode.length() + m_checkSum.length() +
+                        m_bban.length();
+        if (length > sizeof(compact)) {
             return false;
         }
-        size_t expectedLength = m_countryCodes.find(m_countryCode)->second;
+        std::copy(m_countryCode.begin(), m_countryCode.end(), compact);
+        std::copy(m_checkSum.begin(), m_checkSum.end(),
+                  compact + m_countryCode.length());
+        std::copy(m_bban.begin(), m_bban.end(),
+                  compact + m_countryCode.length() + m_checkSum.length());
+        return validateMachineForm(compact, length) && (!checkNational ||
+               checkNationalDigits(compact, length) != NationalCheckResult::Invalid);
+    }
 
-        // concat string and check length
-        std::string checkString = m_bban + m_countryCode + m_checkSum;
-        if (checkString.length() != expectedLength) {
-            return false;
+    /**
+     * Validates an IBAN given as a character sequence without creating an
+     * instance of \p IBAN and without allocating memory. Whitespace is ignored
+     * and letters may be in either case, so both the machine form and the
+     * human readable form are accepted. The result is the same as calling
+     * \p createFromString() followed by \p validate(), except that malformed
+     * input yields \p false instead of an exception.
+     *
+     * @param data Pointer to the first character of the IBAN
+     * @param length The number of characters
+     * @return \p true if the sequence is a valid IBAN, \p false otherwise
+     */
+    bool IBAN::validateString(const char* data, size_t length) {
+        char compact[34];
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (std::isspace(static_cast<unsigned char>(data[i]))) {
+                continue;
+            }
+            if (count == sizeof(compact)) {
+                return false;
+            }
+            compact[count++] = data[i];
         }
+        return validateMachineForm(compact, count);
+    }
 
-        std::string numeric = makeNumerical(checkString);
-        return getReminderForIBANString(numeric) == 1;
+    /**
+     * Validates many IBANs in machine form without allocating memory. The
+     * IBANs are stored back to back with \p ibanLength characters each, so
+     * the batch usually holds IBANs of a single country.
+     *
+     * @param ibans Pointer to the first IBAN
+     * @param ibanLength The length of each IBAN
+     * @param count The number of IBANs
+     * @param results Output array receiving \p count results
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false); IBANs whose national check is unsupported
+     *        count as valid (see \p checkNationalBatch())
+     * @return The number of valid IBANs
+     */
+    size_t IBAN::validateBatch(const char* ibans, size_t ibanLength,
+                               size_t count, bool* results,
+                               bool checkNational) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++) {
+            const char* iban = ibans + i * ibanLength;
+            results[i] = validateMachineForm(iban, ibanLength) &&
+                         (!checkNational || checkNationalDigits(iban, ibanLength) !=
+                                            NationalCheckResult::Invalid);
+            if (results[i]) {
+                valid++;
+            }
+        }
+        return valid;
+    }
+
+    /**
+     * Validates many IBANs in machine form (see \p validateBatch()) on the
+     * threads of a pool. Chunks with many invalid IBANs finish early, which
+     * the work stealing of the pool evens out.
+     *
+     * @param ibans Pointer to the first IBAN
+     * @param ibanLength The length of each IBAN
+     * @param count The number of IBANs
+     * @param results Output array receiving \p count results
+     * @param pool The thread pool
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
+     * @return The number of valid IBANs
+     */
+    size_t IBAN::validateBatch(const char* ibans, size_t ibanLength,
+                               size_t count, bool* results, ThreadPool& pool,
+                               bool checkNational) {
+        std::atomic<size_t> valid(0);
+        pool.parallelFor(count, batchGrain, [&](size_t begin, size_t end) {
+            valid += validateBatch(ibans + begin * ibanLength, ibanLength,
+                                   end - begin, results + begin, checkNational);
+        });
+        return valid.load();
+    }
+
+    /**
+     * Validates many IBANs in machine form (see \p validateBatch()) including
+     * their national check digits and reports the outcome of each IBAN, so
+     * that IBANs whose national check digits cannot be checked are told
+     * apart from verified ones. An IBAN failing the generic validation
+     * yields \p NationalCheckResult::Invalid, otherwise the result of
+     * \p checkNationalDigits().
+     *
+     * @param ibans Pointer to the first IBAN
+     * @param ibanLength The length of each IBAN
+     * @param count The number of IBANs
+     * @param results Output array receiving \p count results
+     * @return The number of IBANs with \p NationalCheckResult::Valid
+     */
+    size_t IBAN::checkNationalBatch(const char* ibans, size_t ibanLength,
+                                    size_t count, NationalCheckResult* results) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++) {
+            const char* iban = ibans + i * ibanLength;
+            results[i] = validateMachineForm(iban, ibanLength) ?
+                         checkNationalDigits(iban, ibanLength) :
+                         NationalCheckResult::Invalid;
+            if (results[i] == NationalCheckResult::Valid) {
+                valid++;
+            }
+        }
+        return valid;
+    }
+
+    /**
+     * Checks many IBANs in machine form (see \p checkNationalBatch()) on the
+     * threads of a pool.
+     *
+     * @param ibans Pointer to the first IBAN
+     * @param ibanLength The length of each IBAN
+     * @param count The number of IBANs
+     * @param results Output array receiving \p count results
+     * @param pool The thread pool
+     * @return The number of IBANs with \p NationalCheckResult::Valid
+     */
+    size_t IBAN::checkNationalBatch(const char* ibans, size_t ibanLength,
+                                    size_t count, NationalCheckResult* results,
+                                    ThreadPool& pool) {
+        std::atomic<size_t> valid(0);
+        pool.parallelFor(count, batchGrain, [&](size_t begin, size_t end) {
+            valid += checkNationalBatch(ibans + begin * ibanLength, ibanLength,
+                                        end - begin, results + begin);
+        });
+        return valid.load();
+    }
+
+    /**
+     * Returns the IBAN length required for a country without a map lookup.
+     * The lengths are kept in a table indexed by the two letters of the
+     * country code which is built from \p m_countryCodes on first use.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return The required IBAN length or 0 if the country is unknown
+     */
+    size_t IBAN::getLengthForCountry(char first, char second) {
+        static const std::vector<unsigned char> lengths = [] {
+            std::vector<unsigned char> table(26 * 26, 0);
+            for (const auto& entry : m_countryCodes) {
+                size_t index = static_cast<size_t>(entry.first[0] - 'A') * 26 +
+                               static_cast<size_t>(entry.first[1] - 'A');
+                table[index] = static_cast<unsigned char>(entry.second);
+            }
+            return table;
+        }();
+
+        int a = getCharValue(first) - 10;
+        int b = getCharValue(second) - 10;
+        if (a < 0 || b < 0) {
+            return 0;
+        }
+        return lengths[static_cast<size_t>(a * 26 + b)];
     }
 
     /**
@@ -256,18 +444,370 @@ namespace IBAN {
         }
         size_t ibanSize = m_countryCodes.find(countryCode)->second;
 
-        // generate string and append country code and '00' (initial checksum)
+        // generate a random alphanumerical string and fit it to the BBAN
+        // format of the country
         std::string ibanString = generateRandomString(ibanSize - 4);
+        const char* format = lookupCountryFormat(countryCode[0], countryCode[1]);
+        for (size_t i = 0; i < ibanString.length(); i++) {
+            int value = getCharValue(ibanString[i]);
+            switch (getFormatClass(format, i)) {
+                case 'n':
+                    ibanString[i] = static_cast<char>('0' + value % 10);
+                    break;
+                case 'a':
+                    ibanString[i] = static_cast<char>('A' + value % 26);
+                    break;
+                default:
+                    ibanString[i] = static_cast<char>(::toupper(ibanString[i]));
+            }
+        }
+        return IBAN(countryCode, ibanString,
+                    computeCheckDigits(countryCode, ibanString));
+    }
+
+    /**
+     * Computes the check digits of an IBAN from a country code and a BBAN.
+     * Throws an \p IBANInvalidCountryCodeException if the country code is
+     * unknown and an \p IBANParseException if the BBAN contains characters
+     * that are not alphanumerical.
+     *
+     * @param countryCode The country code of the IBAN
+     * @param bban The Basic Bank Account Number
+     * @return The two check digits
+     */
+    std::string IBAN::computeCheckDigits(const std::string& countryCode,
+                                         const std::string& bban) {
+        if (m_countryCodes.find(countryCode) == m_countryCodes.end()) {
+            throw IBANInvalidCountryCodeException(countryCode);
+        }
+        long checkDigits = getCheckDigits(countryCode.data(), bban.data(),
+                                          bban.length());
+        if (checkDigits < 0) {
+            throw IBANParseException(countryCode + "??" + bban);
+        }
+        return std::string{static_cast<char>('0' + checkDigits / 10),
+                           static_cast<char>('0' + checkDigits % 10)};
+    }
+
+    /**
+     * Computes the check digits for many BBANs of the same country at once,
+     * for example when converting legacy account numbers in bulk. The BBANs
+     * are stored back to back with a fixed length in \p bbans and two check
+     * digits per BBAN are written to \p checkDigits. No memory is allocated,
+     * so the function is limited by memory bandwidth.
+     *
+     * BBANs containing characters that are not alphanumerical get the check
+     * digits "00", which never occur in a valid IBAN. Throws an
+     * \p IBANInvalidCountryCodeException if the country code is unknown.
+     *
+     * @param countryCode The country code of all IBANs
+     * @param bbans The BBANs stored back to back
+     * @param bbanLength The length of each BBAN
+     * @param count The number of BBANs
+     * @param checkDigits Output array of 2 * \p count characters
+     * @return The number of BBANs that contained invalid characters
+     */
+    size_t IBAN::computeCheckDigits(const std::string& countryCode,
+                                    const char* bbans, size_t bbanLength,
+                                    size_t count, char* checkDigits) {
+        if (m_countryCodes.find(countryCode) == m_countryCodes.end()) {
+            throw IBANInvalidCountryCodeException(countryCode);
+        }
+        size_t invalid = 0;
+        for (size_t i = 0; i < count; i++) {
+            long digits = getCheckDigits(countryCode.data(), bbans + i * bbanLength,
+                                         bbanLength);
+            if (digits < 0) {
+                digits = 0;
+                invalid++;
+            }
+            checkDigits[2 * i] = static_cast<char>('0' + digits / 10);
+            checkDigits[2 * i + 1] = static_cast<char>('0' + digits % 10);
+        }
+        return invalid;
+    }
+
+    /**
+     * Computes the check digits for many BBANs of the same country (see
+     * \p computeCheckDigits()) on the threads of a pool. Throws an
+     * \p IBANInvalidCountryCodeException if the country code is unknown.
+     *
+     * @param countryCode The country code of all IBANs
+     * @param bbans The BBANs stored back to back
+     * @param bbanLength The length of each BBAN
+     * @param count The number of BBANs
+     * @param checkDigits Output array of 2 * \p count characters
+     * @param pool The thread pool
+     * @return The number of BBANs that contained invalid characters
+     */
+    size_t IBAN::computeCheckDigits(const std::string& countryCode,
+                                    const char* bbans, size_t bbanLength,
+                                    size_t count, char* checkDigits,
+                                    ThreadPool& pool) {
+        if (m_countryCodes.find(countryCode) == m_countryCodes.end()) {
+            throw IBANInvalidCountryCodeException(countryCode);
+        }
+        std::atomic<size_t> invalid(0);
+        pool.parallelFor(count, batchGrain, [&](size_t begin, size_t end) {
+            invalid += computeCheckDigits(countryCode, bbans + begin * bbanLength,
+                                          bbanLength, end - begin,
+                                          checkDigits + 2 * begin);
+        });
+        return invalid.load();
+    }
+
+    /**
+     * Returns a copy of this IBAN whose checksum is recomputed from the
+     * country code and the BBAN. This repairs IBANs with wrong check digits
+     * and completes IBANs created with placeholder check digits. Throws an
+     * \p IBANInvalidCountryCodeException if the country code is unknown.
+     *
+     * @return A copy of the IBAN with a correct checksum
+     */
+    IBAN IBAN::withCorrectChecksum() const {
+        return IBAN(m_countryCode, m_bban,
+                    computeCheckDigits(m_countryCode, m_bban));
+    }
 
-        std::string numeric = makeNumerical(ibanString + countryCode + "00");
-        auto checksum = std::to_string(98 - getReminderForIBANString(numeric));
+    /**
+     * Returns all structurally valid IBANs with a correct checksum that can be
+     * obtained from \p iban by substituting a single character or by swapping
+     * two adjacent characters. This is useful for suggesting corrections of
+     * mistyped IBANs; the given IBAN itself is never part of the result.
+     *
+     * As the MOD 97 remainder is linear in the digits of the numerical form,
+     * the remainders of everything left and right of each position are
+     * precomputed once. The remainder of every candidate is then derived in
+     * constant time instead of validating each candidate string.
+     *
+     * @param iban The (possibly invalid) IBAN to find corrections for
+     * @return All candidates within one edit, in order of their position
+     */
+    std::vector<IBAN> IBAN::suggestCorrections(const IBAN& iban) {
+        std::vector<IBAN> result;
+        std::string machine = iban.getMachineForm();
+        std::transform(machine.begin(), machine.end(), machine.begin(),
+                       ::toupper);
+        const size_t n = machine.length();
+        if (n < 5 || n > 34) {
+            return result;
+        }
 
-        // pad checksum
-        while (checksum.length() < 2) {
-            checksum = "0" + checksum;
+        // the rearranged form (BBAN, country code, checksum) and the index
+        // of every character of the machine form inside it
+        int values[34];
+        size_t index[34];
+        for (size_t k = 0; k < n; k++) {
+            index[k] = (k + n - 4) % n;
+            values[index[k]] = getCharValue(machine[k]);
+            if (values[index[k]] < 0) {
+                return result;
+            }
+        }
+
+        // remainders and digit counts of all prefixes and suffixes
+        unsigned prefix[35], suffix[35];
+        size_t digits[35];
+        prefix[0] = 0;
+        digits[0] = 0;
+        for (size_t j = 0; j < n; j++) {
+            prefix[j + 1] = foldRemainder(prefix[j], values[j]);
+            digits[j + 1] = digits[j] + getDigitCount(values[j]);
+        }
+        suffix[n] = 0;
+        for (size_t j = n; j-- > 0;) {
+            suffix[j] = (static_cast<unsigned>(values[j]) *
+                         getPowerOfTen(digits[n] - digits[j + 1]) +
+                         suffix[j + 1]) % 97;
         }
 
-        IBAN iban = createFromString(countryCode + checksum + ibanString);
-        return iban;
+        // remainder of the rearranged form with the characters at positions
+        // a < b replaced by the values va and vb (b == n: only a is replaced)
+        auto remainderWith = [&](size_t a, int va, size_t b, int vb) {
+            unsigned rem = foldRemainder(prefix[a], va);
+            if (b == n) {
+                return (rem * getPowerOfTen(digits[n] - digits[a + 1]) +
+                        suffix[a + 1]) % 97;
+            }
+            size_t middleDigits = digits[b] - digits[a + 1];
+            unsigned middle = (prefix[b] + 97 - prefix[a + 1] *
+                               getPowerOfTen(middleDigits) % 97) % 97;
+            rem = (rem * getPowerOfTen(middleDigits) + middle) % 97;
+            rem = foldRemainder(rem, vb);
+            return (rem * getPowerOfTen(digits[n] - digits[b + 1]) +
+                    suffix[b + 1]) % 97;
+        };
+
+        static const std::string alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        auto accept = [&](const std::string& candidate) {
+            if (isStructureValid(candidate.data(), candidate.length())) {
+                result.push_back(IBAN(candidate.substr(0, 2),
+                                      candidate.substr(4),
+                                      candidate.substr(2, 2)));
+            }
+        };
+
+        // single substitutions; the country code only takes letters and
+        // the checksum only digits
+        for (size_t k = 0; k < n; k++) {
+            size_t first = k < 2 ? 10 : 0, last = (k >= 2 && k < 4) ? 10 : 36;
+            for (size_t v = first; v < last; v++) {
+                int value = static_cast<int>(v);
+                if (value == values[index[k]] ||
+                    remainderWith(index[k], value, n, 0) != 1) {
+                    continue;
+                }
+                std::string candidate = machine;
+                candidate[k] = alphabet[v];
+                accept(candidate);
+            }
+        }
+
+        // transpositions of adjacent characters
+        for (size_t k = 0; k + 1 < n; k++) {
+            if (machine[k] == machine[k + 1]) {
+                continue;
+            }
+            size_t a = index[k], b = index[k + 1];
+            int va = values[index[k + 1]], vb = values[index[k]];
+            if (a > b) {
+                std::swap(a, b);
+                std::swap(va, vb);
+            }
+            if (remainderWith(a, va, b, vb) != 1) {
+                continue;
+            }
+            std::string candidate = machine;
+            std::swap(candidate[k], candidate[k + 1]);
+            accept(candidate);
+        }
+        return result;
+    }
+
+    /**
+     * Enumerates all structurally valid IBANs with a correct checksum that
+     * match a pattern in which unknown characters are replaced by '?', for
+     * example "DE89 3704 00?4 4053 2?13 00". Whitespace is ignored. Every
+     * completion is passed to \p callback as soon as it is found. Throws an
+     * \p IBANParseException if the pattern is malformed.
+     *
+     * Instead of validating every possible fill, the unknown positions are
+     * split into two halves (meet in the middle). The remainders of all fills
+     * of the left half are grouped by value; for each fill of the right half
+     * the required remainder of the left half is computed from the linearity
+     * of MOD 97, so only matching combinations are visited.
+     *
+     * @param pattern The IBAN pattern with '?' for unknown characters
+     * @param callback Function called for every completion
+     * @return The number of completions
+     */
+    size_t IBAN::enumerateCompletions(const std::string& pattern,
+            const std::function<void(const IBAN&)>& callback) {
+        std::string s = pattern;
+        trim(s);
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        const size_t n = s.length();
+        if (n < 5 || n > 34) {
+            throw IBANParseException(pattern);
+        }
+
+        // positions of the wildcards in the rearranged form, in order
+        std::vector<size_t> wildcards;
+        std::vector<size_t> original(n);
+        for (size_t k = 0; k < n; k++) {
+            size_t j = (k + n - 4) % n;
+            original[j] = k;
+            if (s[k] != '?' && getCharValue(s[k]) < 0) {
+                throw IBANParseException(pattern);
+            }
+        }
+        for (size_t j = 0; j < n; j++) {
+            if (s[original[j]] == '?') {
+                wildcards.push_back(j);
+            }
+        }
+        const size_t m = wildcards.size(), half = m / 2;
+
+        // remainder and digit count of the fixed characters in [from, to)
+        struct Segment { unsigned remainder; size_t digits; };
+        auto segment = [&](size_t from, size_t to) {
+            Segment seg {0, 0};
+            for (size_t j = from; j < to; j++) {
+                int value = getCharValue(s[original[j]]);
+                seg.remainder = foldRemainder(seg.remainder, value);
+                seg.digits += getDigitCount(value);
+            }
+            return seg;
+        };
+        std::vector<Segment> after(m);
+        for (size_t i = 0; i < m; i++) {
+            after[i] = segment(wildcards[i] + 1, i + 1 < m ? wildcards[i + 1] : n);
+        }
+
+        // characters allowed at an original position
+        auto range = [](size_t k, int& first, int& last) {
+            first = k < 2 ? 10 : 0;
+            last = (k >= 2 && k < 4) ? 10 : 36;
+        };
+        static const std::string alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+        // enumerate the left half and group the fills by remainder
+        std::vector<std::vector<std::string>> buckets(97);
+        std::string fill(m, '0');
+        std::function<void(size_t, unsigned)> left = [&](size_t i, unsigned rem) {
+            if (i == half) {
+                buckets[rem].push_back(fill.substr(0, half));
+                return;
+            }
+            int first, last;
+            range(original[wildcards[i]], first, last);
+            for (int value = first; value < last; value++) {
+                fill[i] = alphabet[static_cast<size_t>(value)];
+                unsigned next = foldRemainder(rem, value);
+                next = (next * getPowerOfTen(after[i].digits) +
+                        after[i].remainder) % 97;
+                left(i + 1, next);
+            }
+        };
+        left(0, segment(0, m > 0 ? wildcards[0] : n).remainder);
+
+        // enumerate the right half and combine it with matching left fills
+        size_t count = 0;
+        std::string candidate = s;
+        auto emit = [&](const std::string& leftFill) {
+            for (size_t i = 0; i < m; i++) {
+                candidate[original[wildcards[i]]] =
+                        i < half ? leftFill[i] : fill[i];
+            }
+            if (isStructureValid(candidate.data(), n)) {
+                count++;
+                callback(IBAN(candidate.substr(0, 2), candidate.substr(4),
+                              candidate.substr(2, 2)));
+            }
+        };
+        std::function<void(size_t, unsigned, size_t)> right =
+                [&](size_t i, unsigned rem, size_t digits) {
+            if (i == m) {
+                // A * 10^digits + B == 1  =>  A == (1 - B) * 10^-digits
+                unsigned required = (1 + 97 - rem) *
+                                    getPowerOfTen(96 - digits % 96) % 97;
+                for (const auto& leftFill : buckets[required]) {
+                    emit(leftFill);
+                }
+                return;
+            }
+            int first, last;
+            range(original[wildcards[i]], first, last);
+            for (int value = first; value < last; value++) {
+                fill[i] = alphabet[static_cast<size_t>(value)];
+                unsigned next = foldRemainder(rem, value);
+                next = (next * getPowerOfTen(after[i].digits) +
+                        after[i].remainder) % 97;
+                right(i + 1, next, digits + getDigitCount(value) +
+                                   after[i].digits);
+            }
+        };
+        right(half, 0, 0);
+        return count;
     }
 }
@@ -40,9 +40,14 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <memory>
+#include <functional>
+#include <vector>
 
 namespace IBAN {
 
+class ThreadPool;
+enum class NationalCheckResult : unsigned char;
+
 /// Used as a shortcut for the country codes map type
 typedef std::unordered_map<std::string, size_t> map_t;
 
@@ -99,6 +104,8 @@ private:
                                   m_bban(bban),
                                   m_checkSum(checkSum) {}
 
+    friend class IBANLiteral;
+
 public:
     /// Copy constructor for \p IBAN. Uses the default copy constructor
     IBAN(const IBAN&)=default;
@@ -114,7 +121,33 @@ public:
     std::string getChecksum() const;
     std::string getHumanReadable() const;
     std::string getMachineForm() const;
-    bool validate() const;
+    bool validate(bool checkNational = false) const;
+    static bool validateString(const char* data, size_t length);
+    static size_t validateBatch(const char* ibans, size_t ibanLength,
+                                size_t count, bool* results,
+                                bool checkNational = false);
+    static size_t validateBatch(const char* ibans, size_t ibanLength,
+                                size_t count, bool* results, ThreadPool& pool,
+                                bool checkNational = false);
+    static size_t checkNationalBatch(const char* ibans, size_t ibanLength,
+                                     size_t count, NationalCheckResult* results);
+    static size_t checkNationalBatch(const char* ibans, size_t ibanLength,
+                                     size_t count, NationalCheckResult* results,
+                                     ThreadPool& pool);
+    static size_t getLengthForCountry(char first, char second);
+    static std::vector<IBAN> suggestCorrections(const IBAN& iban);
+    static std::string computeCheckDigits(const std::string& countryCode,
+                                          const std::string& bban);
+    static size_t computeCheckDigits(const std::string& countryCode,
+                                     const char* bbans, size_t bbanLength,
+                                     size_t count, char* checkDigits);
+    static size_t computeCheckDigits(const std::string& countryCode,
+                                     const char* bbans, size_t bbanLength,
+                                     size_t count, char* checkDigits,
+                                     ThreadPool& pool);
+    IBAN withCorrectChecksum() const;
+    static size_t enumerateCompletions(const std::string& pattern,
+            const std::function<void(const IBAN&)>& callback);
 
     /// Static map mapping country codes to required IBAN length; must be
     /// initialized in a source file.
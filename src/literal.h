@@ -0,0 +1,375 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        literal.h
+ * \brief       Header file declaring compile-time IBAN literals
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares functions for validating IBANs in constant
+ * expressions, the macro \p IBAN_LITERAL and, from C++14 on with GCC and
+ * Clang or from C++20 on, the user-defined literal \p _iban. Both validate
+ * the IBAN at compile time in every context, so a malformed or invalid IBAN
+ * fails to compile.
+ */
+
+#ifndef LIBIBAN_LITERAL_H
+#define LIBIBAN_LITERAL_H
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "libiban.h"
+#include "registry.h"
+
+namespace IBAN {
+
+/**
+ * Returns the value of an alphanumerical character for MOD 97-10 in a
+ * constant expression.
+ *
+ * @param ch The character to convert
+ * @return The value of \p ch or -1 if it is not alphanumerical
+ */
+constexpr int getLiteralCharValue(char ch) {
+    return (ch >= '0' && ch <= '9') ? ch - '0' :
+           (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 10 :
+           (ch >= 'a' && ch <= 'z') ? ch - 'a' + 10 : -1;
+}
+
+/**
+ * Returns the number of characters of a literal that are not spaces.
+ *
+ * @param data Pointer to the literal
+ * @param length The length of the literal
+ * @return The number of characters that are not spaces
+ */
+constexpr size_t getLiteralLength(const char* data, size_t length) {
+    return length == 0 ? 0 :
+           (data[0] == ' ' ? 0 : 1) + getLiteralLength(data + 1, length - 1);
+}
+
+/**
+ * Returns the character at a position of a literal, not counting spaces.
+ *
+ * @param data Pointer to the literal
+ * @param length The length of the literal
+ * @param index The position of the character without spaces
+ * @return The character at \p index
+ */
+constexpr char getLiteralChar(const char* data, size_t length, size_t index) {
+    return data[0] == ' ' ? getLiteralChar(data + 1, length - 1, index) :
+           index == 0 ? data[0] :
+           getLiteralChar(data + 1, length - 1, index - 1);
+}
+
+/**
+ * Converts a letter of a literal to upper case in a constant expression.
+ *
+ * @param ch The letter
+ * @return The upper case letter
+ */
+constexpr char toLiteralUpper(char ch) {
+    return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch;
+}
+
+/**
+ * Checks the characters of a literal from position \p index on: letters for
+ * the country code, digits for the checksum and the BBAN format of the
+ * country for the BBAN.
+ *
+ * @param data Pointer to the literal
+ * @param length The length of the literal
+ * @param index The position to start at, not counting spaces
+ * @param count The number of characters without spaces
+ * @return \p true if all characters are allowed at their position
+ */
+constexpr bool isLiteralStructureValid(const char* data, size_t length,
+                                       size_t index, size_t count) {
+    return index == count ? true :
+           (index < 2 ? getLiteralCharValue(getLiteralChar(data, length, index)) >= 10 :
+            index < 4 ? (getLiteralCharValue(getLiteralChar(data, length, index)) >= 0 &&
+                         getLiteralCharValue(getLiteralChar(data, length, index)) < 10) :
+            matchesFormatClass(getFormatClass(lookupCountryFormat(
+                                       toLiteralUpper(getLiteralChar(data, length, 0)),
+                                       toLiteralUpper(getLiteralChar(data, length, 1))),
+                                   index - 4),
+                               getLiteralCharValue(getLiteralChar(data, length, index)))) &&
+           isLiteralStructureValid(data, length, index + 1, count);
+}
+
+/**
+ * Calculates the MOD 97 remainder of a literal IBAN in rearranged order
+ * (BBAN, country code, checksum) in a constant expression.
+ *
+ * @param data Pointer to the literal
+ * @param length The length of the literal
+ * @param step The number of rearranged characters already processed
+ * @param count The number of characters without spaces
+ * @param remainder The remainder of the characters already processed
+ * @return The remainder of the whole IBAN
+ */
+constexpr unsigned getLiteralRemainder(const char* data, size_t length,
+                                       size_t step, size_t count,
+                                       unsigned remainder) {
+    return step == count ? remainder :
+           getLiteralRemainder(data, length, step + 1, count,
+               ((getLiteralCharValue(getLiteralChar(data, length, (step + 4) % count)) < 10 ?
+                    remainder * 10 : remainder * 100) +
+                static_cast<unsigned>(getLiteralCharValue(
+                    getLiteralChar(data, length, (step + 4) % count)))) % 97);
+}
+
+/**
+ * Validates an IBAN in a constant expression. Spaces are ignored, so the
+ * human readable form is accepted, and letters may be in either case.
+ *
+ * @param data Pointer to the IBAN
+ * @param length The length of the IBAN
+ * @return \p true if the IBAN is valid, \p false otherwise
+ */
+constexpr bool validateLiteral(const char* data, size_t length) {
+    return getLiteralLength(data, length) >= 5 &&
+           getLiteralLength(data, length) <= 34 &&
+           isLiteralStructureValid(data, length, 0, getLiteralLength(data, length)) &&
+           lookupCountryLength(toLiteralUpper(getLiteralChar(data, length, 0)),
+                               toLiteralUpper(getLiteralChar(data, length, 1))) ==
+                   getLiteralLength(data, length) &&
+           getLiteralRemainder(data, length, 0, getLiteralLength(data, length), 0) == 1;
+}
+
+/// Sequence of indices used to unpack literals
+template <size_t... indices>
+struct LiteralIndices {};
+
+/// Creates the sequence of indices from 0 to \p count - 1
+template <size_t count, size_t... indices>
+struct MakeLiteralIndices : MakeLiteralIndices<count - 1, count - 1, indices...> {};
+
+/// End of the recursion of \p MakeLiteralIndices
+template <size_t... indices>
+struct MakeLiteralIndices<0, indices...> {
+    typedef LiteralIndices<indices...> type;
+};
+
+/// Proof that a literal was validated at compile time; instantiating it with
+/// \p false fails to compile
+template <bool valid>
+struct LiteralCheck {
+    static_assert(valid, "invalid IBAN literal");
+};
+
+/// An IBAN validated at compile time and stored in machine form; created by
+/// \p IBAN_LITERAL or the literal \p _iban
+class IBANLiteral {
+
+private:
+    /// The IBAN in machine form, followed by a null character
+    char m_machine[35];
+    /// Length of the IBAN
+    size_t m_length;
+
+    /**
+     * Copies the characters of a literal into the machine form.
+     *
+     * @param data Pointer to the literal
+     * @param size The length of the literal including spaces
+     * @param length The length of the IBAN without spaces
+     */
+    template <size_t... indices>
+    constexpr IBANLiteral(const char* data, size_t size, size_t length,
+                          LiteralIndices<indices...>) :
+            m_machine{(indices < length ? toLiteralUpper(getLiteralChar(data, size, indices))
+                                        : '\0')...},
+            m_length(length) {}
+
+public:
+    /**
+     * Creates an \p IBANLiteral from a string literal. Only a
+     * \p LiteralCheck<true> can be passed, so the literal must have been
+     * validated in a constant expression; use \p IBAN_LITERAL instead of
+     * calling it directly. The literal is validated again, so a forged check
+     * fails to compile in a constant expression and throws a
+     * \p std::invalid_argument otherwise.
+     *
+     * @param literal The string literal
+     * @return The IBAN literal
+     */
+    template <size_t size>
+    static constexpr IBANLiteral create(const char (&literal)[size], LiteralCheck<true>) {
+        return validateLiteral(literal, size - 1) ?
+               IBANLiteral(literal, size - 1, getLiteralLength(literal, size - 1),
+                           MakeLiteralIndices<35>::type()) :
+               throw std::invalid_argument("invalid IBAN literal");
+    }
+
+    /**
+     * Returns the length of the IBAN without spaces.
+     *
+     * @return The length of the IBAN
+     */
+    constexpr size_t length() const {
+        return m_length;
+    }
+
+    /**
+     * Returns a character of the IBAN in machine form.
+     *
+     * @param index The position of the character
+     * @return The (upper case) character at \p index
+     */
+    constexpr char operator[](size_t index) const {
+        return m_machine[index];
+    }
+
+    /**
+     * Returns the IBAN in machine form.
+     *
+     * @return Null-terminated machine form of the IBAN
+     */
+    constexpr const char* getMachineForm() const {
+        return m_machine;
+    }
+
+    /**
+     * Returns the BBAN, the part of the IBAN after the check digits.
+     *
+     * @return Null-terminated BBAN
+     */
+    constexpr const char* getBBAN() const {
+        return m_machine + 4;
+    }
+
+    /**
+     * Returns the check digits of the IBAN as a number.
+     *
+     * @return The check digits
+     */
+    constexpr unsigned getCheckDigits() const {
+        return static_cast<unsigned>(getLiteralCharValue(m_machine[2]) * 10 +
+                                     getLiteralCharValue(m_machine[3]));
+    }
+
+    /**
+     * Converts the literal to an instance of \p IBAN without parsing it
+     * again.
+     *
+     * @return The IBAN
+     */
+    operator IBAN() const {
+        return IBAN(std::string(m_machine, 2), std::string(m_machine + 4, m_length - 4),
+                    std::string(m_machine + 2, 2));
+    }
+
+}; // end of class IBANLiteral
+
+/**
+ * Creates an \p IBANLiteral from a string literal, e.g.
+ * \p IBAN_LITERAL("DE89 3704 0044 0532 0130 00"). The IBAN is validated at
+ * compile time in every context, so an invalid IBAN fails to compile.
+ */
+#define IBAN_LITERAL(literal) \
+    ::IBAN::IBANLiteral::create(literal, \
+        ::IBAN::LiteralCheck< ::IBAN::validateLiteral(literal, sizeof(literal) - 1)>())
+
+/// Namespace of the user-defined literal \p _iban
+namespace literals {
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+
+/// String literal passed to \p _iban as a template argument
+template <size_t size>
+struct LiteralText {
+    /// The characters of the literal including the null character
+    char data[size];
+
+    /**
+     * Constructor of \p LiteralText.
+     *
+     * @param text The string literal
+     */
+    constexpr LiteralText(const char (&text)[size]) : data() {
+        for (size_t i = 0; i < size; i++) {
+            data[i] = text[i];
+        }
+    }
+};
+
+/**
+ * User-defined literal for IBANs, e.g. \p "DE89370400440532013000"_iban.
+ * The literal is a template argument, so invalid IBANs fail to compile in
+ * every context.
+ *
+ * @return The validated IBAN literal
+ */
+template <LiteralText text>
+constexpr IBANLiteral operator""_iban() {
+    return IBANLiteral::create(text.data,
+                               LiteralCheck<validateLiteral(text.data, sizeof(text.data) - 1)>());
+}
+
+#elif defined(__GNUC__) && __cplusplus >= 201402L
+
+/// Characters of a literal passed to \p _iban as template arguments
+template <char... chars>
+struct LiteralString {
+    /// The characters of the literal
+    static constexpr char data[] = {chars..., '\0'};
+};
+
+template <char... chars>
+constexpr char LiteralString<chars...>::data[];
+
+// string literal operator templates are a GNU extension before C++20
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+
+/**
+ * User-defined literal for IBANs, e.g. \p "DE89370400440532013000"_iban.
+ * The characters are template arguments, so invalid IBANs fail to compile
+ * in every context.
+ *
+ * @return The validated IBAN literal
+ */
+template <typename Char, Char... chars>
+constexpr IBANLiteral operator"" _iban() {
+    static_assert(std::is_same<Char, char>::value, "IBAN literals must be narrow strings");
+    return IBANLiteral::create(LiteralString<chars...>::data,
+                               LiteralCheck<validateLiteral(LiteralString<chars...>::data,
+                                                            sizeof...(chars))>());
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+} // end of namespace literals
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_LITERAL_H
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        mappedfile.cpp
+ * \brief       Source file implementing read-only memory mapped files
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p MappedFile with \p mmap().
+ */
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedfile.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p MappedFile. Maps the whole file for sequential
+     * reading. Throws a \p std::runtime_error if the file cannot be opened or
+     * mapped.
+     *
+     * @param path The path of the file
+     */
+    MappedFile::MappedFile(const std::string& path) :
+            m_data(nullptr), m_size(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        m_size = static_cast<size_t>(info.st_size);
+        if (m_size > 0) {
+            void* mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map " + path);
+            }
+            ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(mapping);
+        }
+        // the mapping stays valid after closing the descriptor
+        ::close(fd);
+    }
+
+    /**
+     * Destructor of \p MappedFile. Unmaps the file.
+     */
+    MappedFile::~MappedFile() {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+    /**
+     * Returns a pointer to the contents of the file.
+     *
+     * @return The contents or \p nullptr if the file is empty
+     */
+    const char* MappedFile::data() const {
+        return m_data;
+    }
+
+    /**
+     * Returns the size of the file.
+     *
+     * @return The size in bytes
+     */
+    size_t MappedFile::size() const {
+        return m_size;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        mappedfile.h
+ * \brief       Header file declaring read-only memory mapped files
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a class mapping a file into memory, so large
+ * payment files can be scanned without copying them.
+ */
+
+#ifndef LIBIBAN_MAPPEDFILE_H
+#define LIBIBAN_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace IBAN {
+
+/// Maps a file into memory for reading (POSIX systems)
+class MappedFile {
+
+private:
+    /// Pointer to the mapped contents
+    const char* m_data;
+    /// The size of the file
+    size_t m_size;
+
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&)=delete;
+    MappedFile& operator=(const MappedFile&)=delete;
+    const char* data() const;
+    size_t size() const;
+
+}; // end of class MappedFile
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_MAPPEDFILE_H
@@ -0,0 +1,317 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        mtscanner.cpp
+ * \brief       Source file implementing the SWIFT MT message scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p MTScanner. Messages are read line
+ * by line; fields start with a tag like \p :25: at the beginning of a line
+ * and continue up to the next tag. Messages end with the delimiter \p -} of
+ * their text block, so files with many messages are split at these
+ * delimiters and scanned in parallel.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "mtscanner.h"
+#include "libiban.h"
+#include "mappedfile.h"
+#include "parallel.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /// End of the text block of a message
+    static const char messageEnd[] = "-}";
+
+    /// Maximum length of a run holding an IBAN and a currency
+    static const size_t maxRunLength = 34 + 3;
+
+    /// Returned by \p parseTag() for fields without accounts
+    static const int otherField = -1;
+
+    /**
+     * Parses the tag at the beginning of a line.
+     *
+     * @param line Pointer to the line
+     * @param length The length of the line
+     * @param field Receives the field (an \p MTField or \p otherField)
+     * @return The length of the tag including both colons or 0 if the line
+     *         does not start with a tag
+     */
+    static size_t parseTag(const char* line, size_t length, int& field) {
+        if (length < 4 || line[0] != ':' || getCharValue(line[1]) < 0 ||
+                getCharValue(line[1]) > 9 || getCharValue(line[2]) < 0 ||
+                getCharValue(line[2]) > 9) {
+            return 0;
+        }
+        char option = '\0';
+        size_t tagLength = 3;
+        if (line[3] != ':') {
+            if (length < 5 || line[4] != ':' || getCharValue(line[3]) < 10) {
+                return 0;
+            }
+            option = line[3];
+            tagLength = 4;
+        }
+        int number = (line[1] - '0') * 10 + (line[2] - '0');
+        if (number == 25 && (option == '\0' || option == 'P')) {
+            field = static_cast<int>(MTField::Account);
+        } else if (number == 50 && (option == 'A' || option == 'F' || option == 'K')) {
+            field = static_cast<int>(MTField::OrderingCustomer);
+        } else if (number == 59 && (option == '\0' || option == 'A' || option == 'F')) {
+            field = static_cast<int>(MTField::Beneficiary);
+        } else if (number == 86 && option == '\0') {
+            field = static_cast<int>(MTField::Information);
+        } else {
+            field = otherField;
+        }
+        return tagLength + 1;
+    }
+
+    /**
+     * Constructor of \p MTScanner.
+     *
+     * @param threads Number of threads scanning messages in parallel
+     *        (default: 1); 0 selects the number of hardware threads
+     */
+    MTScanner::MTScanner(unsigned threads) : m_threads(threads), m_pool(nullptr) {
+        if (m_threads == 0) {
+            m_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**
+     * Constructor of \p MTScanner scanning messages on the workers of a
+     * pool. The pool must outlive the scanner and callbacks must not use it.
+     *
+     * @param pool The pool
+     */
+    MTScanner::MTScanner(ThreadPool& pool) :
+            m_threads(static_cast<unsigned>(pool.getThreadCount())), m_pool(&pool) {
+    }
+
+    /**
+     * Scans MT messages for IBANs in the account fields \p :25:, \p :50a:,
+     * \p :59a: and \p :86:. Candidates are runs of alphanumerical characters
+     * with a known country code and the length of its IBANs; subfield
+     * separators of field 86 (such as \p ?31) and a currency code appended
+     * to the IBAN in field 25 are recognized. Every candidate is validated
+     * and passed to \p callback with the index of its message.
+     *
+     * With several threads, files of many messages are split at the message
+     * delimiters \p -} and the parts are scanned in parallel; \p callback is
+     * then called concurrently and must be thread-safe.
+     *
+     * @param data The messages
+     * @param length The length of the data
+     * @param callback Receives the IBANs
+     * @return The number of messages
+     */
+    size_t MTScanner::scan(const char* data, size_t length,
+                           const Callback& callback) const {
+        return scanInParallel(m_pool, m_threads, data, length, messageEnd, true,
+                [&](size_t begin, size_t end, size_t first) {
+                    return scanRange(data, begin, end, first, callback);
+                });
+    }
+
+    /**
+     * Checks whether a run of alphanumerical characters is an IBAN, possibly
+     * followed by a currency in the account field.
+     *
+     * @param run The run
+     * @param length The length of the run
+     * @param field The field containing the run
+     * @return The length of the IBAN or 0 if the run is no IBAN
+     */
+    static size_t matchRun(const char* run, size_t length, int field) {
+        size_t expected = length >= 4 ? IBAN::getLengthForCountry(run[0], run[1]) : 0;
+        if (expected == 0 || getCharValue(run[0]) < 10 || getCharValue(run[1]) < 10 ||
+                getCharValue(run[2]) > 9 || getCharValue(run[3]) > 9) {
+            return 0;
+        }
+        bool currency = field == static_cast<int>(MTField::Account) &&
+                        length == expected + 3 &&
+                        getCharValue(run[length - 1]) >= 10 &&
+                        getCharValue(run[length - 2]) >= 10 &&
+                        getCharValue(run[length - 3]) >= 10;
+        return length == expected || currency ? expected : 0;
+    }
+
+    /**
+     * Scans a part of the data that starts at the beginning of a message.
+     * Lines are limited in length, so an IBAN may wrap into the next line of
+     * its field (e.g. in the subfields of \p :86:); a run of characters that
+     * ends a line is therefore joined with the run starting the next line. If
+     * the joined run is no IBAN, both parts are checked on their own.
+     *
+     * @param data The messages
+     * @param begin The start of the part
+     * @param end The end of the part
+     * @param firstMessage The index of the first message of the part
+     * @param callback Receives the IBANs
+     * @return The number of messages in the part
+     */
+    size_t MTScanner::scanRange(const char* data, size_t begin, size_t end,
+                                size_t firstMessage,
+                                const Callback& callback) const {
+        MTAccount account = {firstMessage, MTField::Account, false, nullptr, 0, 0};
+        size_t messages = 0;
+        bool content = false;
+        int field = otherField;
+
+        // the current run of alphanumerical characters; wrapped runs are
+        // joined in a buffer for at most an IBAN and a currency
+        char run[maxRunLength];
+        size_t runLength = 0;
+        size_t runOffset = 0;
+        size_t headLength = 0;
+        size_t tailOffset = 0;
+        auto report = [&](const char* iban, size_t length, size_t offset) {
+            account.field = static_cast<MTField>(field);
+            account.iban = iban;
+            account.length = length;
+            account.offset = offset;
+            account.valid = IBAN::validateString(iban, length);
+            if (callback) {
+                callback(account);
+            }
+        };
+        auto finishRun = [&]() {
+            if (headLength == 0) {
+                size_t length = matchRun(data + runOffset, runLength, field);
+                if (length > 0) {
+                    report(data + runOffset, length, runOffset);
+                }
+            } else {
+                size_t length = runLength <= sizeof(run) ? matchRun(run, runLength, field) : 0;
+                if (length > 0) {
+                    report(run, length, runOffset);
+                } else {
+                    length = matchRun(data + runOffset, headLength, field);
+                    if (length > 0) {
+                        report(data + runOffset, length, runOffset);
+                    }
+                    length = matchRun(data + tailOffset, runLength - headLength, field);
+                    if (length > 0) {
+                        report(data + tailOffset, length, tailOffset);
+                    }
+                }
+            }
+            runLength = 0;
+            headLength = 0;
+        };
+
+        size_t pos = begin;
+        while (pos < end) {
+            const void* found = std::memchr(data + pos, '\n', end - pos);
+            size_t lineEnd = found == nullptr ? end :
+                    static_cast<size_t>(static_cast<const char*>(found) - data);
+            const char* line = data + pos;
+            size_t lineLength = lineEnd - pos;
+            size_t start = pos;
+            pos = lineEnd + 1;
+
+            bool delimiter = lineLength >= 2 && line[0] == '-' && line[1] == '}';
+            int lineField = field;
+            size_t tagLength = delimiter ? 0 : parseTag(line, lineLength, lineField);
+            if (runLength > 0 && (delimiter || tagLength > 0)) {
+                finishRun();
+            }
+            if (delimiter) {
+                messages++;
+                account.message = firstMessage + messages;
+                field = otherField;
+                content = false;
+                continue;
+            }
+            field = lineField;
+            if (tagLength > 0) {
+                content = true;
+            }
+            if (field == otherField) {
+                continue;
+            }
+
+            // find runs of alphanumerical characters
+            bool information = field == static_cast<int>(MTField::Information);
+            size_t contentEnd = lineEnd > start && data[lineEnd - 1] == '\r' ?
+                    lineEnd - 1 : lineEnd;
+            size_t i = start + tagLength;
+            while (i < contentEnd) {
+                if (getCharValue(data[i]) < 0 || (information && data[i] == '?')) {
+                    if (runLength > 0) {
+                        finishRun();
+                    }
+                    i += information && data[i] == '?' && i + 2 < contentEnd ? 3 : 1;
+                    continue;
+                }
+                if (runLength == 0) {
+                    runOffset = i;
+                } else {
+                    // the run of the previous line continues
+                    headLength = runLength;
+                    tailOffset = i;
+                }
+                while (i < contentEnd && getCharValue(data[i]) >= 0 &&
+                       !(information && data[i] == '?')) {
+                    if (runLength < sizeof(run)) {
+                        run[runLength] = data[i];
+                    }
+                    runLength++;
+                    i++;
+                }
+            }
+            // only a run that ends the line may continue, and only once
+            if (runLength > 0 && (i > contentEnd || headLength > 0 ||
+                                  runLength >= sizeof(run))) {
+                finishRun();
+            }
+        }
+        if (runLength > 0) {
+            finishRun();
+        }
+        return messages + (content ? 1 : 0);
+    }
+
+    /**
+     * Scans a file of MT messages (see \p scan()). The file is mapped into
+     * memory and the pointers passed to \p callback are only valid during the
+     * call. Throws a \p std::runtime_error if the file cannot be mapped.
+     *
+     * @param path The path of the file
+     * @param callback Receives the IBANs
+     * @return The number of messages
+     */
+    size_t MTScanner::scanFile(const std::string& path,
+                               const Callback& callback) const {
+        MappedFile file(path);
+        return scan(file.data(), file.size(), callback);
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        mtscanner.h
+ * \brief       Header file declaring the SWIFT MT message scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a streaming scanner extracting the IBANs of the
+ * account fields of SWIFT MT940 statements and MT103 payment messages.
+ */
+
+#ifndef LIBIBAN_MTSCANNER_H
+#define LIBIBAN_MTSCANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace IBAN {
+
+class ThreadPool;
+
+/// Field of an MT message containing an account
+enum class MTField : unsigned char {
+    /// Account identification (tags 25 and 25P)
+    Account,
+    /// Ordering customer (tags 50A, 50F and 50K)
+    OrderingCustomer,
+    /// Beneficiary customer (tags 59, 59A and 59F)
+    Beneficiary,
+    /// Information to the account owner (tag 86)
+    Information
+};
+
+/// IBAN found in an MT message; all pointers refer to the scanned data
+struct MTAccount {
+    /// Index of the message in the scanned data, counted from 0
+    size_t message;
+    /// The field containing the IBAN
+    MTField field;
+    /// Whether the checksum of the IBAN is valid
+    bool valid;
+    /// The IBAN; an IBAN wrapped into the next line is joined in a buffer
+    /// that is only valid during the callback
+    const char* iban;
+    /// The length of \p iban
+    size_t length;
+    /// Byte offset of the (first character of the) IBAN inside the scanned data
+    size_t offset;
+};
+
+/// Extracts the IBANs of the account fields of MT940 and MT103 messages
+class MTScanner {
+
+private:
+    /// Number of threads scanning messages in parallel
+    unsigned m_threads;
+    /// The pool running the parallel scans or \p nullptr for own threads
+    ThreadPool* m_pool;
+
+    size_t scanRange(const char* data, size_t begin, size_t end,
+                     size_t firstMessage,
+                     const std::function<void(const MTAccount&)>& callback) const;
+
+public:
+    /// Receives the IBANs found by a scan
+    typedef std::function<void(const MTAccount&)> Callback;
+
+    MTScanner(unsigned threads = 1);
+    explicit MTScanner(ThreadPool& pool);
+    size_t scan(const char* data, size_t length,
+                const Callback& callback) const;
+    size_t scanFile(const std::string& path, const Callback& callback) const;
+
+}; // end of class MTScanner
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_MTSCANNER_H
@@ -0,0 +1,427 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        national.cpp
+ * \brief       Source file implementing the registry of national checks
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the registry of national check digit
+ * functions and the checks for French (and Monegasque), Spanish, Italian,
+ * Belgian and Portuguese BBANs.
+ */
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "national.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /**
+     * Returns the registry of national checks indexed by country code. The
+     * built-in checks are registered on first use.
+     *
+     * @return The registry
+     */
+    static std::array<NationalCheckFunction, 26 * 26>& getRegistry() {
+        static std::array<NationalCheckFunction, 26 * 26> registry = [] {
+            std::array<NationalCheckFunction, 26 * 26> table;
+            table.fill(nullptr);
+            table[('F' - 'A') * 26 + ('R' - 'A')] = &checkFrenchBBAN;
+            table[('M' - 'A') * 26 + ('C' - 'A')] = &checkFrenchBBAN;
+            table[('E' - 'A') * 26 + ('S' - 'A')] = &checkSpanishBBAN;
+            table[('I' - 'A') * 26 + ('T' - 'A')] = &checkItalianBBAN;
+            table[('B' - 'A') * 26 + ('E' - 'A')] = &checkBelgianBBAN;
+            table[('P' - 'A') * 26 + ('T' - 'A')] = &checkPortugueseBBAN;
+            table[('N' - 'A') * 26 + ('O' - 'A')] = &checkNorwegianBBAN;
+            return table;
+        }();
+        return registry;
+    }
+
+    /**
+     * Returns the index of a country code in the registry.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return The index or -1 if the country code is malformed
+     */
+    static int getRegistryIndex(char first, char second) {
+        int a = getCharValue(first) - 10;
+        int b = getCharValue(second) - 10;
+        if (a < 0 || b < 0) {
+            return -1;
+        }
+        return a * 26 + b;
+    }
+
+    /**
+     * Registers the national check of a country, replacing any check that is
+     * registered already. Passing \p nullptr removes the check. The registry
+     * is not synchronized, so checks should be registered before validating
+     * from several threads.
+     *
+     * @param first The first letter of the country code
+     * @param second The second letter of the country code
+     * @param check The function checking a BBAN of the country
+     */
+    void registerNationalCheck(char first, char second,
+                               NationalCheckFunction check) {
+        int index = getRegistryIndex(first, second);
+        if (index < 0) {
+            throw std::invalid_argument(std::string("Invalid country code ") +
+                                        first + second);
+        }
+        getRegistry()[static_cast<size_t>(index)] = check;
+    }
+
+    /**
+     * Returns the national check registered for a country.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return The check or \p nullptr if there is none
+     */
+    NationalCheckFunction getNationalCheck(char first, char second) {
+        int index = getRegistryIndex(first, second);
+        return index < 0 ? nullptr : getRegistry()[static_cast<size_t>(index)];
+    }
+
+    /**
+     * Checks the national check digits of an IBAN in machine form with the
+     * check registered for its country.
+     *
+     * @param iban Pointer to the first character of the IBAN
+     * @param length The length of the IBAN
+     * @return The result of the check; \p NationalCheckResult::Unsupported if
+     *         no check is registered for the country
+     */
+    NationalCheckResult checkNationalDigits(const char* iban, size_t length) {
+        if (length < 4) {
+            return NationalCheckResult::Invalid;
+        }
+        NationalCheckFunction check = getNationalCheck(iban[0], iban[1]);
+        if (check == nullptr) {
+            return NationalCheckResult::Unsupported;
+        }
+        return check(iban + 4, length - 4);
+    }
+
+    /**
+     * Calculates the remainder modulo \p divisor of a sequence of digits.
+     *
+     * @param data Pointer to the first digit
+     * @param length The number of digits
+     * @param divisor The divisor
+     * @return The remainder or -1 if a character is not a digit
+     */
+    static long getDecimalRemainder(const char* data, size_t length,
+                                    unsigned divisor) {
+        unsigned long long remainder = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] < '0' || data[i] > '9') {
+                return -1;
+            }
+            remainder = (remainder * 10 + static_cast<unsigned>(data[i] - '0')) %
+                        divisor;
+        }
+        return static_cast<long>(remainder);
+    }
+
+    /**
+     * Compares the two check digits at the end of a BBAN with the expected
+     * value.
+     *
+     * @param check Pointer to the two check digits
+     * @param expected The expected check digits or -1 if they cannot be
+     *        calculated
+     * @return The result of the check
+     */
+    static NationalCheckResult compareCheckDigits(const char* check,
+                                                  long expected) {
+        return expected >= 0 && getDecimalRemainder(check, 2, 100) == expected ?
+               NationalCheckResult::Valid : NationalCheckResult::Invalid;
+    }
+
+    /**
+     * Writes two check digits.
+     *
+     * @param check Pointer to the two check digits
+     * @param value The check digits
+     * @return \p false if \p value is negative
+     */
+    static bool writeCheckDigits(char* check, long value) {
+        if (value < 0) {
+            return false;
+        }
+        check[0] = static_cast<char>('0' + value / 10);
+        check[1] = static_cast<char>('0' + value % 10);
+        return true;
+    }
+
+    /**
+     * Calculates the RIB key of a French BBAN (bank code, branch code, account
+     * number and key). Letters in the account number are replaced by digits
+     * as defined for the RIB: A to I and J to R map to 1 to 9, S to Z to 2
+     * to 9.
+     *
+     * @param bban Pointer to the BBAN
+     * @return The RIB key or -1 if the BBAN contains invalid characters
+     */
+    static long getFrenchKey(const char* bban) {
+        long bank = getDecimalRemainder(bban, 5, 97);
+        long branch = getDecimalRemainder(bban + 5, 5, 97);
+        if (bank < 0 || branch < 0) {
+            return -1;
+        }
+        unsigned account = 0;
+        for (size_t i = 10; i < 21; i++) {
+            int value = getCharValue(bban[i]);
+            if (value < 0) {
+                return -1;
+            }
+            if (value >= 10) {
+                value -= 10;
+                value = value < 9 ? value + 1 : value < 18 ? value - 8 : value - 16;
+            }
+            account = (account * 10 + static_cast<unsigned>(value)) % 97;
+        }
+        return 97 - (89 * bank + 15 * branch + 3 * static_cast<long>(account)) % 97;
+    }
+
+    /**
+     * Checks the RIB key of a French BBAN.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (23)
+     * @return The result of the check
+     */
+    NationalCheckResult checkFrenchBBAN(const char* bban, size_t length) {
+        if (length != 23) {
+            return NationalCheckResult::Invalid;
+        }
+        return compareCheckDigits(bban + 21, getFrenchKey(bban));
+    }
+
+    /**
+     * Calculates a Spanish control digit over ten digits.
+     *
+     * @param data Pointer to the digits
+     * @return The control digit or -1 if a character is not a digit
+     */
+    static int getSpanishControlDigit(const char* data) {
+        static const unsigned weights[10] = {1, 2, 4, 8, 5, 10, 9, 7, 3, 6};
+        unsigned sum = 0;
+        for (size_t i = 0; i < 10; i++) {
+            if (data[i] < '0' || data[i] > '9') {
+                return -1;
+            }
+            sum += static_cast<unsigned>(data[i] - '0') * weights[i];
+        }
+        unsigned digit = 11 - sum % 11;
+        return digit == 11 ? 0 : digit == 10 ? 1 : static_cast<int>(digit);
+    }
+
+    /**
+     * Calculates the control digits (dígitos de control) of a Spanish BBAN:
+     * the first one covers bank and branch code, the second one the account
+     * number.
+     *
+     * @param bban Pointer to the BBAN
+     * @return The control digits or -1 if the BBAN contains invalid characters
+     */
+    static long getSpanishControlDigits(const char* bban) {
+        char office[10] = {'0', '0'};
+        std::copy(bban, bban + 8, office + 2);
+        int first = getSpanishControlDigit(office);
+        int second = getSpanishControlDigit(bban + 10);
+        return first < 0 || second < 0 ? -1 : first * 10 + second;
+    }
+
+    /**
+     * Checks the control digits of a Spanish BBAN.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (20)
+     * @return The result of the check
+     */
+    NationalCheckResult checkSpanishBBAN(const char* bban, size_t length) {
+        if (length != 20) {
+            return NationalCheckResult::Invalid;
+        }
+        return compareCheckDigits(bban + 8, getSpanishControlDigits(bban));
+    }
+
+    /**
+     * Calculates the CIN of an Italian BBAN, a check letter over the ABI, the
+     * CAB and the account number. Characters at odd positions are mapped
+     * through a table, characters at even positions count with their value.
+     *
+     * @param bban Pointer to the BBAN
+     * @return The CIN or '\0' if the BBAN contains invalid characters
+     */
+    static char getItalianCIN(const char* bban) {
+        static const unsigned char odd[26] = {
+            1, 0, 5, 7, 9, 13, 15, 17, 19, 21, 2, 4, 18, 20, 11, 3, 6, 8, 12,
+            14, 16, 10, 22, 25, 24, 23
+        };
+        unsigned sum = 0;
+        for (size_t i = 1; i < 23; i++) {
+            int value = getCharValue(bban[i]);
+            if (value < 0) {
+                return '\0';
+            }
+            // letters count from 0 (A) in this scheme, just like digits
+            if (value >= 10) {
+                value -= 10;
+            }
+            sum += i % 2 == 1 ? odd[value] : static_cast<unsigned>(value);
+        }
+        return static_cast<char>('A' + sum % 26);
+    }
+
+    /**
+     * Checks the CIN of an Italian BBAN.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (23)
+     * @return The result of the check
+     */
+    NationalCheckResult checkItalianBBAN(const char* bban, size_t length) {
+        if (length != 23) {
+            return NationalCheckResult::Invalid;
+        }
+        char cin = getItalianCIN(bban);
+        return cin != '\0' && getCharValue(bban[0]) == getCharValue(cin) ?
+               NationalCheckResult::Valid : NationalCheckResult::Invalid;
+    }
+
+    /**
+     * Calculates the check digits of a Belgian BBAN: the remainder of the
+     * first ten digits modulo 97, where a remainder of 0 is written as 97.
+     *
+     * @param bban Pointer to the BBAN
+     * @return The check digits or -1 if the BBAN contains invalid characters
+     */
+    static long getBelgianCheckDigits(const char* bban) {
+        long remainder = getDecimalRemainder(bban, 10, 97);
+        return remainder == 0 ? 97 : remainder;
+    }
+
+    /**
+     * Checks the check digits of a Belgian BBAN.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (12)
+     * @return The result of the check
+     */
+    NationalCheckResult checkBelgianBBAN(const char* bban, size_t length) {
+        if (length != 12) {
+            return NationalCheckResult::Invalid;
+        }
+        return compareCheckDigits(bban + 10, getBelgianCheckDigits(bban));
+    }
+
+    /**
+     * Calculates the NIB check digits of a Portuguese BBAN: 98 minus the
+     * remainder of the first 19 digits followed by "00" modulo 97.
+     *
+     * @param bban Pointer to the BBAN
+     * @return The check digits or -1 if the BBAN contains invalid characters
+     */
+    static long getPortugueseCheckDigits(const char* bban) {
+        long remainder = getDecimalRemainder(bban, 19, 97);
+        return remainder < 0 ? -1 : 98 - remainder * 100 % 97;
+    }
+
+    /**
+     * Checks the NIB check digits of a Portuguese BBAN.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (21)
+     * @return The result of the check
+     */
+    NationalCheckResult checkPortugueseBBAN(const char* bban, size_t length) {
+        if (length != 21) {
+            return NationalCheckResult::Invalid;
+        }
+        return compareCheckDigits(bban + 19, getPortugueseCheckDigits(bban));
+    }
+
+    /**
+     * Checks the check digit of a Norwegian BBAN, the account number
+     * (kontonummer) itself: the digits weighted with 5, 4, 3, 2, 7, 6, 5, 4,
+     * 3, 2 and the check digit must add up to a multiple of 11. Numbers whose
+     * check digit would be 10 are not issued.
+     *
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN (11)
+     * @return The result of the check
+     */
+    NationalCheckResult checkNorwegianBBAN(const char* bban, size_t length) {
+        static const unsigned weights[] = {5, 4, 3, 2, 7, 6, 5, 4, 3, 2, 1};
+        if (length != 11) {
+            return NationalCheckResult::Invalid;
+        }
+        unsigned sum = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (bban[i] < '0' || bban[i] > '9') {
+                return NationalCheckResult::Invalid;
+            }
+            sum += weights[i] * static_cast<unsigned>(bban[i] - '0');
+        }
+        return sum % 11 == 0 ? NationalCheckResult::Valid : NationalCheckResult::Invalid;
+    }
+
+    /**
+     * Calculates the national check digits of a BBAN of one of the built-in
+     * countries and writes them into the BBAN in place.
+     *
+     * @param first The first letter of the country code (upper case)
+     * @param second The second letter of the country code (upper case)
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN
+     * @return \p false if the country is not supported or the BBAN is invalid
+     */
+    bool fillNationalCheckDigits(char first, char second, char* bban,
+                                 size_t length) {
+        if (((first == 'F' && second == 'R') || (first == 'M' && second == 'C')) &&
+                length == 23) {
+            return writeCheckDigits(bban + 21, getFrenchKey(bban));
+        } else if (first == 'E' && second == 'S' && length == 20) {
+            return writeCheckDigits(bban + 8, getSpanishControlDigits(bban));
+        } else if (first == 'I' && second == 'T' && length == 23) {
+            bban[0] = getItalianCIN(bban);
+            return bban[0] != '\0';
+        } else if (first == 'B' && second == 'E' && length == 12) {
+            return writeCheckDigits(bban + 10, getBelgianCheckDigits(bban));
+        } else if (first == 'P' && second == 'T' && length == 21) {
+            return writeCheckDigits(bban + 19, getPortugueseCheckDigits(bban));
+        }
+        return false;
+    }
+}
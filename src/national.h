@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        national.h
+ * \brief       Header file declaring national check digit validation
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares functions validating the national check digits
+ * embedded in the BBAN of some countries. A BBAN may pass the IBAN checksum
+ * while its account number fails the check of the bank.
+ */
+
+#ifndef LIBIBAN_NATIONAL_H
+#define LIBIBAN_NATIONAL_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace IBAN {
+
+/// Result of a national check digit validation
+enum class NationalCheckResult : unsigned char {
+    /// The national check digits are correct
+    Valid,
+    /// The national check digits are wrong
+    Invalid,
+    /// The national check digits cannot be checked (unknown bank or method)
+    Unsupported
+};
+
+/// Function checking the national check digits of a BBAN
+typedef NationalCheckResult (*NationalCheckFunction)(const char* bban,
+                                                     size_t length);
+
+/// Maps German bank codes (BLZ) to the check digit methods of their banks
+class BLZDirectory {
+
+private:
+    /// Pairs of bank code and method index, sorted by bank code
+    std::vector<std::pair<uint32_t, unsigned char>> m_entries;
+
+public:
+    void add(uint32_t bankCode, const std::string& method);
+    size_t loadBundesbankFile(const std::string& path);
+    int getMethod(uint32_t bankCode) const;
+    size_t getUnsupportedCount() const;
+    size_t size() const;
+
+}; // end of class BLZDirectory
+
+int getGermanMethodIndex(const std::string& method);
+bool isGermanMethodSupported(int method);
+NationalCheckResult checkGermanAccount(int method, const char* account);
+NationalCheckResult checkGermanBBAN(const BLZDirectory& directory,
+                                    const char* bban, size_t length);
+void checkGermanIBANs(const BLZDirectory& directory, const char* ibans,
+                      size_t count, NationalCheckResult* results);
+
+void registerNationalCheck(char first, char second,
+                           NationalCheckFunction check);
+NationalCheckFunction getNationalCheck(char first, char second);
+NationalCheckResult checkNationalDigits(const char* iban, size_t length);
+NationalCheckResult checkFrenchBBAN(const char* bban, size_t length);
+NationalCheckResult checkSpanishBBAN(const char* bban, size_t length);
+NationalCheckResult checkItalianBBAN(const char* bban, size_t length);
+NationalCheckResult checkBelgianBBAN(const char* bban, size_t length);
+NationalCheckResult checkPortugueseBBAN(const char* bban, size_t length);
+NationalCheckResult checkNorwegianBBAN(const char* bban, size_t length);
+bool fillNationalCheckDigits(char first, char second, char* bban,
+                             size_t length);
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_NATIONAL_H
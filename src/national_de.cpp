@@ -0,0 +1,1318 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        national_de.cpp
+ * \brief       Source file implementing German check digit methods
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the check digit methods (Prüfziffermethoden)
+ * of the Deutsche Bundesbank for German account numbers and the directory
+ * mapping bank codes to these methods.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include "national.h"
+#include "libiban.h"
+
+namespace IBAN {
+
+    /// Number of method codes from "00" to "E9"
+    static const size_t methodCount = 150;
+
+    /// Function checking a ten digit account number
+    typedef bool (*MethodFunction)(const unsigned char* digits);
+
+    /**
+     * Calculates the weighted sum of the digits at positions \p from to
+     * \p to (1-based, inclusive). The weights are applied from right to left
+     * starting at position \p to.
+     *
+     * @param digits The ten digits of the account number
+     * @param from The leftmost position
+     * @param to The rightmost position
+     * @param weights The weights from right to left
+     * @param crossSum Whether the cross sum of each product is added
+     * @return The weighted sum
+     */
+    static unsigned weightedSum(const unsigned char* digits, size_t from,
+                                size_t to, const unsigned char* weights,
+                                bool crossSum) {
+        unsigned sum = 0;
+        for (size_t pos = to, i = 0; pos >= from; pos--, i++) {
+            unsigned product = digits[pos - 1] * weights[i];
+            sum += crossSum ? product / 10 + product % 10 : product;
+        }
+        return sum;
+    }
+
+    /**
+     * Checks an account number with a modulus 10 method.
+     *
+     * @param digits The ten digits of the account number
+     * @param from The leftmost weighted position
+     * @param to The rightmost weighted position
+     * @param weights The weights from right to left
+     * @param crossSum Whether the cross sum of each product is added
+     * @param check The position of the check digit
+     * @return \p true if the check digit is correct
+     */
+    static bool modulus10(const unsigned char* digits, size_t from, size_t to,
+                          const unsigned char* weights, bool crossSum,
+                          size_t check) {
+        unsigned sum = weightedSum(digits, from, to, weights, crossSum);
+        return (10 - sum % 10) % 10 == digits[check - 1];
+    }
+
+    /**
+     * Checks an account number with a modulus 11 method. A remainder of 0
+     * yields the check digit 0, other remainders yield 11 minus the
+     * remainder. The treatment of a remainder of 1 differs between methods.
+     *
+     * @param digits The ten digits of the account number
+     * @param from The leftmost weighted position
+     * @param to The rightmost weighted position
+     * @param weights The weights from right to left
+     * @param check The position of the check digit
+     * @param remainderOne The check digit for a remainder of 1 or -1 if the
+     *        account number is invalid in this case
+     * @return \p true if the check digit is correct
+     */
+    static bool modulus11(const unsigned char* digits, size_t from, size_t to,
+                          const unsigned char* weights, size_t check,
+                          int remainderOne) {
+        unsigned remainder = weightedSum(digits, from, to, weights, false) % 11;
+        int expected = remainder == 0 ? 0 :
+                       remainder == 1 ? remainderOne :
+                       static_cast<int>(11 - remainder);
+        return expected >= 0 && expected == digits[check - 1];
+    }
+
+    /**
+     * Checks an account number with a modulus 7 method. A remainder of 0
+     * yields the check digit 0, other remainders yield 7 minus the
+     * remainder.
+     *
+     * @param digits The ten digits of the account number
+     * @param from The leftmost weighted position
+     * @param to The rightmost weighted position
+     * @param weights The weights from right to left
+     * @param crossSum Whether the cross sum of each product is added
+     * @param check The position of the check digit
+     * @return \p true if the check digit is correct
+     */
+    static bool modulus7(const unsigned char* digits, size_t from, size_t to,
+                         const unsigned char* weights, bool crossSum,
+                         size_t check) {
+        unsigned remainder = weightedSum(digits, from, to, weights, crossSum) % 7;
+        return (remainder == 0 ? 0 : 7 - remainder) == digits[check - 1];
+    }
+
+    /**
+     * Returns the account number as an integer.
+     *
+     * @param digits The ten digits of the account number
+     * @return The account number
+     */
+    static unsigned long long getAccountNumber(const unsigned char* digits) {
+        unsigned long long account = 0;
+        for (size_t i = 0; i < 10; i++) {
+            account = account * 10 + digits[i];
+        }
+        return account;
+    }
+
+    /// Rows of the iterated transformation (M10H); the digits from right to
+    /// left are transformed with the rows 1, 2, 3, 4, 1, ...
+    static const unsigned char m10hTable[4][10] = {
+        {0, 1, 5, 9, 3, 7, 4, 8, 2, 6},
+        {0, 1, 7, 6, 9, 8, 3, 2, 5, 4},
+        {0, 1, 8, 4, 6, 2, 9, 5, 7, 3},
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+    };
+
+    /**
+     * Checks an account number with the iterated transformation: the sum of
+     * the transformed digits 1 to 9 is subtracted from the next multiple of
+     * ten.
+     *
+     * @param digits The ten digits of the account number
+     * @return \p true if the check digit is correct
+     */
+    static bool iteratedTransformation(const unsigned char* digits) {
+        unsigned sum = 0;
+        for (size_t pos = 9, i = 0; pos >= 1; pos--, i++) {
+            sum += m10hTable[i % 4][digits[pos - 1]];
+        }
+        return (10 - sum % 10) % 10 == digits[9];
+    }
+
+    /// Weights 2, 1, 2, 1, ...
+    static const unsigned char w21[] = {2, 1, 2, 1, 2, 1, 2, 1, 2};
+    /// Weights 1, 2, 1, 2, ...
+    static const unsigned char w12[] = {1, 2, 1, 2, 1, 2, 1, 2, 1};
+    /// Weights 3, 1, 3, 1, ...
+    static const unsigned char w31[] = {3, 1, 3, 1, 3, 1, 3, 1, 3};
+    /// Weights 3, 1, 7, 3, 1, 7, ...
+    static const unsigned char w317[] = {3, 1, 7, 3, 1, 7, 3, 1, 7};
+    /// Weights 3, 9, 7, 1, 3, 9, 7, 1, 3
+    static const unsigned char w3971[] = {3, 9, 7, 1, 3, 9, 7, 1, 3};
+    /// Weights 1 to 9
+    static const unsigned char w1to9[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    /// Weights 9 down to 1
+    static const unsigned char w9to1[] = {9, 8, 7, 6, 5, 4, 3, 2, 1};
+    /// Weights 2 to 9 followed by 1
+    static const unsigned char w2to9and1[] = {2, 3, 4, 5, 6, 7, 8, 9, 1};
+    /// Weights 2 to 8 followed by 7 and 8
+    static const unsigned char w2to8and78[] = {2, 3, 4, 5, 6, 7, 8, 7, 8};
+    /// Weights 2, 1, 2, 1, 0, 0, 0, 0, 2 of method 30
+    static const unsigned char w30[] = {2, 1, 2, 1, 0, 0, 0, 0, 2};
+    /// Weights 2 to 6, 0, 0, 7 of method 66
+    static const unsigned char w66[] = {2, 3, 4, 5, 6, 0, 0, 7};
+    /// Weights 5, 4, 3, 4, 5 of method 77
+    static const unsigned char w54345[] = {5, 4, 3, 4, 5};
+    /// Weights 3, 7, 1, 3, 7, 1, ...
+    static const unsigned char w371[] = {3, 7, 1, 3, 7, 1, 3, 7, 1};
+    /// Weights 7, 3, 1, 7, 3, 1, ...
+    static const unsigned char w731[] = {7, 3, 1, 7, 3, 1, 7, 3, 1};
+    /// Weights 2 to 9 followed by 2
+    static const unsigned char w2to9[] = {2, 3, 4, 5, 6, 7, 8, 9, 2};
+    /// Weights 2 to 7 followed by 2 to 4
+    static const unsigned char w2to7[] = {2, 3, 4, 5, 6, 7, 2, 3, 4};
+    /// Weights 2 to 10
+    static const unsigned char w2to10[] = {2, 3, 4, 5, 6, 7, 8, 9, 10};
+    /// Weights 2 to 9 followed by 3
+    static const unsigned char w2to9and3[] = {2, 3, 4, 5, 6, 7, 8, 9, 3};
+    /// Weights 2, 4, 8, 5, 10, 9, 7, 3, 6 (powers of two modulo 11)
+    static const unsigned char wPowers[] = {2, 4, 8, 5, 10, 9, 7, 3, 6};
+
+    /// Method 00: modulus 10, weights 2, 1, 2, ..., cross sums
+    static bool method00(const unsigned char* d) {
+        return modulus10(d, 1, 9, w21, true, 10);
+    }
+
+    /// Method 01: modulus 10, weights 3, 7, 1, ...
+    static bool method01(const unsigned char* d) {
+        return modulus10(d, 1, 9, w371, false, 10);
+    }
+
+    /// Method 02: modulus 11, weights 2 to 9, 2
+    static bool method02(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to9, 10, -1);
+    }
+
+    /// Method 03: modulus 10, weights 2, 1, 2, ...
+    static bool method03(const unsigned char* d) {
+        return modulus10(d, 1, 9, w21, false, 10);
+    }
+
+    /// Method 04: modulus 11, weights 2 to 7, 2 to 4
+    static bool method04(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to7, 10, -1);
+    }
+
+    /// Method 05: modulus 10, weights 7, 3, 1, ...
+    static bool method05(const unsigned char* d) {
+        return modulus10(d, 1, 9, w731, false, 10);
+    }
+
+    /// Method 06: modulus 11, weights 2 to 7, 2 to 4, remainder 1 gives 0
+    static bool method06(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to7, 10, 0);
+    }
+
+    /// Method 07: modulus 11, weights 2 to 10
+    static bool method07(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to10, 10, -1);
+    }
+
+    /// Method 08: like method 00, but only for account numbers from 60000
+    static bool method08(const unsigned char* d) {
+        return getAccountNumber(d) < 60000 || method00(d);
+    }
+
+    /// Method 09: no check digit
+    static bool method09(const unsigned char*) {
+        return true;
+    }
+
+    /// Method 10: modulus 11, weights 2 to 10, remainder 1 gives 0
+    static bool method10(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to10, 10, 0);
+    }
+
+    /// Method 11: modulus 11, weights 2 to 10, remainder 1 gives 9
+    static bool method11(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to10, 10, 9);
+    }
+
+    /// Method 13: modulus 10 on positions 2 to 7 with check digit at
+    /// position 8; retried with the account number shifted by two positions
+    static bool method13(const unsigned char* d) {
+        if (modulus10(d, 2, 7, w21, true, 8)) {
+            return true;
+        }
+        unsigned char shifted[10] = {d[2], d[3], d[4], d[5], d[6],
+                                     d[7], d[8], d[9], 0, 0};
+        return modulus10(shifted, 2, 7, w21, true, 8);
+    }
+
+    /// Method 14: modulus 11, weights 2 to 7 on positions 4 to 9
+    static bool method14(const unsigned char* d) {
+        return modulus11(d, 4, 9, w2to7, 10, -1);
+    }
+
+    /// Method 15: modulus 11, weights 2 to 5 on positions 6 to 9
+    static bool method15(const unsigned char* d) {
+        return modulus11(d, 6, 9, w2to7, 10, 0);
+    }
+
+    /// Method 20: modulus 11, weights 2 to 9, 3, remainder 1 gives 0
+    static bool method20(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to9and3, 10, 0);
+    }
+
+    /// Method 32: modulus 11, weights 2 to 7 on positions 4 to 9
+    static bool method32(const unsigned char* d) {
+        return modulus11(d, 4, 9, w2to7, 10, 0);
+    }
+
+    /// Method 33: modulus 11, weights 2 to 6 on positions 5 to 9
+    static bool method33(const unsigned char* d) {
+        return modulus11(d, 5, 9, w2to7, 10, 0);
+    }
+
+    /// Method 38: modulus 11, weights 2, 4, 8, 5, 10, 9 on positions 4 to 9
+    static bool method38(const unsigned char* d) {
+        return modulus11(d, 4, 9, wPowers, 10, 0);
+    }
+
+    /// Method 39: modulus 11, weights 2, 4, 8, 5, 10, 9, 7 on positions 3 to 9
+    static bool method39(const unsigned char* d) {
+        return modulus11(d, 3, 9, wPowers, 10, 0);
+    }
+
+    /// Method 40: modulus 11, weights 2, 4, 8, 5, 10, 9, 7, 3, 6
+    static bool method40(const unsigned char* d) {
+        return modulus11(d, 1, 9, wPowers, 10, 0);
+    }
+
+    /// Method 16: like method 06, but for a remainder of 1 the positions 9
+    /// and 10 must be equal
+    static bool method16(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 1, 9, w2to7, false) % 11;
+        return remainder == 1 ? d[8] == d[9] :
+               (remainder == 0 ? 0 : 11 - remainder) == d[9];
+    }
+
+    /// Method 17: modulus 11 on the cross sums of positions 2 to 7 minus 1,
+    /// check digit at position 8
+    static bool method17(const unsigned char* d) {
+        unsigned remainder = (weightedSum(d, 2, 7, w21, true) + 10) % 11;
+        return (remainder == 0 ? 0 : 10 - remainder) == d[7];
+    }
+
+    /// Method 18: modulus 10, weights 3, 9, 7, 1, ...
+    static bool method18(const unsigned char* d) {
+        return modulus10(d, 1, 9, w3971, false, 10);
+    }
+
+    /// Method 19: modulus 11, weights 2 to 9, 1, remainder 1 gives 0
+    static bool method19(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to9and1, 10, 0);
+    }
+
+    /// Method 21: modulus 10, weights 2, 1, 2, ..., cross sums; the sum is
+    /// reduced to its iterated cross sum
+    static bool method21(const unsigned char* d) {
+        unsigned sum = weightedSum(d, 1, 9, w21, true);
+        while (sum > 9) {
+            sum = sum / 10 + sum % 10;
+        }
+        return 10 - sum == d[9];
+    }
+
+    /// Method 22: modulus 10, weights 3, 1, 3, ..., only the last digits of
+    /// the products are added
+    static bool method22(const unsigned char* d) {
+        unsigned sum = 0;
+        for (size_t pos = 9; pos >= 1; pos--) {
+            sum += d[pos - 1] * w31[9 - pos] % 10;
+        }
+        return (10 - sum % 10) % 10 == d[9];
+    }
+
+    /// Method 23: like method 16 on positions 1 to 6, check digit at
+    /// position 7
+    static bool method23(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 1, 6, w2to7, false) % 11;
+        return remainder == 1 ? d[5] == d[6] :
+               (remainder == 0 ? 0 : 11 - remainder) == d[6];
+    }
+
+    /// Method 24: weights 1, 2, 3, ... from the first significant digit, each
+    /// product plus its weight taken modulo 11
+    static bool method24(const unsigned char* d) {
+        unsigned char digits[9] = {d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7], d[8]};
+        // leading digits 3 to 6 and 9 mark account types, not the number
+        if (digits[0] >= 3 && digits[0] <= 6) {
+            digits[0] = 0;
+        } else if (digits[0] == 9) {
+            digits[0] = digits[1] = digits[2] = 0;
+        }
+        size_t pos = 0;
+        while (pos < 9 && digits[pos] == 0) {
+            pos++;
+        }
+        unsigned sum = 0;
+        for (unsigned weight = 1; pos < 9; pos++, weight = weight % 3 + 1) {
+            sum += (digits[pos] * weight + weight) % 11;
+        }
+        return sum % 10 == d[9];
+    }
+
+    /// Method 25: modulus 11, weights 2 to 9 on positions 2 to 9; a remainder
+    /// of 1 is only allowed for an 8 or 9 at position 2
+    static bool method25(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 2, 9, w2to9, false) % 11;
+        if (remainder == 1) {
+            return d[9] == 0 && (d[1] == 8 || d[1] == 9);
+        }
+        return (remainder == 0 ? 0 : 11 - remainder) == d[9];
+    }
+
+    /// Method 26: modulus 11, weights 2 to 7, 2 on positions 1 to 7, check
+    /// digit at position 8; numbers starting with 00 are shifted left by two
+    static bool method26(const unsigned char* d) {
+        if (d[0] == 0 && d[1] == 0) {
+            unsigned char shifted[10] = {d[2], d[3], d[4], d[5], d[6],
+                                         d[7], d[8], d[9], 0, 0};
+            return modulus11(shifted, 1, 7, w2to7, 8, 0);
+        }
+        return modulus11(d, 1, 7, w2to7, 8, 0);
+    }
+
+    /// Method 27: like method 00 up to 999999999, iterated transformation
+    /// for ten digit numbers
+    static bool method27(const unsigned char* d) {
+        return d[0] == 0 ? method00(d) : iteratedTransformation(d);
+    }
+
+    /// Method 28: modulus 11, weights 2 to 8 on positions 1 to 7, check digit
+    /// at position 8
+    static bool method28(const unsigned char* d) {
+        return modulus11(d, 1, 7, w2to9, 8, 0);
+    }
+
+    /// Method 29: iterated transformation
+    static bool method29(const unsigned char* d) {
+        return iteratedTransformation(d);
+    }
+
+    /// Method 30: modulus 10, weights 2, 0, 0, 0, 0, 1, 2, 1, 2
+    static bool method30(const unsigned char* d) {
+        return modulus10(d, 1, 9, w30, false, 10);
+    }
+
+    /// Method 31: modulus 11, weights 9 down to 1, the remainder is the check
+    /// digit
+    static bool method31(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 1, 9, w9to1, false) % 11;
+        return remainder < 10 && remainder == d[9];
+    }
+
+    /// Method 34: modulus 11, weights 2, 4, 8, 5, 10, 9, 7 on positions 1 to
+    /// 7, check digit at position 8
+    static bool method34(const unsigned char* d) {
+        return modulus11(d, 1, 7, wPowers, 8, 0);
+    }
+
+    /// Method 35: modulus 11, weights 2 to 10, the remainder is the check
+    /// digit; for a remainder of 10 the positions 9 and 10 must be equal
+    static bool method35(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 1, 9, w2to10, false) % 11;
+        return remainder == 10 ? d[8] == d[9] : remainder == d[9];
+    }
+
+    /// Method 36: modulus 11, weights 2, 4, 8, 5 on positions 6 to 9
+    static bool method36(const unsigned char* d) {
+        return modulus11(d, 6, 9, wPowers, 10, 0);
+    }
+
+    /// Method 37: modulus 11, weights 2, 4, 8, 5, 10 on positions 5 to 9
+    static bool method37(const unsigned char* d) {
+        return modulus11(d, 5, 9, wPowers, 10, 0);
+    }
+
+    /// Method 41: like method 00; a 9 at position 4 excludes positions 1 to 3
+    static bool method41(const unsigned char* d) {
+        return d[3] == 9 ? modulus10(d, 4, 9, w21, true, 10) : method00(d);
+    }
+
+    /// Method 42: modulus 11, weights 2 to 9 on positions 2 to 9
+    static bool method42(const unsigned char* d) {
+        return modulus11(d, 2, 9, w2to9, 10, 0);
+    }
+
+    /// Method 43: modulus 10, weights 1 to 9
+    static bool method43(const unsigned char* d) {
+        return modulus10(d, 1, 9, w1to9, false, 10);
+    }
+
+    /// Method 45: like method 00; numbers with a 0 at position 1, a 1 at
+    /// position 5 or starting with 48 have no check digit
+    static bool method45(const unsigned char* d) {
+        return d[0] == 0 || d[4] == 1 || (d[0] == 4 && d[1] == 8) || method00(d);
+    }
+
+    /// Method 46: modulus 11, weights 2 to 6 on positions 3 to 7, check digit
+    /// at position 8
+    static bool method46(const unsigned char* d) {
+        return modulus11(d, 3, 7, w2to7, 8, 0);
+    }
+
+    /// Method 47: modulus 11, weights 2 to 6 on positions 4 to 8, check digit
+    /// at position 9
+    static bool method47(const unsigned char* d) {
+        return modulus11(d, 4, 8, w2to7, 9, 0);
+    }
+
+    /// Method 48: modulus 11, weights 2 to 7 on positions 3 to 8, check digit
+    /// at position 9
+    static bool method48(const unsigned char* d) {
+        return modulus11(d, 3, 8, w2to7, 9, 0);
+    }
+
+    /// Method 49: method 00, then method 01
+    static bool method49(const unsigned char* d) {
+        return method00(d) || method01(d);
+    }
+
+    /// Method 50: modulus 11, weights 2 to 7 on positions 1 to 6, check digit
+    /// at position 7; numbers without sub-account are shifted left by three
+    static bool method50(const unsigned char* d) {
+        return modulus11(d, 1, 6, w2to7, 7, 0) ||
+               (d[0] == 0 && d[1] == 0 && d[2] == 0 && modulus11(d, 4, 9, w2to7, 10, 0));
+    }
+
+    /// Exception of method 51 for accounts with a 9 at position 3: modulus 11
+    /// with weights 2 to 8 on positions 3 to 9, then with weights 2 to 10
+    static bool method51Exception(const unsigned char* d) {
+        return modulus11(d, 3, 9, w2to9, 10, 0) || modulus11(d, 1, 9, w2to10, 10, 0);
+    }
+
+    /// Method 51: modulus 11, weights 2 to 7 on positions 4 to 9, then on
+    /// positions 5 to 9, then like method 00 on positions 4 to 9, then
+    /// modulus 7, weights 2 to 7 on positions 4 to 9; a 9 at position 3
+    /// selects the exception
+    static bool method51(const unsigned char* d) {
+        if (d[2] == 9) {
+            return method51Exception(d);
+        }
+        return modulus11(d, 4, 9, w2to7, 10, 0) ||
+               modulus11(d, 5, 9, w2to7, 10, 0) ||
+               modulus10(d, 4, 9, w21, true, 10) ||
+               modulus7(d, 4, 9, w2to7, false, 10);
+    }
+
+    /// Method 55: modulus 11, weights 2 to 8, 7, 8
+    static bool method55(const unsigned char* d) {
+        return modulus11(d, 1, 9, w2to8and78, 10, 0);
+    }
+
+    /// Method 56: modulus 11, weights 2 to 7, 2 to 4; remainders 0 and 1 are
+    /// invalid unless the number starts with 9, then they give 8 and 7
+    static bool method56(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 1, 9, w2to7, false) % 11;
+        if (remainder <= 1) {
+            return d[0] == 9 && d[9] == (remainder == 1 ? 7 : 8);
+        }
+        return 11 - remainder == d[9];
+    }
+
+    /// Method 58: modulus 11, weights 2 to 6 on positions 5 to 9, remainder 1
+    /// is invalid
+    static bool method58(const unsigned char* d) {
+        return modulus11(d, 5, 9, w2to7, 10, -1);
+    }
+
+    /// Method 59: like method 00, numbers with less than nine digits have no
+    /// check digit
+    static bool method59(const unsigned char* d) {
+        return (d[0] == 0 && d[1] == 0) || method00(d);
+    }
+
+    /// Method 60: like method 00 on positions 3 to 9
+    static bool method60(const unsigned char* d) {
+        return modulus10(d, 3, 9, w21, true, 10);
+    }
+
+    /**
+     * Checks the check digit at position 8 with modulus 10, cross sums and
+     * weights 2, 1, 2, ... on positions 1 to 7. If position 9 holds
+     * \p marker, positions 9 and 10 are included with the weights 1 and 2.
+     *
+     * @param d The ten digits of the account number
+     * @param marker The digit at position 9 including positions 9 and 10
+     * @return \p true if the check digit is correct
+     */
+    static bool modulus10Extended(const unsigned char* d, unsigned char marker) {
+        unsigned sum = weightedSum(d, 1, 7, w21, true);
+        if (d[8] == marker) {
+            sum += d[8] + d[9] * 2 / 10 + d[9] * 2 % 10;
+        }
+        return (10 - sum % 10) % 10 == d[7];
+    }
+
+    /// Method 61: modulus 10 on positions 1 to 7 with check digit at
+    /// position 8; an 8 at position 9 includes positions 9 and 10
+    static bool method61(const unsigned char* d) {
+        return modulus10Extended(d, 8);
+    }
+
+    /// Method 62: modulus 10, weights 2, 1, 2, 1, 2 on positions 3 to 7,
+    /// cross sums, check digit at position 8
+    static bool method62(const unsigned char* d) {
+        return modulus10(d, 3, 7, w21, true, 8);
+    }
+
+    /// Method 63: modulus 10, weights 1, 2, ... on positions 2 to 7, cross
+    /// sums, check digit at position 8; position 1 must be 0 and numbers
+    /// without sub-account are shifted left by two
+    static bool method63(const unsigned char* d) {
+        return d[0] == 0 && (modulus10(d, 2, 7, w21, true, 8) ||
+                             (d[1] == 0 && d[2] == 0 && modulus10(d, 4, 9, w21, true, 10)));
+    }
+
+    /// Method 64: modulus 11, weights 9, 10, 5, 8, 4, 2 on positions 1 to 6,
+    /// check digit at position 7
+    static bool method64(const unsigned char* d) {
+        return modulus11(d, 1, 6, wPowers, 7, 0);
+    }
+
+    /// Method 65: like method 61, but a 9 at position 9 includes positions 9
+    /// and 10
+    static bool method65(const unsigned char* d) {
+        return modulus10Extended(d, 9);
+    }
+
+    /// Method 66: modulus 11, weights 2 to 6, 0, 0, 7 on positions 2 to 9;
+    /// remainder 0 gives 1 and remainder 1 gives 0; position 1 must be 0 and
+    /// a 9 at position 2 means no check digit
+    static bool method66(const unsigned char* d) {
+        if (d[1] == 9) {
+            return true;
+        }
+        unsigned remainder = weightedSum(d, 2, 9, w66, false) % 11;
+        return d[0] == 0 && (remainder <= 1 ? 1 - remainder : 11 - remainder) == d[9];
+    }
+
+    /// Method 67: modulus 10 on positions 1 to 7, check digit at position 8
+    static bool method67(const unsigned char* d) {
+        return modulus10(d, 1, 7, w21, true, 8);
+    }
+
+    /// Method 70: like method 06; a 5 at position 4 or 69 at positions 4 and
+    /// 5 exclude positions 1 to 3
+    static bool method70(const unsigned char* d) {
+        return (d[3] == 5 || (d[3] == 6 && d[4] == 9)) ?
+               modulus11(d, 4, 9, w2to7, 10, 0) : method06(d);
+    }
+
+    /// Method 71: modulus 11, weights 6 down to 1 on positions 2 to 7;
+    /// remainder 1 gives 1
+    static bool method71(const unsigned char* d) {
+        unsigned remainder = weightedSum(d, 2, 7, w1to9, false) % 11;
+        return (remainder <= 1 ? remainder : 11 - remainder) == d[9];
+    }
+
+    /// Method 72: like method 00 on positions 4 to 9
+    static bool method72(const unsigned char* d) {
+        return modulus10(d, 4, 9, w21, true, 10);
+    }
+
+    /// Method 73: like method 00 on positions 4 to 9, then on positions 5 to
+    /// 9, then modulus 7 with weights 2, 1 and cross sums on positions 5 to
+    /// 9; a 9 at position 3 selects the exception of method 51
+    static bool method73(const unsigned char* d) {
+        if (d[2] == 9) {
+            return method51Exception(d);
+        }
+        return modulus10(d, 4, 9, w21, true, 10) ||
+               modulus10(d, 5, 9, w21, true, 10) ||
+               modulus7(d, 5, 9, w21, true, 10);
+    }
+
+    /// Method 74: like method 00; six digit numbers may instead round the
+    /// sum up to the next half decade, numbers with one digit are invalid
+    static bool method74(const unsigned char* d) {
+        if (getAccountNumber(d) < 10) {
+            return false;
+        }
+        if (method00(d)) {
+            return true;
+        }
+        bool sixDigits = d[0] == 0 && d[1] == 0 && d[2] == 0 && d[3] == 0 && d[4] != 0;
+        return sixDigits && (5 - weightedSum(d, 1, 9, w21, true) % 5) % 5 == d[9];
+    }
+
+    /// Method 77: positions 6 to 10 weighted 5 to 1 (then 5, 4, 3, 4, 5)
+    /// must sum up to a multiple of 11
+    static bool method77(const unsigned char* d) {
+        return weightedSum(d, 6, 10, w1to9, false) % 11 == 0 ||
+               weightedSum(d, 6, 10, w54345, false) % 11 == 0;
+    }
+
+    /// Method 78: like method 00, eight digit numbers have no check digit
+    static bool method78(const unsigned char* d) {
+        return (d[0] == 0 && d[1] == 0 && d[2] != 0) || method00(d);
+    }
+
+    /// Method 79: like method 00; numbers starting with 1, 2 or 9 carry
+    /// their check digit at position 9, numbers starting with 0 are invalid
+    static bool method79(const unsigned char* d) {
+        if (d[0] == 0) {
+            return false;
+        }
+        return (d[0] == 1 || d[0] == 2 || d[0] == 9) ?
+               modulus10(d, 1, 8, w21, true, 9) : method00(d);
+    }
+
+    /// Method 81: like method 32; a 9 at position 3 selects the exception of
+    /// method 51
+    static bool method81(const unsigned char* d) {
+        return d[2] == 9 ? method51Exception(d) : method32(d);
+    }
+
+    /// Method 82: method 10 for 99 at positions 3 and 4, method 33 otherwise
+    static bool method82(const unsigned char* d) {
+        return (d[2] == 9 && d[3] == 9) ? method10(d) : method33(d);
+    }
+
+    /// Method 83: modulus 11, weights 2 to 7 on positions 4 to 9, then on
+    /// positions 5 to 9, then modulus 7 on positions 4 to 9; 99 at positions
+    /// 3 and 4 selects modulus 11 with weights 2 to 8 on positions 3 to 9
+    static bool method83(const unsigned char* d) {
+        if (d[2] == 9 && d[3] == 9) {
+            return modulus11(d, 3, 9, w2to9, 10, 0);
+        }
+        return modulus11(d, 4, 9, w2to7, 10, 0) ||
+               modulus11(d, 5, 9, w2to7, 10, 0) ||
+               modulus7(d, 4, 9, w2to7, false, 10);
+    }
+
+    /// Method 86: like method 00 on positions 4 to 9, then method 32; a 9 at
+    /// position 3 selects the exception of method 51
+    static bool method86(const unsigned char* d) {
+        return d[2] == 9 ? method51Exception(d) :
+               modulus10(d, 4, 9, w21, true, 10) || method32(d);
+    }
+
+    /// Method 88: like method 32; a 9 at position 3 includes it with weight 8
+    static bool method88(const unsigned char* d) {
+        return d[2] == 9 ? modulus11(d, 3, 9, w2to9, 10, 0) : method32(d);
+    }
+
+    /// Method 92: modulus 10, weights 3, 7, 1, ... on positions 4 to 9
+    static bool method92(const unsigned char* d) {
+        return modulus10(d, 4, 9, w371, false, 10);
+    }
+
+    /// Method 93: modulus 11, then modulus 7, weights 2 to 6 on positions 1
+    /// to 5 with the check digit at position 6; four leading zeros move the
+    /// number to positions 5 to 9 with the check digit at position 10
+    static bool method93(const unsigned char* d) {
+        bool shifted = d[0] == 0 && d[1] == 0 && d[2] == 0 && d[3] == 0;
+        size_t from = shifted ? 5 : 1;
+        size_t check = shifted ? 10 : 6;
+        return modulus11(d, from, from + 4, w2to7, check, 0) ||
+               modulus7(d, from, from + 4, w2to7, false, check);
+    }
+
+    /// Method 94: modulus 10, weights 1, 2, 1, ..., cross sums
+    static bool method94(const unsigned char* d) {
+        return modulus10(d, 1, 9, w12, true, 10);
+    }
+
+    /// Method 95: like method 06, some ranges have no check digit
+    static bool method95(const unsigned char* d) {
+        unsigned long long account = getAccountNumber(d);
+        return (account >= 1ULL && account <= 1999999ULL) ||
+               (account >= 9000000ULL && account <= 25999999ULL) ||
+               (account >= 396000000ULL && account <= 499999999ULL) ||
+               (account >= 700000000ULL && account <= 799999999ULL) ||
+               (account >= 910000000ULL && account <= 989999999ULL) ||
+               method06(d);
+    }
+
+    /// Method 96: method 19, then method 00; a range has no check digit
+    static bool method96(const unsigned char* d) {
+        unsigned long long account = getAccountNumber(d);
+        return method19(d) || method00(d) ||
+               (account >= 1300000ULL && account <= 99399999ULL);
+    }
+
+    /// Method 97: positions 1 to 9 as a number modulo 11, remainder 10
+    /// gives 0
+    static bool method97(const unsigned char* d) {
+        unsigned remainder = static_cast<unsigned>(getAccountNumber(d) / 10 % 11);
+        return remainder % 10 == d[9];
+    }
+
+    /// Method 98: modulus 10, weights 3, 1, 7, ... on positions 3 to 9, then
+    /// method 32
+    static bool method98(const unsigned char* d) {
+        return modulus10(d, 3, 9, w317, false, 10) || method32(d);
+    }
+
+    /// Method 99: like method 06, a range has no check digit
+    static bool method99(const unsigned char* d) {
+        unsigned long long account = getAccountNumber(d);
+        return (account >= 396000000ULL && account <= 499999999ULL) || method06(d);
+    }
+
+    /// Method A0: modulus 11, weights 2, 4, 8, 5, 10 on positions 5 to 9;
+    /// numbers with up to three digits have no check digit
+    static bool methodA0(const unsigned char* d) {
+        return getAccountNumber(d) < 1000 || modulus11(d, 5, 9, wPowers, 10, 0);
+    }
+
+    /// Method A1: like method 00 on positions 3 to 9, only for numbers with
+    /// eight or ten digits
+    static bool methodA1(const unsigned char* d) {
+        if (d[0] == 0 && (d[1] != 0 || d[2] == 0)) {
+            return false;
+        }
+        return modulus10(d, 3, 9, w21, true, 10);
+    }
+
+    /// Method A2: method 00, then method 04
+    static bool methodA2(const unsigned char* d) {
+        return method00(d) || method04(d);
+    }
+
+    /// Method A3: method 00, then method 10
+    static bool methodA3(const unsigned char* d) {
+        return method00(d) || method10(d);
+    }
+
+    /// Method A5: method 00, then method 10 unless the number starts with 9
+    static bool methodA5(const unsigned char* d) {
+        return method00(d) || (d[0] != 9 && method10(d));
+    }
+
+    /// Method A6: method 00 for an 8 at position 2, method 01 otherwise
+    static bool methodA6(const unsigned char* d) {
+        return d[1] == 8 ? method00(d) : method01(d);
+    }
+
+    /// Method A7: method 00, then method 03
+    static bool methodA7(const unsigned char* d) {
+        return method00(d) || method03(d);
+    }
+
+    /// Method A8: method 32, then method 00 on positions 4 to 9; a 9 at
+    /// position 3 selects the exception of method 51
+    static bool methodA8(const unsigned char* d) {
+        return d[2] == 9 ? method51Exception(d) :
+               method32(d) || modulus10(d, 4, 9, w21, true, 10);
+    }
+
+    /// Method A9: method 01, then method 06
+    static bool methodA9(const unsigned char* d) {
+        return method01(d) || method06(d);
+    }
+
+    /// Method B0: only ten digit numbers not starting with 8; a 1, 2, 3 or 6
+    /// at position 8 means no check digit, method 06 otherwise
+    static bool methodB0(const unsigned char* d) {
+        if (d[0] == 0 || d[0] == 8) {
+            return false;
+        }
+        return d[7] == 1 || d[7] == 2 || d[7] == 3 || d[7] == 6 || method06(d);
+    }
+
+    /// Method B1: method 05, then method 01
+    static bool methodB1(const unsigned char* d) {
+        return method05(d) || method01(d);
+    }
+
+    /// Method B2: method 02 for numbers starting with 0 to 7, method 00
+    /// otherwise
+    static bool methodB2(const unsigned char* d) {
+        return d[0] <= 7 ? method02(d) : method00(d);
+    }
+
+    /// Method B3: method 32 for numbers starting with 0 to 8, method 06
+    /// otherwise
+    static bool methodB3(const unsigned char* d) {
+        return d[0] == 9 ? method06(d) : method32(d);
+    }
+
+    /// Method B4: method 00 for numbers starting with 9, method 02 otherwise
+    static bool methodB4(const unsigned char* d) {
+        return d[0] == 9 ? method00(d) : method02(d);
+    }
+
+    /// Method B5: method 05, then method 00 unless the number starts with 8
+    /// or 9
+    static bool methodB5(const unsigned char* d) {
+        return method05(d) || (d[0] != 8 && d[0] != 9 && method00(d));
+    }
+
+    /// Method B7: method 01 for two ranges, no check digit otherwise
+    static bool methodB7(const unsigned char* d) {
+        unsigned long long account = getAccountNumber(d);
+        bool checked = (account >= 1000000ULL && account <= 5999999ULL) ||
+                       (account >= 700000000ULL && account <= 899999999ULL);
+        return !checked || method01(d);
+    }
+
+    /// Method C2: method 22, then method 00
+    static bool methodC2(const unsigned char* d) {
+        return method22(d) || method00(d);
+    }
+
+    /// Method C3: method 58 for numbers starting with 9, method 00 otherwise
+    static bool methodC3(const unsigned char* d) {
+        return d[0] == 9 ? method58(d) : method00(d);
+    }
+
+    /// Method C4: method 58 for numbers starting with 9, method 15 otherwise
+    static bool methodC4(const unsigned char* d) {
+        return d[0] == 9 ? method58(d) : method15(d);
+    }
+
+    /// Method C7: method 63, then method 06
+    static bool methodC7(const unsigned char* d) {
+        return method63(d) || method06(d);
+    }
+
+    /// Method C8: method 00, then method 04, then method 07
+    static bool methodC8(const unsigned char* d) {
+        return method00(d) || method04(d) || method07(d);
+    }
+
+    /// Method C9: method 00, then method 07
+    static bool methodC9(const unsigned char* d) {
+        return method00(d) || method07(d);
+    }
+
+    /// Method D0: no check digit for numbers starting with 57, method 20
+    /// otherwise
+    static bool methodD0(const unsigned char* d) {
+        return (d[0] == 5 && d[1] == 7) || method20(d);
+    }
+
+    /// Method D3: method 00, then method 27
+    static bool methodD3(const unsigned char* d) {
+        return method00(d) || method27(d);
+    }
+
+    /// Method D8: method 00 for ten digit numbers, no check digit for eight
+    /// digit numbers, shorter numbers are invalid
+    static bool methodD8(const unsigned char* d) {
+        if (d[0] != 0) {
+            return method00(d);
+        }
+        return d[1] == 0 && d[2] != 0;
+    }
+
+    /// Method D9: method 00, then method 10, then method 18
+    static bool methodD9(const unsigned char* d) {
+        return method00(d) || method10(d) || method18(d);
+    }
+
+    /// Method E0: like method 00, but 7 is added to the sum
+    static bool methodE0(const unsigned char* d) {
+        unsigned sum = weightedSum(d, 1, 9, w21, true) + 7;
+        return (10 - sum % 10) % 10 == d[9];
+    }
+
+    /// Method E3: method 00, then method 21
+    static bool methodE3(const unsigned char* d) {
+        return method00(d) || method21(d);
+    }
+
+    /// Method E4: method 02, then method 00
+    static bool methodE4(const unsigned char* d) {
+        return method02(d) || method00(d);
+    }
+
+    /**
+     * Creates the table of all implemented methods indexed by method code.
+     * Methods that are not implemented are \p nullptr: methods depending on
+     * the bank code (52, 53, B6, C0) or on tables of number ranges (C6, D1,
+     * D4), and 57, 68, 69, 75, 76, 80, 84, 85, 87, 89 to 91, A4, B8, B9, C1,
+     * C5, D2, D5 to D7, E1 and E2.
+     *
+     * @return The method table
+     */
+    static std::array<MethodFunction, methodCount> createMethodTable() {
+        std::array<MethodFunction, methodCount> table;
+        table.fill(nullptr);
+        table[0] = &method00;
+        table[1] = &method01;
+        table[2] = &method02;
+        table[3] = &method03;
+        table[4] = &method04;
+        table[5] = &method05;
+        table[6] = &method06;
+        table[7] = &method07;
+        table[8] = &method08;
+        table[9] = &method09;
+        table[10] = &method10;
+        table[11] = &method11;
+        table[13] = &method13;
+        table[14] = &method14;
+        table[15] = &method15;
+        table[16] = &method16;
+        table[17] = &method17;
+        table[18] = &method18;
+        table[19] = &method19;
+        table[20] = &method20;
+        table[21] = &method21;
+        table[22] = &method22;
+        table[23] = &method23;
+        table[24] = &method24;
+        table[25] = &method25;
+        table[26] = &method26;
+        table[27] = &method27;
+        table[28] = &method28;
+        table[29] = &method29;
+        table[30] = &method30;
+        table[31] = &method31;
+        table[32] = &method32;
+        table[33] = &method33;
+        table[34] = &method34;
+        table[35] = &method35;
+        table[36] = &method36;
+        table[37] = &method37;
+        table[38] = &method38;
+        table[39] = &method39;
+        table[40] = &method40;
+        table[41] = &method41;
+        table[42] = &method42;
+        table[43] = &method43;
+        // method 44 equals method 37
+        table[44] = &method37;
+        table[45] = &method45;
+        table[46] = &method46;
+        table[47] = &method47;
+        table[48] = &method48;
+        table[49] = &method49;
+        table[50] = &method50;
+        table[51] = &method51;
+        table[55] = &method55;
+        table[56] = &method56;
+        table[58] = &method58;
+        table[59] = &method59;
+        table[60] = &method60;
+        table[61] = &method61;
+        table[62] = &method62;
+        table[63] = &method63;
+        table[64] = &method64;
+        table[65] = &method65;
+        table[66] = &method66;
+        table[67] = &method67;
+        table[70] = &method70;
+        table[71] = &method71;
+        table[72] = &method72;
+        table[73] = &method73;
+        table[74] = &method74;
+        table[77] = &method77;
+        table[78] = &method78;
+        table[79] = &method79;
+        table[81] = &method81;
+        table[82] = &method82;
+        table[83] = &method83;
+        table[86] = &method86;
+        table[88] = &method88;
+        table[92] = &method92;
+        table[93] = &method93;
+        table[94] = &method94;
+        table[95] = &method95;
+        table[96] = &method96;
+        table[97] = &method97;
+        table[98] = &method98;
+        table[99] = &method99;
+        table[100] = &methodA0;
+        table[101] = &methodA1;
+        table[102] = &methodA2;
+        table[103] = &methodA3;
+        table[105] = &methodA5;
+        table[106] = &methodA6;
+        table[107] = &methodA7;
+        table[108] = &methodA8;
+        table[109] = &methodA9;
+        table[110] = &methodB0;
+        table[111] = &methodB1;
+        table[112] = &methodB2;
+        table[113] = &methodB3;
+        table[114] = &methodB4;
+        table[115] = &methodB5;
+        table[117] = &methodB7;
+        table[122] = &methodC2;
+        table[123] = &methodC3;
+        table[124] = &methodC4;
+        table[127] = &methodC7;
+        table[128] = &methodC8;
+        table[129] = &methodC9;
+        table[130] = &methodD0;
+        table[133] = &methodD3;
+        table[138] = &methodD8;
+        table[139] = &methodD9;
+        table[140] = &methodE0;
+        table[143] = &methodE3;
+        table[144] = &methodE4;
+        return table;
+    }
+
+    /**
+     * Returns the table of implemented methods.
+     *
+     * @return The method table
+     */
+    static const std::array<MethodFunction, methodCount>& getMethodTable() {
+        static const std::array<MethodFunction, methodCount> methods =
+                createMethodTable();
+        return methods;
+    }
+
+    /**
+     * Converts a method code of the Bundesbank ("00" to "E4") to the index
+     * used by \p checkGermanAccount() and \p BLZDirectory.
+     *
+     * @param method The two character method code
+     * @return The index of the method or -1 if the code is malformed
+     */
+    int getGermanMethodIndex(const std::string& method) {
+        if (method.length() != 2 || !std::isdigit(static_cast<unsigned char>(method[1]))) {
+            return -1;
+        }
+        int high;
+        if (std::isdigit(static_cast<unsigned char>(method[0]))) {
+            high = method[0] - '0';
+        } else if (method[0] >= 'A' && method[0] <= 'E') {
+            high = method[0] - 'A' + 10;
+        } else {
+            return -1;
+        }
+        return high * 10 + (method[1] - '0');
+    }
+
+    /**
+     * Returns whether a check digit method is implemented.
+     *
+     * @param method The index of the method (see \p getGermanMethodIndex())
+     * @return \p true if \p checkGermanAccount() supports the method
+     */
+    bool isGermanMethodSupported(int method) {
+        return method >= 0 && static_cast<size_t>(method) < methodCount &&
+               getMethodTable()[static_cast<size_t>(method)] != nullptr;
+    }
+
+    /**
+     * Checks a German account number with a check digit method of the
+     * Bundesbank. Methods that are not implemented (see
+     * \p isGermanMethodSupported()) yield \p NationalCheckResult::Unsupported.
+     *
+     * @param method The index of the method (see \p getGermanMethodIndex())
+     * @param account The ten digits of the account number (left padded)
+     * @return The result of the check
+     */
+    NationalCheckResult checkGermanAccount(int method, const char* account) {
+        if (!isGermanMethodSupported(method)) {
+            return NationalCheckResult::Unsupported;
+        }
+        const std::array<MethodFunction, methodCount>& methods = getMethodTable();
+        unsigned char digits[10];
+        for (size_t i = 0; i < 10; i++) {
+            if (account[i] < '0' || account[i] > '9') {
+                return NationalCheckResult::Invalid;
+            }
+            digits[i] = static_cast<unsigned char>(account[i] - '0');
+        }
+        return methods[static_cast<size_t>(method)](digits) ?
+               NationalCheckResult::Valid : NationalCheckResult::Invalid;
+    }
+
+    /**
+     * Checks the account number of a German BBAN (eight digit bank code
+     * followed by a ten digit account number) with the method the directory
+     * assigns to the bank.
+     *
+     * @param directory The directory of bank codes
+     * @param bban Pointer to the BBAN
+     * @param length The length of the BBAN
+     * @return The result of the check
+     */
+    NationalCheckResult checkGermanBBAN(const BLZDirectory& directory,
+                                        const char* bban, size_t length) {
+        if (length != 18) {
+            return NationalCheckResult::Invalid;
+        }
+        uint32_t bankCode = 0;
+        for (size_t i = 0; i < 8; i++) {
+            if (bban[i] < '0' || bban[i] > '9') {
+                return NationalCheckResult::Invalid;
+            }
+            bankCode = bankCode * 10 + static_cast<uint32_t>(bban[i] - '0');
+        }
+        return checkGermanAccount(directory.getMethod(bankCode), bban + 8);
+    }
+
+    /**
+     * Checks the account numbers of many German IBANs in machine form, stored
+     * back to back with 22 characters each, without allocating memory.
+     *
+     * @param directory The directory of bank codes
+     * @param ibans The IBANs stored back to back
+     * @param count The number of IBANs
+     * @param results Output array of \p count results
+     */
+    void checkGermanIBANs(const BLZDirectory& directory, const char* ibans,
+                          size_t count, NationalCheckResult* results) {
+        for (size_t i = 0; i < count; i++) {
+            results[i] = checkGermanBBAN(directory, ibans + i * 22 + 4, 18);
+        }
+    }
+
+    /**
+     * Adds a bank code to the directory or replaces its method.
+     *
+     * @param bankCode The eight digit bank code
+     * @param method The method code of the bank ("00" to "E4")
+     */
+    void BLZDirectory::add(uint32_t bankCode, const std::string& method) {
+        int index = getGermanMethodIndex(method);
+        if (index < 0) {
+            throw std::invalid_argument("Invalid check digit method " + method);
+        }
+        auto entry = std::make_pair(bankCode, static_cast<unsigned char>(index));
+        auto it = std::lower_bound(m_entries.begin(), m_entries.end(), entry,
+                [](const std::pair<uint32_t, unsigned char>& a,
+                   const std::pair<uint32_t, unsigned char>& b) {
+                    return a.first < b.first;
+                });
+        if (it != m_entries.end() && it->first == bankCode) {
+            it->second = entry.second;
+        } else {
+            m_entries.insert(it, entry);
+        }
+    }
+
+    /**
+     * Loads the bank code file published by the Deutsche Bundesbank. The file
+     * has fixed width records; the bank code occupies the first eight
+     * characters and the check digit method the characters 151 and 152.
+     * Throws a \p std::runtime_error if the file cannot be read.
+     *
+     * @param path The path of the file
+     * @return The number of records loaded
+     */
+    size_t BLZDirectory::loadBundesbankFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open bank code file " + path);
+        }
+        size_t loaded = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.length() < 152) {
+                continue;
+            }
+            uint32_t bankCode = 0;
+            bool numeric = true;
+            for (size_t i = 0; i < 8; i++) {
+                numeric = numeric && std::isdigit(static_cast<unsigned char>(line[i]));
+                bankCode = bankCode * 10 + static_cast<uint32_t>(line[i] - '0');
+            }
+            int index = getGermanMethodIndex(line.substr(150, 2));
+            if (!numeric || index < 0) {
+                continue;
+            }
+            m_entries.push_back(std::make_pair(bankCode,
+                                               static_cast<unsigned char>(index)));
+            loaded++;
+        }
+
+        // keep the first record of every bank code
+        std::stable_sort(m_entries.begin(), m_entries.end(),
+                [](const std::pair<uint32_t, unsigned char>& a,
+                   const std::pair<uint32_t, unsigned char>& b) {
+                    return a.first < b.first;
+                });
+        m_entries.erase(std::unique(m_entries.begin(), m_entries.end(),
+                [](const std::pair<uint32_t, unsigned char>& a,
+                   const std::pair<uint32_t, unsigned char>& b) {
+                    return a.first == b.first;
+                }), m_entries.end());
+        return loaded;
+    }
+
+    /**
+     * Returns the check digit method of a bank.
+     *
+     * @param bankCode The eight digit bank code
+     * @return The index of the method or -1 if the bank code is unknown
+     */
+    int BLZDirectory::getMethod(uint32_t bankCode) const {
+        auto it = std::lower_bound(m_entries.begin(), m_entries.end(),
+                std::make_pair(bankCode, static_cast<unsigned char>(0)));
+        if (it == m_entries.end() || it->first != bankCode) {
+            return -1;
+        }
+        return it->second;
+    }
+
+    /**
+     * Returns the number of bank codes whose check digit method is not
+     * implemented, so that the coverage of a loaded bank code file can be
+     * reported. Account numbers of these banks yield
+     * \p NationalCheckResult::Unsupported.
+     *
+     * @return The number of bank codes with an unsupported method
+     */
+    size_t BLZDirectory::getUnsupportedCount() const {
+        return static_cast<size_t>(std::count_if(m_entries.begin(), m_entries.end(),
+                [](const std::pair<uint32_t, unsigned char>& entry) {
+                    return !isGermanMethodSupported(entry.second);
+                }));
+    }
+
+    /**
+     * Returns the number of bank codes in the directory.
+     *
+     * @return The number of bank codes
+     */
+    size_t BLZDirectory::size() const {
+        return m_entries.size();
+    }
+}
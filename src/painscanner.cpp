@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        painscanner.cpp
+ * \brief       Source file implementing the SEPA payment file scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p PainScanner. The scanner walks
+ * over the tags of the document once without building a tree and without
+ * copying any data, so its memory use does not depend on the file size.
+ */
+
+#include "painscanner.h"
+#include "bic.h"
+#include "libiban.h"
+#include "mappedfile.h"
+#include "xmltags.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p PainScanner.
+     *
+     * @param reportValid Whether valid identifiers are passed to the callback
+     *        as well (default: \p false, only invalid ones)
+     */
+    PainScanner::PainScanner(bool reportValid) : m_reportValid(reportValid) {}
+
+    /**
+     * Scans a pain.001 or pain.008 document for \p IBAN, \p BIC and \p BICFI
+     * elements and validates their values. Invalid identifiers (and valid
+     * ones if requested) are passed to \p callback together with their byte
+     * offset and the \p PmtInfId and \p EndToEndId of the enclosing payment
+     * information and transaction. Namespace prefixes are ignored.
+     *
+     * @param data The document
+     * @param length The length of the document
+     * @param callback Receives the identifiers
+     * @return The counts of the scan
+     */
+    PainScanSummary PainScanner::scan(const char* data, size_t length,
+                                      const Callback& callback) const {
+        PainScanSummary summary = {0, 0, 0};
+        PaymentIdentifier identifier = {IdentifierType::IBAN, false, 0, nullptr,
+                                        0, nullptr, 0, nullptr, 0};
+        size_t pos = 0;
+        XMLTag tag;
+        while (nextXMLTag(data, length, pos, tag)) {
+            bool transaction = isXMLName(tag, "CdtTrfTxInf") ||
+                               isXMLName(tag, "DrctDbtTxInf");
+            if (tag.closing || tag.empty) {
+                if (isXMLName(tag, "PmtInf")) {
+                    identifier.paymentInfoId = nullptr;
+                    identifier.paymentInfoIdLength = 0;
+                }
+                if (transaction || isXMLName(tag, "PmtInf")) {
+                    identifier.endToEndId = nullptr;
+                    identifier.endToEndIdLength = 0;
+                }
+                continue;
+            }
+            if (transaction) {
+                identifier.endToEndId = nullptr;
+                identifier.endToEndIdLength = 0;
+                continue;
+            }
+
+            bool iban = isXMLName(tag, "IBAN");
+            bool bic = isXMLName(tag, "BIC") || isXMLName(tag, "BICFI");
+            bool paymentInfoId = isXMLName(tag, "PmtInfId");
+            bool endToEndId = isXMLName(tag, "EndToEndId");
+            if (!iban && !bic && !paymentInfoId && !endToEndId) {
+                continue;
+            }
+
+            size_t valueStart;
+            size_t valueLength = getXMLText(data, length, pos, valueStart);
+            const char* value = data + valueStart;
+            if (paymentInfoId) {
+                identifier.paymentInfoId = value;
+                identifier.paymentInfoIdLength = valueLength;
+                continue;
+            } else if (endToEndId) {
+                identifier.endToEndId = value;
+                identifier.endToEndIdLength = valueLength;
+                continue;
+            }
+
+            identifier.type = iban ? IdentifierType::IBAN : IdentifierType::BIC;
+            identifier.valid = iban ? IBAN::validateString(value, valueLength) :
+                                      BIC::validateString(value, valueLength);
+            identifier.offset = valueStart;
+            identifier.value = value;
+            identifier.length = valueLength;
+            if (iban) {
+                summary.ibans++;
+            } else {
+                summary.bics++;
+            }
+            if (!identifier.valid) {
+                summary.invalid++;
+            }
+            if ((m_reportValid || !identifier.valid) && callback) {
+                callback(identifier);
+            }
+        }
+        return summary;
+    }
+
+    /**
+     * Scans a payment file (see \p scan()). The file is mapped into memory,
+     * so even files of several gigabytes are scanned without reading them
+     * into buffers. The pointers passed to \p callback are only valid during
+     * the call. Throws a \p std::runtime_error if the file cannot be mapped.
+     *
+     * @param path The path of the file
+     * @param callback Receives the identifiers
+     * @return The counts of the scan
+     */
+    PainScanSummary PainScanner::scanFile(const std::string& path,
+                                          const Callback& callback) const {
+        MappedFile file(path);
+        return scan(file.data(), file.size(), callback);
+    }
+}
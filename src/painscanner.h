@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        painscanner.h
+ * \brief       Header file declaring the SEPA payment file scanner
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a streaming scanner extracting and validating
+ * the IBANs and BICs of SEPA pain.001 and pain.008 payment files.
+ */
+
+#ifndef LIBIBAN_PAINSCANNER_H
+#define LIBIBAN_PAINSCANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace IBAN {
+
+/// Kind of an identifier found in a payment file
+enum class IdentifierType : unsigned char {
+    /// An IBAN (element \p IBAN)
+    IBAN,
+    /// A BIC (elements \p BIC and \p BICFI)
+    BIC
+};
+
+/// Identifier found in a payment file; all pointers refer to the scanned data
+struct PaymentIdentifier {
+    /// The kind of the identifier
+    IdentifierType type;
+    /// Whether the identifier is valid
+    bool valid;
+    /// Byte offset of the value inside the scanned data
+    size_t offset;
+    /// The value of the element without surrounding whitespace
+    const char* value;
+    /// The length of \p value
+    size_t length;
+    /// The \p PmtInfId of the enclosing \p PmtInf (\p nullptr if none)
+    const char* paymentInfoId;
+    /// The length of \p paymentInfoId
+    size_t paymentInfoIdLength;
+    /// The \p EndToEndId of the enclosing transaction (\p nullptr if none)
+    const char* endToEndId;
+    /// The length of \p endToEndId
+    size_t endToEndIdLength;
+};
+
+/// Counts of a scan of a payment file
+struct PainScanSummary {
+    /// Number of IBANs found
+    size_t ibans;
+    /// Number of BICs found
+    size_t bics;
+    /// Number of invalid identifiers
+    size_t invalid;
+};
+
+/// Extracts and validates the IBANs and BICs of pain.001 and pain.008 files
+class PainScanner {
+
+private:
+    /// Whether valid identifiers are reported as well
+    bool m_reportValid;
+
+public:
+    /// Receives the identifiers found by a scan
+    typedef std::function<void(const PaymentIdentifier&)> Callback;
+
+    PainScanner(bool reportValid = false);
+    PainScanSummary scan(const char* data, size_t length,
+                         const Callback& callback) const;
+    PainScanSummary scanFile(const std::string& path,
+                             const Callback& callback) const;
+
+}; // end of class PainScanner
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_PAINSCANNER_H
@@ -0,0 +1,256 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        parallel.h
+ * \brief       Header file defining helpers for scanning documents in parallel
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file defines inline functions splitting large documents into
+ * parts at the boundaries of independent records (entries of statements,
+ * messages of message files) and scanning the parts in parallel.
+ */
+
+#ifndef LIBIBAN_PARALLEL_H
+#define LIBIBAN_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "threadpool.h"
+
+namespace IBAN {
+
+/// Documents are only split into parts of at least this size
+static const size_t minimumPartSize = 1 << 20;
+
+/**
+ * Finds the next occurrence of a delimiter.
+ *
+ * @param data The document
+ * @param pos The position to start at
+ * @param end The end of the part to search
+ * @param delimiter The delimiter
+ * @return The position of the delimiter or \p end if there is none
+ */
+inline size_t findDelimiter(const char* data, size_t pos, size_t end,
+                            const char* delimiter) {
+    const size_t size = std::strlen(delimiter);
+    while (pos + size <= end) {
+        const void* found = std::memchr(data + pos, delimiter[0],
+                                        end - pos - size + 1);
+        if (found == nullptr) {
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const char*>(found) - data);
+        if (std::memcmp(data + pos, delimiter, size) == 0) {
+            return pos;
+        }
+        pos++;
+    }
+    return end;
+}
+
+/**
+ * Counts the occurrences of a delimiter in a part of a document.
+ *
+ * @param data The document
+ * @param begin The start of the part
+ * @param end The end of the part
+ * @param delimiter The delimiter
+ * @return The number of delimiters starting inside the part
+ */
+inline size_t countDelimiters(const char* data, size_t begin, size_t end,
+                              const char* delimiter) {
+    size_t count = 0;
+    for (size_t pos = findDelimiter(data, begin, end, delimiter); pos < end;
+         pos = findDelimiter(data, pos + 1, end, delimiter)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Splits a document into at most \p parts parts of roughly equal size. The
+ * boundaries are moved forward to the next delimiter, so every part starts
+ * at a delimiter (or right after it if \p after is set). Small documents are
+ * not split.
+ *
+ * @param data The document
+ * @param length The length of the document
+ * @param parts The maximum number of parts
+ * @param delimiter The delimiter separating independent records
+ * @param after Whether parts start after the delimiter instead of at it
+ * @return The boundaries of the parts including 0 and \p length
+ */
+inline std::vector<size_t> splitAtDelimiters(const char* data, size_t length,
+                                             size_t parts,
+                                             const char* delimiter,
+                                             bool after) {
+    parts = std::min(parts, length / minimumPartSize);
+    std::vector<size_t> bounds(1, 0);
+    for (size_t i = 1; i < parts; i++) {
+        size_t bound = findDelimiter(data, std::max(bounds.back(), length / parts * i),
+                                     length, delimiter);
+        if (bound == length) {
+            break;
+        }
+        if (after) {
+            bound += std::strlen(delimiter);
+        }
+        if (bound > bounds.back() && bound < length) {
+            bounds.push_back(bound);
+        }
+    }
+    bounds.push_back(length);
+    return bounds;
+}
+
+/**
+ * Calls a function for the indices 0 to \p count - 1, each in its own
+ * thread, and waits for all of them.
+ *
+ * @param count The number of calls
+ * @param function The function taking the index
+ */
+template<typename Function>
+inline void runInParallel(size_t count, Function function) {
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        threads.emplace_back(function, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Calls a function for the indices 0 to \p count - 1 on the workers of a
+ * pool, or each in its own thread without a pool, and waits for all of them.
+ * The function must not use the pool itself.
+ *
+ * @param pool The pool or \p nullptr
+ * @param count The number of calls
+ * @param function The function taking the index
+ */
+template<typename Function>
+inline void runInParallel(ThreadPool* pool, size_t count, Function function) {
+    if (pool == nullptr) {
+        runInParallel(count, function);
+        return;
+    }
+    pool->parallelFor(count, 1, [&function](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            function(i);
+        }
+    });
+}
+
+/**
+ * Scans a document of independent records in parallel. The document is split
+ * at delimiters (see \p splitAtDelimiters()), the records of every part are
+ * counted in parallel to number them across parts, and the parts are scanned
+ * in parallel. Small documents are scanned in one piece.
+ *
+ * @param pool The pool or \p nullptr to use a thread per part
+ * @param threads The maximum number of parts
+ * @param data The document
+ * @param length The length of the document
+ * @param delimiter The delimiter starting (or, with \p after, ending) every
+ *        record
+ * @param after Whether parts start after the delimiter instead of at it
+ * @param countRecords The function counting the records of a part; takes
+ *        the start and end of the part and must count the records exactly
+ *        like \p scanRange
+ * @param scanRange The function scanning a part; takes the start and end of
+ *        the part and the index of its first record and returns the number
+ *        of records scanned
+ * @return The total number of records scanned
+ */
+template<typename CountRecords, typename ScanRange>
+inline size_t scanInParallel(ThreadPool* pool, unsigned threads, const char* data,
+                             size_t length, const char* delimiter, bool after,
+                             CountRecords countRecords, ScanRange scanRange) {
+    std::vector<size_t> bounds = splitAtDelimiters(data, length, threads,
+                                                   delimiter, after);
+    size_t count = bounds.size() - 1;
+    if (count == 1) {
+        return scanRange(0, length, 0);
+    }
+
+    // the index of the first record of each part is known after counting
+    // the records of all parts before it
+    std::vector<size_t> firstRecords(count, 0);
+    runInParallel(pool, count, [&](size_t i) {
+        firstRecords[i] = countRecords(bounds[i], bounds[i + 1]);
+    });
+    size_t records = 0;
+    for (size_t& first : firstRecords) {
+        size_t partRecords = first;
+        first = records;
+        records += partRecords;
+    }
+
+    std::vector<size_t> scanned(count, 0);
+    runInParallel(pool, count, [&](size_t i) {
+        scanned[i] = scanRange(bounds[i], bounds[i + 1], firstRecords[i]);
+    });
+    size_t total = 0;
+    for (size_t value : scanned) {
+        total += value;
+    }
+    return total;
+}
+
+/**
+ * Scans a document of independent records in parallel (see above), counting
+ * the records of a part by the delimiters it contains.
+ *
+ * @param pool The pool or \p nullptr to use a thread per part
+ * @param threads The maximum number of parts
+ * @param data The document
+ * @param length The length of the document
+ * @param delimiter The delimiter starting (or, with \p after, ending) every
+ *        record
+ * @param after Whether parts start after the delimiter instead of at it
+ * @param scanRange The function scanning a part (see above)
+ * @return The total number of records scanned
+ */
+template<typename ScanRange>
+inline size_t scanInParallel(ThreadPool* pool, unsigned threads, const char* data,
+                             size_t length, const char* delimiter, bool after,
+                             ScanRange scanRange) {
+    return scanInParallel(pool, threads, data, length, delimiter, after,
+            [data, delimiter](size_t begin, size_t end) {
+                return countDelimiters(data, begin, end, delimiter);
+            }, scanRange);
+}
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_PARALLEL_H
@@ -0,0 +1,324 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        pipeline.cpp
+ * \brief       Source file implementing the multi-stage validation pipeline
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p Pipeline. Batches are allocated
+ * once per run and recycled from the sink back to the source, so the number
+ * of batches in flight bounds the memory and throttles the source.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "pipeline.h"
+#include "libiban.h"
+#include "ring.h"
+
+namespace IBAN {
+
+    /**
+     * Waits a little before retrying an operation on a full or empty ring:
+     * first by yielding, then by sleeping to leave idle cores alone.
+     *
+     * @param attempts The number of failed attempts so far
+     */
+    static void backOff(size_t attempts) {
+        if (attempts < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    /// Connects the threads of two neighbouring stages
+    class BatchChannel {
+
+    private:
+        /// The ring if there is a single producer and a single consumer
+        std::unique_ptr<SPSCRing<IBANBatch*>> m_single;
+        /// The ring otherwise
+        std::unique_ptr<MPMCRing<IBANBatch*>> m_shared;
+        /// Number of producers that have not finished yet
+        std::atomic<unsigned> m_producers;
+
+        /// Removes a batch unless the ring is empty
+        bool tryPop(IBANBatch*& batch) {
+            return m_single ? m_single->tryPop(batch) : m_shared->tryPop(batch);
+        }
+
+    public:
+        /// Creates the ring fitting the numbers of producers and consumers
+        BatchChannel(size_t capacity, unsigned producers, unsigned consumers) :
+                m_producers(producers) {
+            if (producers == 1 && consumers == 1) {
+                m_single.reset(new SPSCRing<IBANBatch*>(capacity));
+            } else {
+                m_shared.reset(new MPMCRing<IBANBatch*>(capacity));
+            }
+        }
+
+        /// Appends a batch, waiting while the ring is full
+        void push(IBANBatch* batch) {
+            for (size_t attempts = 0;
+                 !(m_single ? m_single->tryPush(batch) : m_shared->tryPush(batch));
+                 attempts++) {
+                backOff(attempts);
+            }
+        }
+
+        /// Removes a batch, waiting while the ring is empty; returns \p false
+        /// once all producers have finished and the ring is empty
+        bool pop(IBANBatch*& batch) {
+            for (size_t attempts = 0; !tryPop(batch); attempts++) {
+                // a producer pushes its last batch before it finishes
+                if (m_producers.load(std::memory_order_acquire) == 0) {
+                    return tryPop(batch);
+                }
+                backOff(attempts);
+            }
+            return true;
+        }
+
+        /// Called by every producer when it has finished
+        void close() {
+            m_producers.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+    /// State of a running pipeline
+    struct PipelineRun {
+        /// All batches of the run
+        std::vector<IBANBatch> batches;
+        /// Batches returned by the sink to the source
+        SPSCRing<IBANBatch*> free;
+        /// Channel \p i leads into stage \p i; the last one into the sink
+        std::vector<std::unique_ptr<BatchChannel>> channels;
+        /// Maximum number of IBANs per batch
+        size_t batchSize;
+        /// Sequence number of the next batch
+        size_t sequence;
+
+        PipelineRun(size_t batchCount, size_t size) :
+                batches(batchCount), free(batchCount), batchSize(size),
+                sequence(0) {}
+    };
+
+    /**
+     * Constructor of \p Pipeline::Emitter.
+     *
+     * @param run The state of the running pipeline
+     */
+    Pipeline::Emitter::Emitter(PipelineRun* run) :
+            m_run(run), m_batch(nullptr), m_count(0) {}
+
+    /**
+     * Adds an IBAN to the current batch and passes the batch on once it is
+     * full. Waits while all batches are in flight. The memory of the IBAN
+     * must stay valid until \p Pipeline::run() returns.
+     *
+     * @param data The IBAN
+     * @param length The length of the IBAN
+     */
+    void Pipeline::Emitter::emit(const char* data, size_t length) {
+        if (m_batch == nullptr) {
+            for (size_t attempts = 0; !m_run->free.tryPop(m_batch); attempts++) {
+                backOff(attempts);
+            }
+            m_batch->views.clear();
+            m_batch->results.clear();
+            m_batch->valid = 0;
+        }
+        m_batch->views.push_back(IBANView{data, length});
+        m_count++;
+        if (m_batch->views.size() >= m_run->batchSize) {
+            flush();
+        }
+    }
+
+    /**
+     * Passes the current batch on even if it is not full yet.
+     */
+    void Pipeline::Emitter::flush() {
+        if (m_batch != nullptr) {
+            m_batch->sequence = m_run->sequence++;
+            m_run->channels.front()->push(m_batch);
+            m_batch = nullptr;
+        }
+    }
+
+    /**
+     * Returns the number of IBANs emitted so far.
+     *
+     * @return The number of IBANs
+     */
+    size_t Pipeline::Emitter::getCount() const {
+        return m_count;
+    }
+
+    /**
+     * Constructor of \p Pipeline.
+     *
+     * @param batchSize Maximum number of IBANs per batch (default: 1024)
+     * @param batches Number of batches in flight (default: 64); the source
+     *        waits for the sink if all of them are in use
+     */
+    Pipeline::Pipeline(size_t batchSize, size_t batches) :
+            m_batchSize(std::max<size_t>(1, batchSize)),
+            m_batches(std::max<size_t>(2, batches)) {}
+
+    /**
+     * Appends a stage. The stage function is called concurrently by
+     * \p parallelism threads for different batches and must not throw.
+     *
+     * @param stage The stage function
+     * @param parallelism Number of worker threads (default: 1); 0 selects the
+     *        number of hardware threads
+     * @return Reference to this pipeline
+     */
+    Pipeline& Pipeline::addStage(const Stage& stage, unsigned parallelism) {
+        if (parallelism == 0) {
+            parallelism = std::max(1u, std::thread::hardware_concurrency());
+        }
+        m_stages.emplace_back(stage, parallelism);
+        return *this;
+    }
+
+    /**
+     * Appends a stage validating the IBANs of each batch (see
+     * \p IBAN::validateString()) and setting their results.
+     *
+     * @param parallelism Number of worker threads (default: 0, the number of
+     *        hardware threads)
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
+     * @return Reference to this pipeline
+     */
+    Pipeline& Pipeline::addValidationStage(unsigned parallelism,
+                                           bool checkNational) {
+        return addStage([checkNational](IBANBatch& batch) {
+            batch.results.resize(batch.views.size());
+            batch.valid = 0;
+            for (size_t i = 0; i < batch.views.size(); i++) {
+                const IBANView& view = batch.views[i];
+                bool result;
+                if (checkNational) {
+                    // validateBatch() expects the machine form
+                    char compact[34];
+                    size_t count = 0;
+                    bool fits = true;
+                    for (size_t j = 0; j < view.length && fits; j++) {
+                        if (std::isspace(static_cast<unsigned char>(view.data[j]))) {
+                            continue;
+                        }
+                        fits = count < sizeof(compact);
+                        if (fits) {
+                            compact[count++] = view.data[j];
+                        }
+                    }
+                    bool national = false;
+                    result = fits && IBAN::validateBatch(compact, count, 1,
+                                                         &national, true) == 1;
+                } else {
+                    result = IBAN::validateString(view.data, view.length);
+                }
+                batch.results[i] = result ? 1 : 0;
+                batch.valid += result ? 1 : 0;
+            }
+        }, parallelism);
+    }
+
+    /**
+     * Runs the pipeline: \p source runs in a thread of its own, every stage
+     * in its worker threads and \p sink in the calling thread. The sink
+     * receives the batches in the order the source emitted them. Returns
+     * after the source has finished and all batches have reached the sink.
+     *
+     * @param source Emits the IBANs
+     * @param sink Receives the processed batches
+     * @return The number of IBANs emitted by the source
+     */
+    size_t Pipeline::run(const Source& source, const Sink& sink) const {
+        PipelineRun run(m_batches, m_batchSize);
+        for (auto& batch : run.batches) {
+            batch.views.reserve(m_batchSize);
+            run.free.tryPush(&batch);
+        }
+        for (size_t i = 0; i <= m_stages.size(); i++) {
+            unsigned producers = i == 0 ? 1 : m_stages[i - 1].second;
+            unsigned consumers = i == m_stages.size() ? 1 : m_stages[i].second;
+            run.channels.emplace_back(new BatchChannel(m_batches, producers, consumers));
+        }
+
+        std::vector<std::thread> threads;
+        size_t emitted = 0;
+        threads.emplace_back([&]() {
+            Emitter emitter(&run);
+            source(emitter);
+            emitter.flush();
+            emitted = emitter.getCount();
+            run.channels.front()->close();
+        });
+        for (size_t i = 0; i < m_stages.size(); i++) {
+            for (unsigned j = 0; j < m_stages[i].second; j++) {
+                threads.emplace_back([&run, this, i]() {
+                    IBANBatch* batch;
+                    while (run.channels[i]->pop(batch)) {
+                        m_stages[i].first(*batch);
+                        run.channels[i + 1]->push(batch);
+                    }
+                    run.channels[i + 1]->close();
+                });
+            }
+        }
+
+        // restore the order of the batches; at most m_batches are in flight,
+        // so their sequence numbers map to distinct slots
+        std::vector<IBANBatch*> pending(m_batches, nullptr);
+        size_t next = 0;
+        IBANBatch* batch;
+        while (run.channels.back()->pop(batch)) {
+            pending[batch->sequence % m_batches] = batch;
+            while ((batch = pending[next % m_batches]) != nullptr) {
+                pending[next % m_batches] = nullptr;
+                next++;
+                if (sink) {
+                    sink(*batch);
+                }
+                run.free.tryPush(batch);
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return emitted;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        pipeline.h
+ * \brief       Header file declaring the multi-stage validation pipeline
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a pipeline moving batches of IBAN views from a
+ * source thread through stages of parallel worker threads to a sink, with
+ * bounded lock-free ring buffers between the stages.
+ */
+
+#ifndef LIBIBAN_PIPELINE_H
+#define LIBIBAN_PIPELINE_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace IBAN {
+
+/// IBAN referring to memory owned by the source of a pipeline
+struct IBANView {
+    /// The IBAN in machine or human readable form
+    const char* data;
+    /// The length of \p data
+    size_t length;
+};
+
+/// Batch of IBAN views moved between the stages of a pipeline
+struct IBANBatch {
+    /// Index of the batch in the order the source emitted it
+    size_t sequence;
+    /// The IBANs
+    std::vector<IBANView> views;
+    /// One result per IBAN, set to 1 by the validation stage if it is valid
+    std::vector<unsigned char> results;
+    /// Number of valid IBANs
+    size_t valid;
+};
+
+struct PipelineRun;
+
+/// Pipeline of a source, stages of worker threads and a sink
+class Pipeline {
+
+public:
+    /// Processes a batch in a worker thread
+    typedef std::function<void(IBANBatch&)> Stage;
+    /// Receives the processed batches in the thread calling \p run()
+    typedef std::function<void(const IBANBatch&)> Sink;
+
+    /// Collects the IBANs of the source into batches
+    class Emitter {
+
+    private:
+        /// The state of the running pipeline
+        PipelineRun* m_run;
+        /// The batch being filled
+        IBANBatch* m_batch;
+        /// Number of IBANs emitted
+        size_t m_count;
+
+        explicit Emitter(PipelineRun* run);
+        friend class Pipeline;
+
+    public:
+        void emit(const char* data, size_t length);
+        void flush();
+        size_t getCount() const;
+
+    }; // end of class Emitter
+
+    /// Emits the IBANs to process; runs in a thread of its own
+    typedef std::function<void(Emitter&)> Source;
+
+private:
+    /// Maximum number of IBANs per batch
+    size_t m_batchSize;
+    /// Number of batches in flight; the source waits if all are in use
+    size_t m_batches;
+    /// The stages with the number of their worker threads
+    std::vector<std::pair<Stage, unsigned>> m_stages;
+
+public:
+    Pipeline(size_t batchSize = 1024, size_t batches = 64);
+    Pipeline& addStage(const Stage& stage, unsigned parallelism = 1);
+    Pipeline& addValidationStage(unsigned parallelism = 0,
+                                 bool checkNational = false);
+    size_t run(const Source& source, const Sink& sink) const;
+
+}; // end of class Pipeline
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_PIPELINE_H
@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        protocol.cpp
+ * \brief       Source file implementing the binary validation protocol
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements encoding and decoding of the frames of the
+ * validation protocol and the validation of request frames.
+ */
+
+#include <cctype>
+#include "protocol.h"
+#include "libiban.h"
+#include "national.h"
+
+namespace IBAN {
+
+    /// Length of the fixed part of a request payload
+    static const size_t requestHeaderLength = 8;
+    /// Length of the fixed part of a response payload
+    static const size_t responseHeaderLength = 6;
+
+    /**
+     * Reads a little endian integer.
+     *
+     * @param data Pointer to the first byte
+     * @param bytes The number of bytes
+     * @return The integer
+     */
+    static uint32_t readInteger(const char* data, size_t bytes) {
+        uint32_t value = 0;
+        for (size_t i = bytes; i > 0; i--) {
+            value = value << 8 | static_cast<unsigned char>(data[i - 1]);
+        }
+        return value;
+    }
+
+    /**
+     * Appends a little endian integer.
+     *
+     * @param output The output
+     * @param value The integer
+     * @param bytes The number of bytes
+     */
+    static void appendInteger(std::string& output, uint32_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            output.push_back(static_cast<char>(value >> (8 * i) & 0xff));
+        }
+    }
+
+    /**
+     * Checks whether a complete frame starts at the beginning of a buffer.
+     *
+     * @param data The received data
+     * @param length The length of the data
+     * @return The length of the frame including its length prefix, 0 if it
+     *         is incomplete or \p malformedFrame if its payload is too long
+     */
+    size_t findFrame(const char* data, size_t length) {
+        if (length < frameHeaderLength) {
+            return 0;
+        }
+        size_t payload = readInteger(data, frameHeaderLength);
+        if (payload > maxPayloadLength) {
+            return malformedFrame;
+        }
+        return length - frameHeaderLength >= payload ? frameHeaderLength + payload : 0;
+    }
+
+    /**
+     * Appends a request frame.
+     *
+     * @param output The output
+     * @param id The request id, returned in the response
+     * @param ibans The IBANs, at most 65535 of at most 255 characters each
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
+     * @return \p false if the IBANs exceed the limits of a frame
+     */
+    bool appendRequest(std::string& output, uint32_t id,
+                       const std::vector<std::string>& ibans,
+                       bool checkNational) {
+        size_t payload = requestHeaderLength;
+        for (auto& iban : ibans) {
+            if (iban.length() > 255) {
+                return false;
+            }
+            payload += 1 + iban.length();
+        }
+        if (ibans.size() > 0xffff || payload > maxPayloadLength) {
+            return false;
+        }
+        appendInteger(output, static_cast<uint32_t>(payload), 4);
+        appendInteger(output, id, 4);
+        appendInteger(output, checkNational ? 1 : 0, 1);
+        appendInteger(output, 0, 1);
+        appendInteger(output, static_cast<uint32_t>(ibans.size()), 2);
+        for (auto& iban : ibans) {
+            appendInteger(output, static_cast<uint32_t>(iban.length()), 1);
+            output += iban;
+        }
+        return true;
+    }
+
+    /**
+     * Validates a single IBAN in machine or human readable form.
+     *
+     * @param data The IBAN
+     * @param length The length of the IBAN
+     * @param checkNational Whether national check digits are checked
+     * @return The result code
+     */
+    ValidationCode validateEntry(const char* data, size_t length,
+                                 bool checkNational) {
+        char compact[34];
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (std::isspace(static_cast<unsigned char>(data[i]))) {
+                continue;
+            }
+            if (count == sizeof(compact)) {
+                return ValidationCode::Malformed;
+            }
+            compact[count++] = data[i];
+        }
+        bool valid = false;
+        if (IBAN::validateBatch(compact, count, 1, &valid) == 0) {
+            return ValidationCode::Invalid;
+        }
+        if (checkNational && checkNationalDigits(compact, count) ==
+                             NationalCheckResult::Invalid) {
+            return ValidationCode::NationalInvalid;
+        }
+        return ValidationCode::Valid;
+    }
+
+    /**
+     * Validates the IBANs of a request and appends the response frame.
+     *
+     * @param payload The payload of the request frame
+     * @param length The length of the payload
+     * @param output The output
+     * @return \p false if the request is malformed; nothing is appended then
+     */
+    bool handleRequest(const char* payload, size_t length, std::string& output) {
+        if (length < requestHeaderLength) {
+            return false;
+        }
+        uint32_t id = readInteger(payload, 4);
+        bool checkNational = (static_cast<unsigned char>(payload[4]) & 1) != 0;
+        size_t count = readInteger(payload + 6, 2);
+
+        size_t start = output.size();
+        size_t codesLength = (count + 3) / 4;
+        appendInteger(output, static_cast<uint32_t>(responseHeaderLength + codesLength), 4);
+        appendInteger(output, id, 4);
+        appendInteger(output, static_cast<uint32_t>(count), 2);
+        output.append(codesLength, '\0');
+        char* codes = &output[output.size() - codesLength];
+
+        size_t pos = requestHeaderLength;
+        for (size_t i = 0; i < count; i++) {
+            if (pos >= length || pos + 1 + static_cast<unsigned char>(payload[pos]) > length) {
+                output.resize(start);
+                return false;
+            }
+            size_t entryLength = static_cast<unsigned char>(payload[pos]);
+            ValidationCode code = validateEntry(payload + pos + 1, entryLength,
+                                                checkNational);
+            codes[i / 4] = static_cast<char>(codes[i / 4] |
+                    static_cast<unsigned char>(code) << (2 * (i % 4)));
+            pos += 1 + entryLength;
+        }
+        if (pos != length) {
+            output.resize(start);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Decodes a response.
+     *
+     * @param payload The payload of the response frame
+     * @param length The length of the payload
+     * @param id Receives the request id
+     * @param codes Receives the result codes
+     * @return \p false if the response is malformed
+     */
+    bool parseResponse(const char* payload, size_t length, uint32_t& id,
+                       std::vector<ValidationCode>& codes) {
+        if (length < responseHeaderLength) {
+            return false;
+        }
+        id = readInteger(payload, 4);
+        size_t count = readInteger(payload + 4, 2);
+        if (length != responseHeaderLength + (count + 3) / 4) {
+            return false;
+        }
+        codes.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            unsigned char byte = static_cast<unsigned char>(
+                    payload[responseHeaderLength + i / 4]);
+            codes[i] = static_cast<ValidationCode>(byte >> (2 * (i % 4)) & 3);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        protocol.h
+ * \brief       Header file declaring the binary validation protocol
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares the length-prefixed binary protocol spoken by
+ * the validation daemon \p iband. All integers are little endian.
+ *
+ * A frame is a 32 bit payload length followed by the payload. A request
+ * payload holds a 32 bit request id, a flags byte (bit 0: check national
+ * check digits), a reserved byte, a 16 bit count and \p count entries of a
+ * length byte followed by the IBAN. A response payload holds the request id,
+ * the count and the result codes packed into two bits each, four per byte
+ * starting at the least significant bits.
+ */
+
+#ifndef LIBIBAN_PROTOCOL_H
+#define LIBIBAN_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IBAN {
+
+/// Result code of a validation
+enum class ValidationCode : unsigned char {
+    /// The IBAN is valid
+    Valid = 0,
+    /// The IBAN has a wrong format or checksum
+    Invalid = 1,
+    /// The IBAN is valid but its national check digits are wrong
+    NationalInvalid = 2,
+    /// The entry is longer than any IBAN
+    Malformed = 3
+};
+
+/// Length of the length prefix of a frame
+static const size_t frameHeaderLength = 4;
+/// Maximum length of the payload of a frame
+static const size_t maxPayloadLength = 1 << 20;
+/// Returned by \p findFrame() if the length prefix exceeds the limit
+static const size_t malformedFrame = static_cast<size_t>(-1);
+
+ValidationCode validateEntry(const char* data, size_t length,
+                             bool checkNational = false);
+size_t findFrame(const char* data, size_t length);
+bool appendRequest(std::string& output, uint32_t id,
+                   const std::vector<std::string>& ibans,
+                   bool checkNational = false);
+bool handleRequest(const char* payload, size_t length, std::string& output);
+bool parseResponse(const char* payload, size_t length, uint32_t& id,
+                   std::vector<ValidationCode>& codes);
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_PROTOCOL_H
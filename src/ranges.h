@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        ranges.h
+ * \brief       Header file defining C++20 range adaptors and generators
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file defines an optional C++20 layer on top of \p libiban:
+ * lazy range adaptors (\p IBAN::views::lines, \p IBAN::views::parse and
+ * \p IBAN::views::valid) and a coroutine generator of random IBANs. The
+ * library itself is built with C++11; this header is only usable from
+ * translation units compiled with C++20 and is empty otherwise.
+ */
+
+#ifndef LIBIBAN_RANGES_H
+#define LIBIBAN_RANGES_H
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<ranges>) && __has_include(<coroutine>)
+#define LIBIBAN_HAVE_RANGES 1
+#endif
+#endif
+
+#if defined(LIBIBAN_HAVE_RANGES)
+
+#include <array>
+#include <cctype>
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "libiban.h"
+
+namespace IBAN {
+
+/// Result of parsing a string as an IBAN without allocating memory
+class ParsedIBAN {
+
+private:
+    /// The parsed string
+    std::string_view m_source;
+    /// The machine form: whitespace removed, letters in upper case
+    std::array<char, 34> m_machineForm {};
+    /// The length of the machine form
+    size_t m_length = 0;
+    /// Whether the machine form is a valid IBAN
+    bool m_valid = false;
+
+public:
+    /**
+     * Parses a string. Strings longer than the longest IBAN are invalid.
+     *
+     * @param source The string in machine or human readable form
+     */
+    explicit ParsedIBAN(std::string_view source) : m_source(source) {
+        for (char ch : source) {
+            if (std::isspace(static_cast<unsigned char>(ch))) {
+                continue;
+            }
+            if (m_length == m_machineForm.size()) {
+                m_length = 0;
+                return;
+            }
+            m_machineForm[m_length++] = static_cast<char>(
+                    std::toupper(static_cast<unsigned char>(ch)));
+        }
+        m_valid = IBAN::validateString(m_machineForm.data(), m_length);
+    }
+
+    /// Returns the parsed string
+    std::string_view source() const { return m_source; }
+    /// Returns the machine form; refers to this object
+    std::string_view machineForm() const { return {m_machineForm.data(), m_length}; }
+    /// Returns the country code; refers to this object
+    std::string_view countryCode() const { return machineForm().substr(0, 2); }
+    /// Returns whether the IBAN is valid
+    bool valid() const { return m_valid; }
+    /// Creates an \p IBAN object; throws an \p IBANParseException if invalid
+    IBAN toIBAN() const { return IBAN::createFromString(std::string(machineForm())); }
+};
+
+namespace views {
+
+/// Splits a contiguous character range into lines (without the line breaks)
+inline constexpr auto lines = std::views::split('\n') |
+        std::views::transform([](auto&& line) {
+            std::string_view view(std::ranges::data(line), std::ranges::size(line));
+            return view.ends_with('\r') ? view.substr(0, view.size() - 1) : view;
+        });
+
+/// Parses each element, a string view or string, as an IBAN
+inline constexpr auto parse = std::views::transform([](std::string_view text) {
+    return ParsedIBAN(text);
+});
+
+/// Keeps the valid IBANs of a range of \p ParsedIBAN
+inline constexpr auto valid = std::views::filter([](const ParsedIBAN& iban) {
+    return iban.valid();
+});
+
+} // end of namespace views
+
+/// Lazy sequence of values produced by a coroutine; a move-only input view
+template<typename T>
+class Generator : public std::ranges::view_base {
+
+public:
+    /// The coroutine state
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T element) {
+            value = std::move(element);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    /// Resumes the coroutine when advanced
+    class iterator {
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        T& operator*() const { return *m_handle.promise().value; }
+        iterator& operator++() {
+            resume(m_handle);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const {
+            return !m_handle || m_handle.done();
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+
+    explicit Generator(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    /// Runs the coroutine up to its next value and rethrows its exceptions
+    static void resume(std::coroutine_handle<promise_type> handle) {
+        handle.promise().value.reset();
+        handle.resume();
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+
+public:
+    Generator() = default;
+    Generator(Generator&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        std::swap(m_handle, other.m_handle);
+        return *this;
+    }
+    ~Generator() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    /// Starts the coroutine; may only be called once
+    iterator begin() {
+        if (m_handle) {
+            resume(m_handle);
+        }
+        return iterator(m_handle);
+    }
+    std::default_sentinel_t end() const { return {}; }
+};
+
+/**
+ * Generates random valid IBANs of a country without end (see
+ * \p IBAN::generateIBAN()). Combine with \p std::views::take to bound it.
+ *
+ * @param countryCode The country code of the IBANs
+ * @return The generator
+ */
+inline Generator<IBAN> generateIBANs(std::string countryCode) {
+    while (true) {
+        co_yield IBAN::generateIBAN(countryCode);
+    }
+}
+
+} // end of namespace IBAN
+
+#endif // LIBIBAN_HAVE_RANGES
+
+#endif //LIBIBAN_RANGES_H
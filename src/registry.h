@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        registry.h
+ * \brief       Header file defining the registry of IBAN countries
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file defines the registry of all countries supporting IBANs
+ * together with the length and the BBAN format of their IBANs. The registry
+ * is usable in constant expressions.
+ */
+
+#ifndef LIBIBAN_REGISTRY_H
+#define LIBIBAN_REGISTRY_H
+
+#include <cstddef>
+
+/**
+ * Lists all countries supporting IBANs. Expands \p X(code, length, format)
+ * for every country, so tables and types can be generated from a single list.
+ * The BBAN format uses the notation of the IBAN registry: groups of a count
+ * followed by \p n (digits), \p a (upper case letters) or \p c
+ * (alphanumerical characters).
+ */
+#define LIBIBAN_COUNTRIES(X) \
+    X(AL, 28, "8n16c") X(AD, 24, "8n12c") X(AT, 20, "16n") \
+    X(AZ, 28, "4a20c") X(BE, 16, "12n") X(BH, 22, "4a14c") \
+    X(BA, 20, "16n") X(BR, 29, "23n1a1c") X(BG, 22, "4a6n8c") \
+    X(CR, 22, "18n") X(HR, 21, "17n") X(CY, 28, "8n16c") \
+    X(CZ, 24, "20n") X(DK, 18, "14n") X(DO, 28, "4c20n") \
+    X(EE, 20, "16n") X(FO, 18, "14n") X(FI, 18, "14n") \
+    X(FR, 27, "10n11c2n") X(GE, 22, "2a16n") X(DE, 22, "18n") \
+    X(GI, 23, "4a15c") X(GR, 27, "7n16c") X(GL, 18, "14n") \
+    X(GT, 28, "4c20c") X(HU, 28, "24n") X(IS, 26, "22n") \
+    X(IE, 22, "4a14n") X(IL, 23, "19n") X(IT, 27, "1a10n12c") \
+    X(KZ, 20, "3n13c") X(KW, 30, "4a22c") X(LV, 21, "4a13c") \
+    X(LB, 28, "4n20c") X(LI, 21, "5n12c") X(LT, 20, "16n") \
+    X(LU, 20, "3n13c") X(MK, 19, "3n10c2n") X(MT, 31, "4a5n18c") \
+    X(MR, 27, "23n") X(MU, 30, "4a19n3a") X(MC, 27, "10n11c2n") \
+    X(MD, 24, "20c") X(ME, 22, "18n") X(NL, 18, "4a10n") \
+    X(NO, 15, "11n") X(PK, 24, "4a16c") X(PS, 29, "4a21c") \
+    X(PL, 28, "24n") X(PT, 25, "21n") X(RO, 24, "4a16c") \
+    X(SM, 27, "1a10n12c") X(SA, 24, "2n18c") X(RS, 22, "18n") \
+    X(SK, 24, "20n") X(SI, 19, "15n") X(ES, 24, "20n") \
+    X(SE, 24, "20n") X(CH, 21, "5n12c") X(TN, 24, "20n") \
+    X(TR, 26, "6n16c") X(AE, 23, "19n") X(GB, 22, "4a14n") \
+    X(VG, 24, "4a16n") X(BJ, 28, "2c22n") X(BF, 28, "2c22n") \
+    X(BI, 16, "12n") X(CM, 27, "23n") X(CV, 25, "21n") \
+    X(TL, 23, "19n") X(IR, 26, "22n") X(CI, 28, "2c22n") \
+    X(JO, 30, "4a4n18c") X(MG, 27, "23n") X(ML, 28, "2c22n") \
+    X(MZ, 25, "21n") X(QA, 29, "4a21c") X(XK, 20, "16n") \
+    X(SN, 28, "2c22n") X(LC, 32, "4a24c") X(ST, 25, "21n") \
+    X(UA, 29, "6n19c") X(SC, 31, "4a20n3a") X(IQ, 23, "4a15n") \
+    X(BY, 28, "4c4n16c") X(SV, 28, "4a20n") X(AO, 25, "21n") \
+    X(CF, 27, "23n") X(CG, 27, "23n") X(EG, 27, "23n") \
+    X(DJ, 27, "23n") X(DZ, 24, "20n") X(GA, 27, "23n") \
+    X(GQ, 27, "23n") X(GW, 25, "2c19n") X(MA, 28, "24n") \
+    X(NE, 28, "2a22n") X(TD, 27, "23n") X(TG, 28, "2a22n") \
+    X(KM, 27, "23n") X(HN, 28, "4a20n") X(NI, 32, "4a24n")
+
+namespace IBAN {
+
+/// Entry of the country registry
+struct CountryInfo {
+    /// The two letters of the country code
+    char code[3];
+    /// The length of IBANs of the country
+    size_t length;
+    /// The format of the BBAN
+    const char* format;
+};
+
+/// Expands a registry entry to a \p CountryInfo initializer
+#define LIBIBAN_COUNTRY_INFO(code, length, format) {#code, length, format},
+
+/// All countries supporting IBANs
+constexpr CountryInfo countryRegistry[] = {
+    LIBIBAN_COUNTRIES(LIBIBAN_COUNTRY_INFO)
+};
+
+#undef LIBIBAN_COUNTRY_INFO
+
+/// Number of countries in the registry
+constexpr size_t countryRegistrySize =
+        sizeof(countryRegistry) / sizeof(countryRegistry[0]);
+
+/// Expands a registry entry to an enumerator whose value is the index of
+/// the country code in a table of 26 * 26 entries
+#define LIBIBAN_COUNTRY_ENUM(code, length, format) \
+    code = (#code[0] - 'A') * 26 + (#code[1] - 'A'),
+
+/// Countries supporting IBANs
+enum class Country : unsigned short {
+    LIBIBAN_COUNTRIES(LIBIBAN_COUNTRY_ENUM)
+};
+
+#undef LIBIBAN_COUNTRY_ENUM
+
+/**
+ * Looks up the IBAN length of a country in the registry. Usable in constant
+ * expressions; at runtime prefer \p IBAN::getLengthForCountry().
+ *
+ * @param first The first letter of the country code (upper case)
+ * @param second The second letter of the country code (upper case)
+ * @param index The registry entry to start at (default: 0)
+ * @return The IBAN length or 0 if the country is unknown
+ */
+constexpr size_t lookupCountryLength(char first, char second,
+                                     size_t index = 0) {
+    return index == countryRegistrySize ? 0 :
+           (countryRegistry[index].code[0] == first &&
+            countryRegistry[index].code[1] == second) ?
+                   countryRegistry[index].length :
+                   lookupCountryLength(first, second, index + 1);
+}
+
+/**
+ * Looks up the BBAN format of a country in the registry.
+ *
+ * @param first The first letter of the country code (upper case)
+ * @param second The second letter of the country code (upper case)
+ * @param index The registry entry to start at (default: 0)
+ * @return The BBAN format or an empty string if the country is unknown
+ */
+constexpr const char* lookupCountryFormat(char first, char second,
+                                          size_t index = 0) {
+    return index == countryRegistrySize ? "" :
+           (countryRegistry[index].code[0] == first &&
+            countryRegistry[index].code[1] == second) ?
+                   countryRegistry[index].format :
+                   lookupCountryFormat(first, second, index + 1);
+}
+
+/**
+ * Parses the count at the beginning of a group of a BBAN format.
+ *
+ * @param format Pointer to the group
+ * @param count The digits parsed so far (default: 0)
+ * @return The count of the group
+ */
+constexpr size_t getFormatCount(const char* format, size_t count = 0) {
+    return (format[0] >= '0' && format[0] <= '9') ?
+           getFormatCount(format + 1, count * 10 +
+                          static_cast<size_t>(format[0] - '0')) : count;
+}
+
+/**
+ * Returns a pointer to the character class of a group of a BBAN format.
+ *
+ * @param format Pointer to the group
+ * @return Pointer to the character class after the count
+ */
+constexpr const char* getFormatClassPointer(const char* format) {
+    return (format[0] >= '0' && format[0] <= '9') ?
+           getFormatClassPointer(format + 1) : format;
+}
+
+/**
+ * Returns the total length of the BBAN described by a format.
+ *
+ * @param format The BBAN format
+ * @return The length of the BBAN
+ */
+constexpr size_t getFormatLength(const char* format) {
+    return format[0] == '\0' ? 0 :
+           getFormatCount(format) +
+           getFormatLength(getFormatClassPointer(format) + 1);
+}
+
+/**
+ * Returns the character class (\p n, \p a or \p c) required at a position
+ * of a BBAN. Positions behind the end of the format yield \p '\0'.
+ *
+ * @param format The BBAN format
+ * @param position The position inside the BBAN
+ * @return The character class at \p position
+ */
+constexpr char getFormatClass(const char* format, size_t position) {
+    return format[0] == '\0' ? '\0' :
+           position < getFormatCount(format) ?
+                   getFormatClassPointer(format)[0] :
+                   getFormatClass(getFormatClassPointer(format) + 1,
+                                  position - getFormatCount(format));
+}
+
+/**
+ * Checks whether a character value matches a character class of a BBAN
+ * format.
+ *
+ * @param type The character class (\p n, \p a or \p c)
+ * @param value The value of the character as returned by \p getCharValue()
+ * @return \p true if the value matches the class
+ */
+constexpr bool matchesFormatClass(char type, int value) {
+    return type == 'n' ? (value >= 0 && value < 10) :
+           type == 'a' ? value >= 10 :
+           type == 'c' ? value >= 0 : false;
+}
+
+/// Verifies that the BBAN format of a registry entry matches its length
+#define LIBIBAN_COUNTRY_CHECK(code, length, format) \
+    static_assert(getFormatLength(format) + 4 == length, \
+                  "BBAN format of " #code " does not match its length");
+
+LIBIBAN_COUNTRIES(LIBIBAN_COUNTRY_CHECK)
+
+#undef LIBIBAN_COUNTRY_CHECK
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_REGISTRY_H
@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        rfreference.cpp
+ * \brief       Source file implementing ISO 11649 creditor references
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p RFReference on top of the MOD
+ * 97-10 functions shared with the IBAN implementation.
+ */
+
+#include <cctype>
+#include "rfreference.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /**
+     * Constructor of \p RFParseException.
+     *
+     * @param reference The string causing the exception
+     */
+    RFParseException::RFParseException(const std::string& reference) noexcept :
+            m_reference(reference) {
+        m_message = "Cannot parse creditor reference " + m_reference;
+    }
+
+    /**
+     * Destructor of \p RFParseException
+     */
+    RFParseException::~RFParseException() {}
+
+    /**
+     * Overrides the function \p what() for this exception and returns a
+     * string describing the error.
+     *
+     * @return A string describing the error
+     */
+    const char* RFParseException::what() const noexcept {
+        return m_message.c_str();
+    }
+
+    /**
+     * Checks whether a creditor reference in machine form is structurally
+     * valid: the prefix "RF" (either case), two digits and one to 21
+     * alphanumerical characters.
+     *
+     * @param data Pointer to the first character of the reference
+     * @param length The number of characters
+     * @return \p true if the structure is valid, \p false otherwise
+     */
+    static bool isStructureValid(const char* data, size_t length) {
+        if (length < 5 || length > RFReference::maxLength ||
+                std::toupper(static_cast<unsigned char>(data[0])) != 'R' ||
+                std::toupper(static_cast<unsigned char>(data[1])) != 'F' ||
+                getCharValue(data[2]) < 0 || getCharValue(data[2]) > 9 ||
+                getCharValue(data[3]) < 0 || getCharValue(data[3]) > 9) {
+            return false;
+        }
+        for (size_t i = 4; i < length; i++) {
+            if (getCharValue(data[i]) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Creates a creditor reference from a string in machine form or human
+     * readable form. Throws an \p RFParseException if the string is not
+     * structurally valid; use \p validate() to check the checksum.
+     *
+     * @param string The string to parse
+     * @return The creditor reference
+     */
+    RFReference RFReference::createFromString(const std::string& string) {
+        std::string s = string;
+        trim(s);
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        if (!isStructureValid(s.data(), s.length())) {
+            throw RFParseException(string);
+        }
+        return RFReference(s.substr(2, 2), s.substr(4));
+    }
+
+    /**
+     * Creates a creditor reference with correct check digits from the
+     * reference of the creditor. Throws an \p RFParseException if the
+     * reference is empty, longer than 21 characters or not alphanumerical.
+     *
+     * @param reference The reference of the creditor
+     * @return The creditor reference
+     */
+    RFReference RFReference::generate(const std::string& reference) {
+        std::string s = reference;
+        trim(s);
+        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+        long digits = getCheckDigits("RF", s.data(), s.length());
+        if (s.empty() || s.length() + 4 > maxLength || digits < 0) {
+            throw RFParseException(reference);
+        }
+        return RFReference(std::string(1, static_cast<char>('0' + digits / 10)) +
+                           static_cast<char>('0' + digits % 10), s);
+    }
+
+    /**
+     * Returns the reference without prefix and check digits.
+     *
+     * @return The reference of the creditor
+     */
+    std::string RFReference::getReference() const {
+        return m_reference;
+    }
+
+    /**
+     * Returns the check digits of the reference.
+     *
+     * @return The check digits
+     */
+    std::string RFReference::getChecksum() const {
+        return m_checkSum;
+    }
+
+    /**
+     * Returns the reference in groups of four characters for easier reading.
+     *
+     * @return The human readable form of the reference
+     */
+    std::string RFReference::getHumanReadable() const {
+        std::string machine = getMachineForm();
+        std::string result;
+        for (size_t i = 0; i < machine.length(); i += 4) {
+            if (i > 0) {
+                result += ' ';
+            }
+            result += machine.substr(i, 4);
+        }
+        return result;
+    }
+
+    /**
+     * Returns the reference without any spaces.
+     *
+     * @return The machine form of the reference
+     */
+    std::string RFReference::getMachineForm() const {
+        return "RF" + m_checkSum + m_reference;
+    }
+
+    /**
+     * Validates the checksum of the reference.
+     *
+     * @return \p true if the reference is valid, \p false otherwise
+     */
+    bool RFReference::validate() const {
+        std::string machine = getMachineForm();
+        return validateString(machine.data(), machine.length());
+    }
+
+    /**
+     * Validates a creditor reference given as a character sequence without
+     * creating an instance of \p RFReference and without allocating memory.
+     * Whitespace is ignored and letters may be in either case.
+     *
+     * @param data Pointer to the first character of the reference
+     * @param length The number of characters
+     * @return \p true if the sequence is a valid reference, \p false otherwise
+     */
+    bool RFReference::validateString(const char* data, size_t length) {
+        char compact[maxLength];
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (std::isspace(static_cast<unsigned char>(data[i]))) {
+                continue;
+            }
+            if (count == maxLength) {
+                return false;
+            }
+            compact[count++] = data[i];
+        }
+        return isStructureValid(compact, count) &&
+               hasValidMod97Checksum(compact, count, 4);
+    }
+
+    /**
+     * Validates many creditor references stored in fixed width records
+     * without allocating memory. Whitespace inside a record is ignored, so
+     * shorter references may be padded with spaces.
+     *
+     * @param references Pointer to the first record
+     * @param recordLength The length of each record
+     * @param count The number of records
+     * @param results Output array receiving \p count results
+     * @return The number of valid references
+     */
+    size_t RFReference::validateBatch(const char* references,
+                                      size_t recordLength, size_t count,
+                                      bool* results) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++) {
+            results[i] = validateString(references + i * recordLength,
+                                        recordLength);
+            if (results[i]) {
+                valid++;
+            }
+        }
+        return valid;
+    }
+}
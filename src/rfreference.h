@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        rfreference.h
+ * \brief       Header file declaring ISO 11649 creditor references
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a class representing creditor references
+ * according to ISO 11649 (RF references). They use the same MOD 97-10
+ * checksum as IBANs.
+ */
+
+#ifndef LIBIBAN_RFREFERENCE_H
+#define LIBIBAN_RFREFERENCE_H
+
+#include <string>
+#include <ostream>
+#include <stdexcept>
+
+namespace IBAN {
+
+/// Exception to be thrown when parsing a creditor reference fails
+class RFParseException : public std::exception {
+
+private:
+    /// Holds the reference causing the error
+    std::string m_reference;
+    /// The exception message
+    std::string m_message;
+
+public:
+    RFParseException(const std::string& reference) noexcept;
+    virtual ~RFParseException();
+    virtual const char* what() const noexcept;
+
+    /// Copy constructor for \p RFParseException. Uses the default copy
+    /// constructor
+    RFParseException(const RFParseException& other)=default;
+};
+
+/// Creditor reference according to ISO 11649
+class RFReference {
+
+private:
+    /// Holds the check digits of the reference
+    std::string m_checkSum {};
+    /// Holds the reference without prefix and check digits
+    std::string m_reference {};
+    RFReference(const std::string& checkSum, const std::string& reference) :
+            m_checkSum(checkSum), m_reference(reference) {}
+
+public:
+    /// Maximum length of a creditor reference in machine form
+    static const size_t maxLength = 25;
+
+    /// Copy constructor for \p RFReference. Uses the default copy constructor
+    RFReference(const RFReference&)=default;
+    bool operator==(const RFReference& other) const;
+    bool operator!=(const RFReference& other) const;
+    static RFReference createFromString(const std::string& string);
+    static RFReference generate(const std::string& reference);
+    std::string getReference() const;
+    std::string getChecksum() const;
+    std::string getHumanReadable() const;
+    std::string getMachineForm() const;
+    bool validate() const;
+    static bool validateString(const char* data, size_t length);
+    static size_t validateBatch(const char* references, size_t recordLength,
+                                size_t count, bool* results);
+
+}; // end of class RFReference
+
+/**
+ * Overloads the comparison operator ==.
+ *
+ * @param other The object to compare with
+ * @return \p true if both objects are equal, \p false otherwise
+ */
+inline bool RFReference::operator==(const RFReference& other) const {
+    return m_checkSum == other.m_checkSum && m_reference == other.m_reference;
+}
+
+/**
+ * Overloads the comparison operator !=.
+ *
+ * @param other The object to compare with
+ * @return \p true if the objects are not equal, \p false if they are equal
+ */
+inline bool RFReference::operator!=(const RFReference& other) const {
+    return !(*this == other);
+}
+
+/**
+ * Overrides the stream operator << for RFReference.
+ *
+ * @param stream The stream to write to
+ * @param elem The element to write to the stream
+ * @return The stream written to
+ */
+inline std::ostream& operator<<(std::ostream& stream, const RFReference& elem) {
+    stream << "RFReference (" << elem.getHumanReadable() << ")";
+    return stream;
+}
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_RFREFERENCE_H
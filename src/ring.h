@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        ring.h
+ * \brief       Header file defining bounded lock-free ring buffers
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file defines bounded lock-free ring buffers connecting the
+ * threads of a pipeline: one for a single producer and a single consumer and
+ * one for any number of producers and consumers.
+ */
+
+#ifndef LIBIBAN_RING_H
+#define LIBIBAN_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace IBAN {
+
+/// Assumed size of a cache line; indices written by different threads are
+/// padded to lie on separate lines
+static const size_t cacheLineSize = 64;
+
+/**
+ * Rounds a capacity up to the next power of two (at least 2), so positions
+ * can be mapped to slots with a mask.
+ *
+ * @param capacity The requested capacity
+ * @return The rounded capacity
+ */
+inline size_t getRingCapacity(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+/// Bounded lock-free ring buffer for a single producer and a single consumer
+template<typename T>
+class SPSCRing {
+
+private:
+    /// The slots
+    std::vector<T> m_slots;
+    /// Mask mapping positions to slots
+    size_t m_mask;
+    /// Keeps the indices off the cache line of the other members
+    char m_padding[cacheLineSize];
+    /// Position of the next element to pop; written by the consumer
+    std::atomic<size_t> m_head;
+    /// Keeps the indices on separate cache lines
+    char m_headPadding[cacheLineSize - sizeof(std::atomic<size_t>)];
+    /// Position of the next element to push; written by the producer
+    std::atomic<size_t> m_tail;
+
+public:
+    /**
+     * Constructor of \p SPSCRing.
+     *
+     * @param capacity The minimum number of elements the ring can hold
+     */
+    explicit SPSCRing(size_t capacity) :
+            m_slots(getRingCapacity(capacity)), m_mask(m_slots.size() - 1),
+            m_head(0), m_tail(0) {}
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    /**
+     * Appends an element unless the ring is full. Must only be called by the
+     * producer.
+     *
+     * @param value The element
+     * @return \p false if the ring is full
+     */
+    bool tryPush(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+            return false;
+        }
+        m_slots[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest element unless the ring is empty. Must only be
+     * called by the consumer.
+     *
+     * @param value Receives the element
+     * @return \p false if the ring is empty
+     */
+    bool tryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+}; // end of class SPSCRing
+
+/// Bounded lock-free ring buffer for multiple producers and consumers; every
+/// slot carries a sequence number telling whose turn it is
+template<typename T>
+class MPMCRing {
+
+private:
+    /// A slot with its sequence number
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    /// The slots
+    std::vector<Slot> m_slots;
+    /// Mask mapping positions to slots
+    size_t m_mask;
+    /// Keeps the indices off the cache line of the other members
+    char m_padding[cacheLineSize];
+    /// Position of the next element to pop
+    std::atomic<size_t> m_head;
+    /// Keeps the indices on separate cache lines
+    char m_headPadding[cacheLineSize - sizeof(std::atomic<size_t>)];
+    /// Position of the next element to push
+    std::atomic<size_t> m_tail;
+
+public:
+    /**
+     * Constructor of \p MPMCRing.
+     *
+     * @param capacity The minimum number of elements the ring can hold
+     */
+    explicit MPMCRing(size_t capacity) :
+            m_slots(getRingCapacity(capacity)), m_mask(m_slots.size() - 1),
+            m_head(0), m_tail(0) {
+        for (size_t i = 0; i < m_slots.size(); i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCRing(const MPMCRing&) = delete;
+    MPMCRing& operator=(const MPMCRing&) = delete;
+
+    /**
+     * Appends an element unless the ring is full.
+     *
+     * @param value The element
+     * @return \p false if the ring is full
+     */
+    bool tryPush(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[tail & m_mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == tail) {
+                if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                                 std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < tail) {
+                return false;
+            } else {
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Removes the oldest element unless the ring is empty.
+     *
+     * @param value Receives the element
+     * @return \p false if the ring is empty
+     */
+    bool tryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[head & m_mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == head + 1) {
+                if (m_head.compare_exchange_weak(head, head + 1,
+                                                 std::memory_order_relaxed)) {
+                    value = slot.value;
+                    slot.sequence.store(head + m_slots.size(),
+                                        std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < head + 1) {
+                return false;
+            } else {
+                head = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+}; // end of class MPMCRing
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_RING_H
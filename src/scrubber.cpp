@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        scrubber.cpp
+ * \brief       Source file implementing the streaming IBAN scrubber
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p Scrubber which masks valid IBANs
+ * in arbitrary text streams.
+ */
+
+#include "scrubber.h"
+#include "libiban.h"
+#include "utils.h"
+
+namespace IBAN {
+
+    /// Returned by \p matchAt() if the block ends before a decision is possible
+    static const size_t incomplete = static_cast<size_t>(-1);
+
+    /**
+     * Constructor of \p Scrubber.
+     *
+     * @param keepLeading Number of leading IBAN characters to leave unmasked
+     * @param keepTrailing Number of trailing IBAN characters to leave unmasked
+     * @param maskChar The character to replace masked characters with
+     */
+    Scrubber::Scrubber(size_t keepLeading, size_t keepTrailing, char maskChar) :
+            m_keepLeading(keepLeading), m_keepTrailing(keepTrailing),
+            m_maskChar(maskChar), m_previous('\0'), m_masked(0) {}
+
+    /**
+     * Masks all checksum-valid IBANs inside a block of text in place. IBANs
+     * may be given in machine form or in human readable form (groups of four
+     * separated by single spaces). Masked characters are replaced one by one,
+     * so the length of the block never changes.
+     *
+     * An IBAN may be split across two blocks. Therefore, unless \p final is
+     * set, the function may stop before the end of the block and return the
+     * number of bytes that are completely processed. The caller must write
+     * these bytes and prepend the remaining ones (at most \p maxCarry bytes)
+     * to the next block.
+     *
+     * @param data The block of text to scrub
+     * @param length The length of the block
+     * @param final \p true if this is the last block of the stream
+     * @return Number of bytes at the beginning of the block that are final
+     */
+    size_t Scrubber::scrub(char* data, size_t length, bool final) {
+        size_t i = 0;
+        bool afterWord = getCharValue(m_previous) >= 0;
+        while (i < length) {
+            // every IBAN starts with a letter of the country code at the
+            // beginning of a word
+            int value = getCharValue(data[i]);
+            if (afterWord || value < 10) {
+                afterWord = value >= 0;
+                i++;
+                continue;
+            }
+            size_t end = matchAt(data, length, i, final);
+            if (end == incomplete) {
+                if (i > 0) {
+                    m_previous = data[i - 1];
+                }
+                return i;
+            }
+            if (end != 0) {
+                mask(data, i, end);
+                m_masked++;
+                i = end;
+                afterWord = false;
+            } else {
+                afterWord = true;
+                i++;
+            }
+        }
+        if (length > 0) {
+            m_previous = data[length - 1];
+        }
+        return length;
+    }
+
+    /**
+     * Returns the number of IBANs masked by this instance so far.
+     *
+     * @return The number of masked IBANs
+     */
+    size_t Scrubber::getMaskedCount() const {
+        return m_masked;
+    }
+
+    /**
+     * Checks whether a valid IBAN starts at a given position of a block.
+     *
+     * @param data The block of text
+     * @param length The length of the block
+     * @param start The position to check
+     * @param final \p true if the block is the last one of the stream
+     * @return The end of the IBAN, 0 if there is none or \p incomplete if the
+     *         block ends before this can be decided
+     */
+    size_t Scrubber::matchAt(const char* data, size_t length, size_t start,
+                             bool final) const {
+        char before = start == 0 ? m_previous : data[start - 1];
+        if (getCharValue(before) >= 0) {
+            return 0;
+        }
+
+        char compact[34];
+        size_t count = 0, expected = sizeof(compact), pos = start;
+        bool afterSpace = false;
+        while (count < expected) {
+            if (pos == length) {
+                return final ? 0 : incomplete;
+            }
+            char ch = data[pos++];
+            if (ch == ' ' && !afterSpace && count > 0 && count % 4 == 0) {
+                afterSpace = true;
+                continue;
+            }
+            int value = getCharValue(ch);
+            if (value < 0 || (count < 2 && value < 10) ||
+                    (count >= 2 && count < 4 && value >= 10)) {
+                return 0;
+            }
+            afterSpace = false;
+            compact[count++] = ch;
+            if (count == 2) {
+                expected = IBAN::getLengthForCountry(compact[0], compact[1]);
+                if (expected == 0) {
+                    return 0;
+                }
+            }
+        }
+
+        // the IBAN must not be followed by further alphanumerical characters
+        if (pos == length) {
+            if (!final) {
+                return incomplete;
+            }
+        } else if (getCharValue(data[pos]) >= 0) {
+            return 0;
+        }
+        return getIBANRemainder(compact, count) == 1 ? pos : 0;
+    }
+
+    /**
+     * Masks the alphanumerical characters of an IBAN except the configured
+     * number of leading and trailing characters.
+     *
+     * @param data The block of text
+     * @param start The position of the first character of the IBAN
+     * @param end The position after the last character of the IBAN
+     */
+    void Scrubber::mask(char* data, size_t start, size_t end) const {
+        size_t total = 0;
+        for (size_t i = start; i < end; i++) {
+            if (data[i] != ' ') {
+                total++;
+            }
+        }
+        size_t index = 0;
+        for (size_t i = start; i < end; i++) {
+            if (data[i] == ' ') {
+                continue;
+            }
+            if (index >= m_keepLeading && index + m_keepTrailing < total) {
+                data[i] = m_maskChar;
+            }
+            index++;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        scrubber.h
+ * \brief       Header file declaring the streaming IBAN scrubber
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a class that masks valid IBANs in arbitrary text
+ * streams, for example log files.
+ */
+
+#ifndef LIBIBAN_SCRUBBER_H
+#define LIBIBAN_SCRUBBER_H
+
+#include <cstddef>
+
+namespace IBAN {
+
+/// Masks checksum-valid IBANs in blocks of text in place
+class Scrubber {
+
+private:
+    /// Number of leading IBAN characters left unmasked
+    size_t m_keepLeading;
+    /// Number of trailing IBAN characters left unmasked
+    size_t m_keepTrailing;
+    /// Character used for masking
+    char m_maskChar;
+    /// Last character before the start of the current block
+    char m_previous;
+    /// Number of IBANs masked so far
+    size_t m_masked;
+
+    size_t matchAt(const char* data, size_t length, size_t start,
+                   bool final) const;
+    void mask(char* data, size_t start, size_t end) const;
+
+public:
+    /// Maximum number of bytes \p scrub() leaves unprocessed at the end of a
+    /// block: 34 characters plus 8 separating spaces plus one look-ahead
+    static const size_t maxCarry = 43;
+
+    Scrubber(size_t keepLeading = 2, size_t keepTrailing = 4,
+             char maskChar = '*');
+    size_t scrub(char* data, size_t length, bool final);
+    size_t getMaskedCount() const;
+
+}; // end of class Scrubber
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_SCRUBBER_H
@@ -0,0 +1,512 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        sharedmemory.cpp
+ * \brief       Source file implementing the shared memory validation transport
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the classes \p SharedMemoryServer and
+ * \p SharedMemoryClient. The ring is used by a single client and a single
+ * server: the client publishes the number of submitted requests, the server
+ * the number of answered ones, each in a word of its own cache line. A side
+ * waiting for the other spins for a while and then sleeps on the word with a
+ * futex (polling on systems without futexes). A side publishing a new count
+ * only makes a system call if the other side announced that it sleeps.
+ * The ring stores the process id of its client, so a client that died
+ * without detaching is replaced by the next one.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+#include "sharedmemory.h"
+#include "ring.h"
+
+namespace IBAN {
+
+    /// Identifies an initialized ring
+    static const uint32_t ringMagic = 0x4e414249;
+    /// Version of the layout of the ring
+    static const uint32_t ringVersion = 2;
+    /// Number of checks of a word before going to sleep
+    static const int spinCount = 4000;
+
+    /**
+     * Returns the number of checks of a word before going to sleep. On a
+     * single hardware thread, spinning only delays the other side.
+     *
+     * @return The number of checks
+     */
+    static int getSpinCount() {
+        static const int count = std::thread::hardware_concurrency() > 1 ? spinCount : 0;
+        return count;
+    }
+
+    /// Start of the shared memory object, followed by the slots
+    struct SharedMemoryHeader {
+        /// \p ringMagic once the server has initialized the ring
+        std::atomic<uint32_t> magic;
+        /// \p ringVersion
+        uint32_t version;
+        /// The number of slots
+        uint32_t slots;
+        /// The process id of the attached client or 0
+        std::atomic<uint32_t> owner;
+        char headerPadding[cacheLineSize - 4 * sizeof(uint32_t)];
+        /// Number of requests submitted, written by the client
+        std::atomic<uint32_t> requests;
+        /// Whether the server sleeps on \p requests
+        std::atomic<uint32_t> serverWaiting;
+        char requestPadding[cacheLineSize - 2 * sizeof(uint32_t)];
+        /// Number of requests answered, written by the server
+        std::atomic<uint32_t> responses;
+        /// Whether the client sleeps on \p responses
+        std::atomic<uint32_t> clientWaiting;
+        char responsePadding[cacheLineSize - 2 * sizeof(uint32_t)];
+    };
+
+    /**
+     * Sleeps until a word may have changed or the timeout expires. Spurious
+     * wake-ups are possible.
+     *
+     * @param word The word
+     * @param seen The value of the word before going to sleep
+     * @param timeout Maximum time to sleep in microseconds; -1 for no limit
+     */
+    static void sleepOn(std::atomic<uint32_t>& word, uint32_t seen, long timeout) {
+#if defined(__linux__)
+        timespec limit;
+        limit.tv_sec = timeout / 1000000;
+        limit.tv_nsec = timeout % 1000000 * 1000;
+        // the object is shared between processes, so no private futex
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, seen,
+                timeout < 0 ? nullptr : &limit, nullptr, 0);
+#else
+        (void) word;
+        (void) seen;
+        std::this_thread::sleep_for(std::chrono::microseconds(
+                timeout < 0 ? 50 : std::min(timeout, 50L)));
+#endif
+    }
+
+    /**
+     * Wakes the process sleeping on a word.
+     *
+     * @param word The word
+     */
+    static void wakeUp(std::atomic<uint32_t>& word) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1,
+                nullptr, nullptr, 0);
+#else
+        (void) word;
+#endif
+    }
+
+    /**
+     * Waits until a counter differs from a given value.
+     *
+     * @param word The counter
+     * @param waiting The flag announcing that the caller sleeps on \p word
+     * @param seen The value to wait to change
+     * @param timeoutMs Maximum time to wait in milliseconds; -1 for no limit
+     * @return \p true if the counter changed
+     */
+    static bool awaitChange(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting,
+                            uint32_t seen, int timeoutMs) {
+        for (int i = getSpinCount(); i > 0; i--) {
+            if (word.load(std::memory_order_acquire) != seen) {
+                return true;
+            }
+        }
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(timeoutMs);
+        // the flag is set before the counter is checked again, and the
+        // publisher sets the counter before checking the flag, so one of
+        // both sees the other
+        waiting.store(1);
+        bool changed;
+        while (!(changed = word.load() != seen)) {
+            long timeout = -1;
+            if (timeoutMs >= 0) {
+                timeout = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+                        deadline - std::chrono::steady_clock::now()).count());
+                if (timeout <= 0) {
+                    break;
+                }
+            }
+            sleepOn(word, seen, timeout);
+        }
+        waiting.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return changed;
+    }
+
+    /**
+     * Publishes a new value of a counter and wakes the other side if it
+     * sleeps on it.
+     *
+     * @param word The counter
+     * @param waiting The flag announcing that the other side sleeps
+     * @param value The new value
+     */
+    static void publish(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting,
+                        uint32_t value) {
+        word.store(value);
+        if (waiting.load() != 0) {
+            wakeUp(word);
+        }
+    }
+
+    /**
+     * Checks whether a process is still running. Process ids are only
+     * meaningful within a PID namespace, so client and server must share
+     * one.
+     *
+     * @param pid The process id
+     * @return \p false if the process does not exist
+     */
+    static bool isRunning(uint32_t pid) {
+        return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+    }
+
+    /**
+     * Returns the length of a ring with a given number of slots.
+     *
+     * @param slots The number of slots
+     * @return The length in bytes
+     */
+    static size_t getRingLength(size_t slots) {
+        return sizeof(SharedMemoryHeader) + slots * sizeof(SharedMemorySlot);
+    }
+
+    /**
+     * Constructor of \p SharedMemoryServer. Creates the shared memory object,
+     * replacing a stale one of the same name. Throws a
+     * \p std::invalid_argument if \p slots is not a power of two and a
+     * \p std::runtime_error if the object cannot be created.
+     *
+     * @param name The name of the object, for example "/iband"
+     * @param slots The number of slots, a power of two (default: 64)
+     */
+    SharedMemoryServer::SharedMemoryServer(const std::string& name, size_t slots) :
+            m_name(name), m_memory(nullptr), m_length(getRingLength(slots)),
+            m_header(nullptr), m_slots(nullptr),
+            m_slotCount(static_cast<uint32_t>(slots)), m_processed(0) {
+        // the counters wrap around, which keeps the slot index consistent
+        // only if the number of slots divides 2^32
+        if (slots == 0 || slots > (1u << 16) || (slots & (slots - 1)) != 0) {
+            throw std::invalid_argument("Number of slots must be a power of two");
+        }
+        ::shm_unlink(name.c_str());
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create shared memory object " + name);
+        }
+        void* mapping = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(m_length)) == 0) {
+            mapping = ::mmap(nullptr, m_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot map shared memory object " + name);
+        }
+
+        // the object is zero-filled, so only the constants need to be set
+        m_memory = mapping;
+        m_header = new (m_memory) SharedMemoryHeader;
+        m_header->version = ringVersion;
+        m_header->slots = m_slotCount;
+        m_header->owner.store(0);
+        m_header->requests.store(0);
+        m_header->serverWaiting.store(0);
+        m_header->responses.store(0);
+        m_header->clientWaiting.store(0);
+        m_slots = reinterpret_cast<SharedMemorySlot*>(
+                static_cast<char*>(m_memory) + sizeof(SharedMemoryHeader));
+        m_header->magic.store(ringMagic, std::memory_order_release);
+    }
+
+    /**
+     * Destructor of \p SharedMemoryServer. Unmaps and removes the shared
+     * memory object; an attached client keeps its mapping.
+     */
+    SharedMemoryServer::~SharedMemoryServer() {
+        ::munmap(m_memory, m_length);
+        ::shm_unlink(m_name.c_str());
+    }
+
+    /**
+     * Waits until the client has submitted requests that are not answered
+     * yet.
+     *
+     * @param timeoutMs Maximum time to wait in milliseconds; -1 for no limit
+     * @return \p true if there are requests to answer
+     */
+    bool SharedMemoryServer::wait(int timeoutMs) {
+        return awaitChange(m_header->requests, m_header->serverWaiting,
+                           m_processed, timeoutMs);
+    }
+
+    /**
+     * Answers all submitted requests in order. The result codes are written
+     * into the slots of the requests.
+     *
+     * @return The number of answered requests
+     */
+    size_t SharedMemoryServer::poll() {
+        uint32_t requests = m_header->requests.load(std::memory_order_acquire);
+        size_t answered = 0;
+        while (m_processed != requests) {
+            SharedMemorySlot& slot = m_slots[m_processed & (m_slotCount - 1)];
+            // the slot is written by another process, so nothing is trusted
+            size_t count = std::min<size_t>(slot.count, slotCapacity);
+            bool checkNational = (slot.flags & 1) != 0;
+            for (size_t i = 0; i < count; i++) {
+                slot.codes[i] = slot.lengths[i] > sizeof(slot.ibans[i])
+                        ? ValidationCode::Malformed
+                        : validateEntry(slot.ibans[i], slot.lengths[i], checkNational);
+            }
+            publish(m_header->responses, m_header->clientWaiting, ++m_processed);
+            answered++;
+        }
+        return answered;
+    }
+
+    /**
+     * Constructor of \p SharedMemoryClient. Maps the shared memory object of
+     * a running server. The ring is taken over if its client terminated
+     * without detaching; requests it left behind are answered by the server
+     * within a second before the ring is used. Throws a
+     * \p std::runtime_error if the object cannot be mapped, is not
+     * initialized, has a running client or the server does not answer.
+     *
+     * @param name The name of the object
+     */
+    SharedMemoryClient::SharedMemoryClient(const std::string& name) :
+            m_memory(nullptr), m_length(0), m_header(nullptr), m_slots(nullptr),
+            m_slotCount(0), m_submitted(0), m_received(0) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open shared memory object " + name);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 ||
+                static_cast<size_t>(info.st_size) < sizeof(SharedMemoryHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid shared memory object " + name);
+        }
+        m_length = static_cast<size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, m_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map shared memory object " + name);
+        }
+
+        m_memory = mapping;
+        m_header = static_cast<SharedMemoryHeader*>(m_memory);
+        m_slotCount = m_header->slots;
+        if (m_header->magic.load(std::memory_order_acquire) != ringMagic ||
+                m_header->version != ringVersion || m_slotCount == 0 ||
+                (m_slotCount & (m_slotCount - 1)) != 0 ||
+                getRingLength(m_slotCount) > m_length) {
+            ::munmap(m_memory, m_length);
+            throw std::runtime_error("Invalid shared memory object " + name);
+        }
+        uint32_t pid = static_cast<uint32_t>(::getpid());
+        uint32_t owner = 0;
+        // a failed exchange loads the current owner, which is replaced by
+        // the next attempt if it no longer runs
+        while (!m_header->owner.compare_exchange_strong(owner, pid)) {
+            if (isRunning(owner)) {
+                ::munmap(m_memory, m_length);
+                throw std::runtime_error("Shared memory object " + name + " already has a client");
+            }
+        }
+
+        // wait until the requests of a previous client are answered
+        m_submitted = m_header->requests.load(std::memory_order_acquire);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        uint32_t responses;
+        while ((responses = m_header->responses.load(std::memory_order_acquire)) != m_submitted) {
+            int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count());
+            if (timeout <= 0) {
+                m_header->owner.store(0);
+                ::munmap(m_memory, m_length);
+                throw std::runtime_error("Shared memory object " + name + " is not served");
+            }
+            awaitChange(m_header->responses, m_header->clientWaiting, responses, timeout);
+        }
+        m_slots = reinterpret_cast<SharedMemorySlot*>(
+                static_cast<char*>(m_memory) + sizeof(SharedMemoryHeader));
+        m_received = m_submitted;
+    }
+
+    /**
+     * Destructor of \p SharedMemoryClient. Waits up to a second for pending
+     * responses, so that the next client starts with an idle ring, and
+     * detaches.
+     */
+    SharedMemoryClient::~SharedMemoryClient() {
+        while (getPendingCount() > 0 && peek(1000) != nullptr) {
+            release();
+        }
+        m_header->owner.store(0);
+        ::munmap(m_memory, m_length);
+    }
+
+    /**
+     * Returns the next free slot to write a request into, without copying.
+     * The slot is submitted by \p commit().
+     *
+     * @return The slot or \p nullptr if all slots hold requests or responses
+     *         that were not released yet
+     */
+    SharedMemorySlot* SharedMemoryClient::acquire() {
+        if (m_submitted - m_received == m_slotCount) {
+            return nullptr;
+        }
+        return &m_slots[m_submitted & (m_slotCount - 1)];
+    }
+
+    /**
+     * Submits the slot returned by the last call of \p acquire(). Only
+     * makes a system call if the server sleeps.
+     */
+    void SharedMemoryClient::commit() {
+        publish(m_header->requests, m_header->serverWaiting, ++m_submitted);
+    }
+
+    /**
+     * Waits for the response to the oldest request that was not released
+     * yet. Responses arrive in the order of the requests.
+     *
+     * @param timeoutMs Maximum time to wait in milliseconds; -1 for no limit
+     *        (default: -1)
+     * @return The slot holding the response or \p nullptr if no request is
+     *         pending or the timeout expired
+     */
+    const SharedMemorySlot* SharedMemoryClient::peek(int timeoutMs) {
+        if (m_received == m_submitted ||
+                !awaitChange(m_header->responses, m_header->clientWaiting,
+                             m_received, timeoutMs)) {
+            return nullptr;
+        }
+        return &m_slots[m_received & (m_slotCount - 1)];
+    }
+
+    /**
+     * Releases the slot returned by the last call of \p peek() for reuse.
+     */
+    void SharedMemoryClient::release() {
+        m_received++;
+    }
+
+    /**
+     * Copies a batch of IBANs into a free slot and submits it. Whitespace is
+     * removed; IBANs longer than 34 characters are answered with
+     * \p ValidationCode::Malformed. Throws a \p std::invalid_argument if the
+     * batch exceeds \p slotCapacity.
+     *
+     * @param ibans The IBANs
+     * @param checkNational Whether national check digits are checked
+     *        (default: \p false)
+     * @return \p false if no slot is free; responses need to be received
+     */
+    bool SharedMemoryClient::submit(const std::vector<std::string>& ibans,
+                                    bool checkNational) {
+        if (ibans.size() > slotCapacity) {
+            throw std::invalid_argument("Too many IBANs for a slot");
+        }
+        SharedMemorySlot* slot = acquire();
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->count = static_cast<uint32_t>(ibans.size());
+        slot->flags = checkNational ? 1 : 0;
+        for (size_t i = 0; i < ibans.size(); i++) {
+            size_t length = 0;
+            for (char ch : ibans[i]) {
+                if (std::isspace(static_cast<unsigned char>(ch))) {
+                    continue;
+                }
+                if (length == sizeof(slot->ibans[i])) {
+                    length = 0xff;
+                    break;
+                }
+                slot->ibans[i][length++] = ch;
+            }
+            slot->lengths[i] = static_cast<unsigned char>(length);
+        }
+        commit();
+        return true;
+    }
+
+    /**
+     * Waits for the response to the oldest pending request and releases its
+     * slot.
+     *
+     * @param codes Receives the result codes
+     * @param timeoutMs Maximum time to wait in milliseconds; -1 for no limit
+     *        (default: -1)
+     * @return \p false if no request is pending or the timeout expired
+     */
+    bool SharedMemoryClient::receive(std::vector<ValidationCode>& codes, int timeoutMs) {
+        const SharedMemorySlot* slot = peek(timeoutMs);
+        if (slot == nullptr) {
+            return false;
+        }
+        codes.assign(slot->codes, slot->codes + std::min<size_t>(slot->count, slotCapacity));
+        release();
+        return true;
+    }
+
+    /**
+     * Returns the number of requests whose slots were not released yet.
+     *
+     * @return The number of pending requests
+     */
+    size_t SharedMemoryClient::getPendingCount() const {
+        return m_submitted - m_received;
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        sharedmemory.h
+ * \brief       Header file declaring the shared memory validation transport
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a transport for validation requests between
+ * processes on the same host. The server creates a POSIX shared memory
+ * object holding a ring of slots; a client writes a batch of IBANs into a
+ * slot, the server writes the result codes into the same slot. Both sides
+ * spin briefly before sleeping on a futex, so no system call is made while
+ * the other side keeps up.
+ */
+
+#ifndef LIBIBAN_SHAREDMEMORY_H
+#define LIBIBAN_SHAREDMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "protocol.h"
+
+namespace IBAN {
+
+/// Maximum number of IBANs in a slot
+static const size_t slotCapacity = 64;
+
+/// Request and response of a batch, shared between client and server
+struct SharedMemorySlot {
+    /// The number of IBANs
+    uint32_t count;
+    /// Bit 0: check national check digits
+    uint32_t flags;
+    /// The lengths of the IBANs
+    unsigned char lengths[slotCapacity];
+    /// The IBANs in machine form
+    char ibans[slotCapacity][34];
+    /// The result codes, written by the server
+    ValidationCode codes[slotCapacity];
+};
+
+struct SharedMemoryHeader;
+
+/// Validates the batches written into a shared memory ring by a client
+class SharedMemoryServer {
+
+private:
+    /// The name of the shared memory object
+    std::string m_name;
+    /// The mapping
+    void* m_memory;
+    /// The length of the mapping
+    size_t m_length;
+    /// The header at the beginning of the mapping
+    SharedMemoryHeader* m_header;
+    /// The slots following the header
+    SharedMemorySlot* m_slots;
+    /// The number of slots
+    uint32_t m_slotCount;
+    /// Number of requests answered
+    uint32_t m_processed;
+
+public:
+    SharedMemoryServer(const std::string& name, size_t slots = 64);
+    ~SharedMemoryServer();
+    SharedMemoryServer(const SharedMemoryServer&) = delete;
+    SharedMemoryServer& operator=(const SharedMemoryServer&) = delete;
+
+    bool wait(int timeoutMs);
+    size_t poll();
+
+}; // end of class SharedMemoryServer
+
+/// Submits batches to a \p SharedMemoryServer of another process
+class SharedMemoryClient {
+
+private:
+    /// The mapping
+    void* m_memory;
+    /// The length of the mapping
+    size_t m_length;
+    /// The header at the beginning of the mapping
+    SharedMemoryHeader* m_header;
+    /// The slots following the header
+    SharedMemorySlot* m_slots;
+    /// The number of slots
+    uint32_t m_slotCount;
+    /// Number of requests submitted
+    uint32_t m_submitted;
+    /// Number of responses released
+    uint32_t m_received;
+
+public:
+    explicit SharedMemoryClient(const std::string& name);
+    ~SharedMemoryClient();
+    SharedMemoryClient(const SharedMemoryClient&) = delete;
+    SharedMemoryClient& operator=(const SharedMemoryClient&) = delete;
+
+    SharedMemorySlot* acquire();
+    void commit();
+    const SharedMemorySlot* peek(int timeoutMs = -1);
+    void release();
+
+    bool submit(const std::vector<std::string>& ibans, bool checkNational = false);
+    bool receive(std::vector<ValidationCode>& codes, int timeoutMs = -1);
+    size_t getPendingCount() const;
+
+}; // end of class SharedMemoryClient
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_SHAREDMEMORY_H
@@ -0,0 +1,308 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        threadpool.cpp
+ * \brief       Source file implementing the work-stealing thread pool
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file implements the class \p ThreadPool. The range of every
+ * worker is protected by a lock of its own, which the owner takes once per
+ * chunk and thieves only when the owner's range is not yet exhausted.
+ */
+
+#include <algorithm>
+#include <chrono>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "threadpool.h"
+
+namespace IBAN {
+
+    /// Clock used for the statistics
+    typedef std::chrono::steady_clock Clock;
+
+    /// State of a worker thread
+    struct ThreadPool::Worker {
+        /// Protects \p begin and \p end
+        std::mutex mutex;
+        /// Start of the remaining range of the worker
+        size_t begin;
+        /// End of the remaining range of the worker
+        size_t end;
+        /// Statistics, written by the worker only while a job is running
+        WorkerStats stats;
+
+        Worker() : begin(0), end(0), stats{0, 0, 0, 0.0, 0.0} {}
+    };
+
+    /**
+     * Constructor of \p ThreadPool.
+     *
+     * @param threads Number of worker threads (default: 0, the number of
+     *        hardware threads)
+     */
+    ThreadPool::ThreadPool(unsigned threads) :
+            m_function(nullptr), m_grain(1), m_generation(0), m_active(0),
+            m_stop(false), m_elapsed(0.0) {
+        start(ThreadPoolConfig{threads, {}});
+    }
+
+    /**
+     * Constructor of \p ThreadPool with an explicit configuration of the
+     * number of threads and their CPU affinity. Pinning is only supported on
+     * Linux and silently skipped elsewhere.
+     *
+     * @param config The configuration
+     */
+    ThreadPool::ThreadPool(const ThreadPoolConfig& config) :
+            m_function(nullptr), m_grain(1), m_generation(0), m_active(0),
+            m_stop(false), m_elapsed(0.0) {
+        start(config);
+    }
+
+    /**
+     * Destructor of \p ThreadPool. Stops and joins the worker threads.
+     */
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Creates the worker threads.
+     *
+     * @param config The configuration
+     */
+    void ThreadPool::start(const ThreadPoolConfig& config) {
+        unsigned threads = config.threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            m_workers.emplace_back(new Worker());
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            int cpu = config.cpus.empty() ? -1 : config.cpus[i % config.cpus.size()];
+            m_threads.emplace_back(&ThreadPool::work, this, i, cpu);
+        }
+    }
+
+    /**
+     * Calls \p function for chunks of at most \p grain indices covering 0 to
+     * \p count - 1 on the worker threads and waits until all chunks are
+     * processed. The first exception thrown by \p function is rethrown
+     * after all workers have stopped. Concurrent callers are served one job
+     * after the other. Must not be called from within a function running
+     * on the same pool.
+     *
+     * @param count The number of indices
+     * @param grain The maximum number of indices per chunk (at least 1)
+     * @param function The function processing a chunk
+     */
+    void ThreadPool::parallelFor(size_t count, size_t grain,
+                                 const RangeFunction& function) {
+        if (count == 0) {
+            return;
+        }
+        // the worker ranges and the job state below belong to one job
+        std::lock_guard<std::mutex> jobLock(m_jobMutex);
+        Clock::time_point started = Clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const size_t workers = m_workers.size();
+        for (size_t i = 0; i < workers; i++) {
+            std::lock_guard<std::mutex> rangeLock(m_workers[i]->mutex);
+            m_workers[i]->begin = count / workers * i + std::min(i, count % workers);
+            m_workers[i]->end = count / workers * (i + 1) + std::min(i + 1, count % workers);
+        }
+        m_function = &function;
+        m_grain = std::max<size_t>(1, grain);
+        m_error = nullptr;
+        m_active = workers;
+        m_generation++;
+        m_wake.notify_all();
+        m_done.wait(lock, [this]() { return m_active == 0; });
+        m_function = nullptr;
+        m_elapsed += std::chrono::duration<double>(Clock::now() - started).count();
+        if (m_error) {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Takes the next chunk from the front of the range of a worker.
+     *
+     * @param index The index of the worker
+     * @param begin Receives the start of the chunk
+     * @param end Receives the end of the chunk
+     * @return \p false if the range is exhausted
+     */
+    bool ThreadPool::takeChunk(size_t index, size_t& begin, size_t& end) {
+        Worker& worker = *m_workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.begin >= worker.end) {
+            return false;
+        }
+        begin = worker.begin;
+        end = std::min(worker.end, begin + m_grain);
+        worker.begin = end;
+        return true;
+    }
+
+    /**
+     * Moves the back half of the remaining range of another worker to a
+     * worker whose range is exhausted. Victims are tried in order starting
+     * after the thief.
+     *
+     * @param index The index of the thief
+     * @return \p false if no other worker has any work left
+     */
+    bool ThreadPool::steal(size_t index) {
+        const size_t workers = m_workers.size();
+        Worker& thief = *m_workers[index];
+        for (size_t i = 1; i < workers; i++) {
+            Worker& victim = *m_workers[(index + i) % workers];
+            std::unique_lock<std::mutex> thiefLock(thief.mutex, std::defer_lock);
+            std::unique_lock<std::mutex> victimLock(victim.mutex, std::defer_lock);
+            std::lock(thiefLock, victimLock);
+            if (victim.begin >= victim.end) {
+                continue;
+            }
+            size_t middle = victim.begin + (victim.end - victim.begin) / 2;
+            if (victim.end - victim.begin <= m_grain) {
+                // a remainder of a single chunk is taken as a whole
+                middle = victim.begin;
+            }
+            thief.begin = middle;
+            thief.end = victim.end;
+            victim.end = middle;
+            thief.stats.steals++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Main loop of a worker thread.
+     *
+     * @param index The index of the worker
+     * @param cpu The CPU to pin the thread to or -1
+     */
+    void ThreadPool::work(size_t index, int cpu) {
+#if defined(__linux__)
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#else
+        (void) cpu;
+#endif
+        Worker& worker = *m_workers[index];
+        size_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+                if (m_stop) {
+                    return;
+                }
+                generation = m_generation;
+            }
+
+            size_t begin, end;
+            while (takeChunk(index, begin, end) || (steal(index) && takeChunk(index, begin, end))) {
+                Clock::time_point started = Clock::now();
+                try {
+                    (*m_function)(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error) {
+                        m_error = std::current_exception();
+                    }
+                }
+                worker.stats.busySeconds +=
+                        std::chrono::duration<double>(Clock::now() - started).count();
+                worker.stats.chunks++;
+                worker.stats.items += end - begin;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Returns the number of worker threads.
+     *
+     * @return The number of worker threads
+     */
+    size_t ThreadPool::getThreadCount() const {
+        return m_workers.size();
+    }
+
+    /**
+     * Returns the statistics of the workers. Must not be called while
+     * \p parallelFor() is running.
+     *
+     * @return One entry per worker
+     */
+    std::vector<WorkerStats> ThreadPool::getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<WorkerStats> stats;
+        for (auto& worker : m_workers) {
+            WorkerStats entry = worker->stats;
+            entry.utilization = m_elapsed > 0.0 ?
+                    std::min(1.0, entry.busySeconds / m_elapsed) : 0.0;
+            stats.push_back(entry);
+        }
+        return stats;
+    }
+
+    /**
+     * Resets the statistics of the workers. Must not be called while
+     * \p parallelFor() is running.
+     */
+    void ThreadPool::resetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& worker : m_workers) {
+            worker->stats = WorkerStats{0, 0, 0, 0.0, 0.0};
+        }
+        m_elapsed = 0.0;
+    }
+}
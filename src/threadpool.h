@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        threadpool.h
+ * \brief       Header file declaring the work-stealing thread pool
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares a pool of worker threads processing index ranges
+ * in chunks. Every worker starts with an equal share of the range; workers
+ * running out of work steal half of the remaining share of another worker,
+ * so chunks of uneven cost do not leave cores idle at the end.
+ */
+
+#ifndef LIBIBAN_THREADPOOL_H
+#define LIBIBAN_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace IBAN {
+
+/// Configuration of a \p ThreadPool
+struct ThreadPoolConfig {
+    /// Number of worker threads; 0 selects the number of hardware threads
+    unsigned threads;
+    /// CPUs the workers are pinned to (worker \p i to CPU \p cpus[i % size]);
+    /// empty to leave the placement to the operating system
+    std::vector<int> cpus;
+};
+
+/// Statistics of a worker since the pool was created or reset
+struct WorkerStats {
+    /// Number of chunks processed
+    size_t chunks;
+    /// Number of indices processed
+    size_t items;
+    /// Number of successful steals from other workers
+    size_t steals;
+    /// Time spent processing chunks in seconds
+    double busySeconds;
+    /// Share of the time spent in \p parallelFor() that the worker was busy
+    double utilization;
+};
+
+/// Pool of worker threads with per-worker ranges and work stealing
+class ThreadPool {
+
+public:
+    /// Processes the indices from \p begin to \p end - 1
+    typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+
+private:
+    struct Worker;
+
+    /// The state of the workers
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    /// The worker threads
+    std::vector<std::thread> m_threads;
+    /// Held by a caller of \p parallelFor() for the whole job, so jobs of
+    /// concurrent callers run one after the other
+    std::mutex m_jobMutex;
+    /// Protects the job state below
+    std::mutex m_mutex;
+    /// Signals a new job or shutdown to the workers
+    std::condition_variable m_wake;
+    /// Signals the completion of a job
+    std::condition_variable m_done;
+    /// The function of the current job
+    const RangeFunction* m_function;
+    /// Number of indices per chunk of the current job
+    size_t m_grain;
+    /// Incremented for every job
+    size_t m_generation;
+    /// Number of workers still busy with the current job
+    size_t m_active;
+    /// Set when the pool is destroyed
+    bool m_stop;
+    /// First exception thrown by the function of the current job
+    std::exception_ptr m_error;
+    /// Time spent in \p parallelFor() in seconds
+    double m_elapsed;
+
+    void start(const ThreadPoolConfig& config);
+    void work(size_t index, int cpu);
+    bool takeChunk(size_t index, size_t& begin, size_t& end);
+    bool steal(size_t index);
+
+public:
+    explicit ThreadPool(unsigned threads = 0);
+    explicit ThreadPool(const ThreadPoolConfig& config);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void parallelFor(size_t count, size_t grain, const RangeFunction& function);
+    size_t getThreadCount() const;
+    std::vector<WorkerStats> getStats();
+    void resetStats();
+
+}; // end of class ThreadPool
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_THREADPOOL_H
@@ -119,5 +119,174 @@ inline long getReminderForIBANString(const std::string& string) {
     return num % 97;
 }
 
+/**
+ * Returns the value of an alphanumerical character as used by ISO 7064
+ * MOD 97-10: digits map to 0-9 and letters (in either case) to 10-35.
+ * Returns -1 for any other character.
+ *
+ * @param ch The character to convert
+ * @return The value of \p ch or -1 if it is not alphanumerical
+ */
+inline int getCharValue(const char ch) {
+    static const signed char values[256] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+         0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+        -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+        25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+        -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+        25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    };
+    return values[static_cast<unsigned char>(ch)];
+}
+
+/**
+ * Appends the numerical representation of a single character value to a
+ * running MOD 97 remainder. Letters expand to two decimal digits, digits to
+ * one, exactly like \p makeNumerical() would do.
+ *
+ * @param remainder The remainder of everything left of the character
+ * @param value The value of the character as returned by \p getCharValue()
+ * @return The remainder including the character
+ */
+inline unsigned foldRemainder(const unsigned remainder, const int value) {
+    return (value < 10 ? remainder * 10 + static_cast<unsigned>(value)
+                       : remainder * 100 + static_cast<unsigned>(value)) % 97;
+}
+
+/**
+ * Returns the power of ten to \p exponent modulo 97. As the remainder of a
+ * number is linear in its digits, this is the weight of a digit followed by
+ * \p exponent further digits in MOD 97-10 calculations.
+ *
+ * @param exponent The exponent
+ * @return 10 to the power of \p exponent modulo 97
+ */
+inline unsigned getPowerOfTen(const size_t exponent) {
+    // the powers of ten repeat with a period of 96 modulo 97
+    static const unsigned char powers[96] = {
+         1, 10,  3, 30,  9, 90, 27, 76, 81, 34, 49,  5, 50, 15, 53, 45,
+        62, 38, 89, 17, 73, 51, 25, 56, 75, 71, 31, 19, 93, 57, 85, 74,
+        61, 28, 86, 84, 64, 58, 95, 77, 91, 37, 79, 14, 43, 42, 32, 29,
+        96, 87, 94, 67, 88,  7, 70, 21, 16, 63, 48, 92, 47, 82, 44, 52,
+        35, 59,  8, 80, 24, 46, 72, 41, 22, 26, 66, 78,  4, 40, 12, 23,
+        36, 69, 11, 13, 33, 39,  2, 20,  6, 60, 18, 83, 54, 55, 65, 68,
+    };
+    return powers[exponent % 96];
+}
+
+/**
+ * Returns the number of decimal digits a character value occupies in the
+ * numerical form used by MOD 97-10: one for digits, two for letters.
+ *
+ * @param value The value of the character as returned by \p getCharValue()
+ * @return The number of decimal digits
+ */
+inline size_t getDigitCount(const int value) {
+    return value < 10 ? 1 : 2;
+}
+
+/**
+ * Calculates the MOD 97 remainder of the numerical form of an alphanumerical
+ * character sequence without building the numerical string. This is the
+ * allocation-free counterpart of \p makeNumerical() followed by
+ * \p getReminderForIBANString().
+ *
+ * @param data Pointer to the first character
+ * @param length The number of characters
+ * @param remainder Remainder of any digits preceding \p data (default: 0)
+ * @return The remainder or -1 if a character is not alphanumerical
+ */
+inline long getRemainder(const char* data, const size_t length,
+                         unsigned remainder = 0) {
+    // up to eight characters (at most 16 decimal digits) are accumulated in
+    // a 64 bit integer before reducing it, which saves most of the divisions
+    unsigned long long accumulator = remainder;
+    size_t pending = 0;
+    for (size_t i = 0; i < length; i++) {
+        int value = getCharValue(data[i]);
+        if (value < 0) {
+            return -1;
+        }
+        accumulator = accumulator * (value < 10 ? 10 : 100) +
+                      static_cast<unsigned>(value);
+        if (++pending == 8) {
+            accumulator %= 97;
+            pending = 0;
+        }
+    }
+    return static_cast<long>(accumulator % 97);
+}
+
+/**
+ * Calculates the MOD 97 remainder of an IBAN in machine form. The first four
+ * characters (country code and checksum) are moved to the end before the
+ * calculation as required by the IBAN specification. A valid IBAN has a
+ * remainder of 1.
+ *
+ * @param data Pointer to the first character of the IBAN
+ * @param length The number of characters (must be at least 4)
+ * @return The remainder or -1 if a character is not alphanumerical
+ */
+inline long getIBANRemainder(const char* data, const size_t length) {
+    long remainder = getRemainder(data + 4, length - 4);
+    if (remainder < 0) {
+        return -1;
+    }
+    return getRemainder(data, 4, static_cast<unsigned>(remainder));
+}
+
+/**
+ * Checks the ISO 7064 MOD 97-10 checksum of an identifier. The first
+ * \p rotate characters are moved to the end before the calculation: IBANs
+ * and creditor references carry their prefix and check digits in the first
+ * four characters, identifiers with trailing check digits use 0.
+ *
+ * @param data Pointer to the first character of the identifier
+ * @param length The number of characters
+ * @param rotate The number of leading characters moved to the end
+ * @return \p true if the remainder is 1
+ */
+inline bool hasValidMod97Checksum(const char* data, const size_t length,
+                                  const size_t rotate) {
+    if (rotate > length) {
+        return false;
+    }
+    long remainder = getRemainder(data + rotate, length - rotate);
+    return remainder >= 0 &&
+           getRemainder(data, rotate, static_cast<unsigned>(remainder)) == 1;
+}
+
+/**
+ * Calculates the check digits of an IBAN from its country code and its BBAN
+ * without allocating memory: the remainder of BBAN, country code and "00" is
+ * subtracted from 98.
+ *
+ * @param countryCode Pointer to the two letters of the country code
+ * @param bban Pointer to the first character of the BBAN
+ * @param length The length of the BBAN
+ * @return The check digits (2 to 98) or -1 if a character is invalid
+ */
+inline long getCheckDigits(const char* countryCode, const char* bban,
+                           const size_t length) {
+    long remainder = getRemainder(bban, length);
+    if (remainder < 0) {
+        return -1;
+    }
+    remainder = getRemainder(countryCode, 2, static_cast<unsigned>(remainder));
+    if (remainder < 0) {
+        return -1;
+    }
+    return 98 - static_cast<long>(remainder * getPowerOfTen(2) % 97);
+}
 
 #endif //LIBIBAN_UTILS_H
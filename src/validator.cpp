@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        validator.cpp
+ * \brief       Source file implementing the runtime validator dispatcher
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This source file instantiates the per-country validators of the registry
+ * and implements the dispatcher selecting them by country code.
+ */
+
+#include <array>
+#include "validator.h"
+
+namespace IBAN {
+
+    /// Table of 26 * 26 validators indexed by the country code
+    typedef std::array<ValidatorFunction, 26 * 26> dispatch_t;
+
+    /// Expands a registry entry to an assignment of its validator
+    #define LIBIBAN_VALIDATOR_ENTRY(code, length, format) \
+        table[static_cast<size_t>(Country::code)] = &Validator<Country::code>::validate;
+
+    /**
+     * Creates the jump table of all validators of the registry.
+     *
+     * @return The jump table
+     */
+    static dispatch_t createDispatchTable() {
+        dispatch_t table;
+        table.fill(nullptr);
+        LIBIBAN_COUNTRIES(LIBIBAN_VALIDATOR_ENTRY)
+        return table;
+    }
+
+    #undef LIBIBAN_VALIDATOR_ENTRY
+
+    /**
+     * Returns the validator specialized for a country.
+     *
+     * @param first The first letter of the country code (either case)
+     * @param second The second letter of the country code (either case)
+     * @return The validator or \p nullptr if the country is unknown
+     */
+    ValidatorFunction getValidator(char first, char second) {
+        static const dispatch_t dispatchTable = createDispatchTable();
+        int a = getCharValue(first) - 10, b = getCharValue(second) - 10;
+        if (a < 0 || b < 0) {
+            return nullptr;
+        }
+        return dispatchTable[static_cast<size_t>(a * 26 + b)];
+    }
+
+    /**
+     * Validates an IBAN in machine form by jumping to the validator of its
+     * country.
+     *
+     * @param data Pointer to the first character of the IBAN
+     * @param length The number of characters
+     * @return \p true if the IBAN is valid, \p false otherwise
+     */
+    bool validateMachineForm(const char* data, size_t length) {
+        if (length < 2) {
+            return false;
+        }
+        ValidatorFunction validator = getValidator(data[0], data[1]);
+        return validator != nullptr && validator(data, length);
+    }
+}
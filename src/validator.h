@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        validator.h
+ * \brief       Header file declaring per-country IBAN validators
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file declares validators specialized at compile time for a
+ * single country of the registry and a runtime dispatcher selecting the
+ * validator by the country code.
+ */
+
+#ifndef LIBIBAN_VALIDATOR_H
+#define LIBIBAN_VALIDATOR_H
+
+#include <cstddef>
+#include "registry.h"
+#include "utils.h"
+
+namespace IBAN {
+
+/// Function validating an IBAN in machine form
+typedef bool (*ValidatorFunction)(const char* data, size_t length);
+
+/**
+ * Checks and folds the BBAN characters from position \p I to \p N of a
+ * country into a running remainder. The recursion is resolved at compile
+ * time, so the checks form straight-line code without any table lookup.
+ */
+template <Country C, size_t I, size_t N>
+struct BBANStep {
+    /**
+     * Checks the character at position \p I and all following ones.
+     *
+     * @param bban Pointer to the first character of the BBAN
+     * @param accumulator The running (partially reduced) remainder
+     * @return \p true if all characters match the BBAN format
+     */
+    static bool apply(const char* bban, unsigned long long& accumulator) {
+        static constexpr char type = getFormatClass(
+                lookupCountryFormat(static_cast<char>('A' + static_cast<size_t>(C) / 26),
+                                    static_cast<char>('A' + static_cast<size_t>(C) % 26)), I);
+        int value = getCharValue(bban[I]);
+        if (!matchesFormatClass(type, value)) {
+            return false;
+        }
+        accumulator = accumulator * (value < 10 ? 10 : 100) +
+                      static_cast<unsigned>(value);
+        if (I % 8 == 7) {
+            accumulator %= 97;
+        }
+        return BBANStep<C, I + 1, N>::apply(bban, accumulator);
+    }
+};
+
+/// End of the recursion of \p BBANStep
+template <Country C, size_t N>
+struct BBANStep<C, N, N> {
+    /**
+     * Ends the recursion.
+     *
+     * @return Always \p true
+     */
+    static bool apply(const char*, unsigned long long&) {
+        return true;
+    }
+};
+
+/**
+ * Validator for the IBANs of a single country. Length, country code, BBAN
+ * format and checksum are checked with all country specific values known at
+ * compile time, e.g. \p Validator<Country::DE>::validate(data, length).
+ */
+template <Country C>
+struct Validator {
+    /// First letter of the country code
+    static constexpr char first = static_cast<char>('A' + static_cast<size_t>(C) / 26);
+    /// Second letter of the country code
+    static constexpr char second = static_cast<char>('A' + static_cast<size_t>(C) % 26);
+    /// Length of IBANs of the country
+    static constexpr size_t length = lookupCountryLength(first, second);
+
+    /**
+     * Validates an IBAN of the country in machine form (letters in either
+     * case).
+     *
+     * @param data Pointer to the first character of the IBAN
+     * @param size The number of characters
+     * @return \p true if the IBAN is valid, \p false otherwise
+     */
+    static bool validate(const char* data, size_t size) {
+        if (size != length || getCharValue(data[0]) != first - 'A' + 10 ||
+            getCharValue(data[1]) != second - 'A' + 10) {
+            return false;
+        }
+        int check1 = getCharValue(data[2]), check2 = getCharValue(data[3]);
+        if (check1 < 0 || check1 >= 10 || check2 < 0 || check2 >= 10) {
+            return false;
+        }
+        unsigned long long accumulator = 0;
+        if (!BBANStep<C, 0, length - 4>::apply(data + 4, accumulator)) {
+            return false;
+        }
+        // country code and checksum always form six decimal digits
+        unsigned long long head = (static_cast<unsigned>(first - 'A') + 10) * 10000 +
+                                  (static_cast<unsigned>(second - 'A') + 10) * 100 +
+                                  static_cast<unsigned>(check1 * 10 + check2);
+        return ((accumulator % 97) * 1000000 + head) % 97 == 1;
+    }
+};
+
+template <Country C> constexpr char Validator<C>::first;
+template <Country C> constexpr char Validator<C>::second;
+template <Country C> constexpr size_t Validator<C>::length;
+
+ValidatorFunction getValidator(char first, char second);
+bool validateMachineForm(const char* data, size_t length);
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_VALIDATOR_H
@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        xmltags.h
+ * \brief       Header file defining a minimal XML tag tokenizer
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This header file defines inline functions walking over the tags of an XML
+ * document in place. They are shared by the scanners for ISO 20022 payment
+ * and statement files, which only need a few elements and no tree.
+ */
+
+#ifndef LIBIBAN_XMLTAGS_H
+#define LIBIBAN_XMLTAGS_H
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+
+namespace IBAN {
+
+/// Tag of an XML document; all pointers refer to the document
+struct XMLTag {
+    /// The local name of the tag (without namespace prefix)
+    const char* name;
+    /// The length of \p name
+    size_t nameLength;
+    /// The attributes of the tag
+    const char* attributes;
+    /// The length of \p attributes
+    size_t attributesLength;
+    /// Whether this is an end tag
+    bool closing;
+    /// Whether this is an empty element tag
+    bool empty;
+};
+
+/**
+ * Finds a sequence of characters.
+ *
+ * @param data The data to search
+ * @param pos The position to start at
+ * @param length The length of the data
+ * @param sequence The sequence to find
+ * @return The position after the sequence or \p length if it is missing
+ */
+inline size_t skipPastXML(const char* data, size_t pos, size_t length,
+                          const char* sequence) {
+    size_t size = std::strlen(sequence);
+    while (pos + size <= length) {
+        const void* found = std::memchr(data + pos, sequence[0],
+                                        length - pos - size + 1);
+        if (found == nullptr) {
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const char*>(found) - data);
+        if (std::memcmp(data + pos, sequence, size) == 0) {
+            return pos + size;
+        }
+        pos++;
+    }
+    return length;
+}
+
+/**
+ * Reads the next start, end or empty element tag of a document. Comments,
+ * CDATA sections, declarations and processing instructions are skipped.
+ *
+ * @param data The document
+ * @param length The length of the document
+ * @param pos The position to start at; receives the position after the tag
+ * @param tag Receives the tag
+ * @return \p false if there are no further tags
+ */
+inline bool nextXMLTag(const char* data, size_t length, size_t& pos,
+                       XMLTag& tag) {
+    while (pos < length) {
+        const void* found = std::memchr(data + pos, '<', length - pos);
+        if (found == nullptr) {
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const char*>(found) - data) + 1;
+        if (pos == length) {
+            break;
+        }
+        if (data[pos] == '!') {
+            if (length - pos >= 3 && std::memcmp(data + pos, "!--", 3) == 0) {
+                pos = skipPastXML(data, pos + 3, length, "-->");
+            } else if (length - pos >= 8 &&
+                       std::memcmp(data + pos, "![CDATA[", 8) == 0) {
+                pos = skipPastXML(data, pos + 8, length, "]]>");
+            } else {
+                pos = skipPastXML(data, pos, length, ">");
+            }
+            continue;
+        } else if (data[pos] == '?') {
+            pos = skipPastXML(data, pos, length, "?>");
+            continue;
+        }
+
+        tag.closing = data[pos] == '/';
+        if (tag.closing) {
+            pos++;
+        }
+        size_t nameStart = pos;
+        while (pos < length && data[pos] != '>' && data[pos] != '/' &&
+               !std::isspace(static_cast<unsigned char>(data[pos]))) {
+            if (data[pos] == ':') {
+                nameStart = pos + 1;
+            }
+            pos++;
+        }
+        tag.name = data + nameStart;
+        tag.nameLength = pos - nameStart;
+        size_t end = skipPastXML(data, pos, length, ">");
+        bool complete = end > pos && data[end - 1] == '>';
+        tag.empty = complete && end - pos >= 2 && data[end - 2] == '/';
+        tag.attributes = data + pos;
+        tag.attributesLength = end - pos - (complete ? 1 : 0) - (tag.empty ? 1 : 0);
+        pos = end;
+        return true;
+    }
+    pos = length;
+    return false;
+}
+
+/**
+ * Compares the local name of a tag with a name.
+ *
+ * @param tag The tag
+ * @param name The name to compare with
+ * @return \p true if the names are equal
+ */
+inline bool isXMLName(const XMLTag& tag, const char* name) {
+    return std::strlen(name) == tag.nameLength &&
+           std::memcmp(tag.name, name, tag.nameLength) == 0;
+}
+
+/**
+ * Returns the text following a start tag up to the next tag without
+ * surrounding whitespace.
+ *
+ * @param data The document
+ * @param length The length of the document
+ * @param pos The position after the start tag
+ * @param text Receives the offset of the text
+ * @return The length of the text
+ */
+inline size_t getXMLText(const char* data, size_t length, size_t pos,
+                         size_t& text) {
+    const void* next = std::memchr(data + pos, '<', length - pos);
+    size_t end = next == nullptr ? length :
+            static_cast<size_t>(static_cast<const char*>(next) - data);
+    while (pos < end && std::isspace(static_cast<unsigned char>(data[pos]))) {
+        pos++;
+    }
+    while (end > pos && std::isspace(static_cast<unsigned char>(data[end - 1]))) {
+        end--;
+    }
+    text = pos;
+    return end - pos;
+}
+
+/**
+ * Finds the value of an attribute of a tag.
+ *
+ * @param tag The tag
+ * @param name The name of the attribute
+ * @param value Receives a pointer to the value
+ * @return The length of the value or 0 if the attribute is missing
+ */
+inline size_t getXMLAttribute(const XMLTag& tag, const char* name,
+                              const char*& value) {
+    size_t size = std::strlen(name);
+    const char* data = tag.attributes;
+    size_t length = tag.attributesLength;
+    for (size_t i = 0; i + size < length; i++) {
+        if (std::memcmp(data + i, name, size) != 0 ||
+                (i > 0 && !std::isspace(static_cast<unsigned char>(data[i - 1])))) {
+            continue;
+        }
+        size_t pos = i + size;
+        while (pos < length && std::isspace(static_cast<unsigned char>(data[pos]))) {
+            pos++;
+        }
+        if (pos + 1 >= length || data[pos] != '=') {
+            continue;
+        }
+        pos++;
+        while (pos < length && std::isspace(static_cast<unsigned char>(data[pos]))) {
+            pos++;
+        }
+        if (pos >= length || (data[pos] != '"' && data[pos] != '\'')) {
+            continue;
+        }
+        const void* end = std::memchr(data + pos + 1, data[pos], length - pos - 1);
+        if (end == nullptr) {
+            return 0;
+        }
+        value = data + pos + 1;
+        return static_cast<size_t>(static_cast<const char*>(end) - value);
+    }
+    return 0;
+}
+
+} // end of namespace IBAN
+
+#endif //LIBIBAN_XMLTAGS_H
@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iband.cpp
+ * \brief       Test file for the validation daemon
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This file starts the daemon \p iband (path given by \p IBAND_PATH) on a
+ * temporary Unix domain socket and talks to it as a client.
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include "../src/protocol.h"
+
+/**
+ * Starts the daemon and connects to it.
+ *
+ * @param path The path of the socket
+ * @param daemon Receives the process id of the daemon
+ * @return The connected socket or -1
+ */
+static int startDaemon(const char* path, pid_t& daemon) {
+    daemon = fork();
+    if (daemon == 0) {
+        execl(IBAND_PATH, "iband", "-s", path, "-j", "1", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    for (int attempt = 0; daemon > 0 && attempt < 500; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+TEST_CASE("Half-closed connection", "[iband]") {
+    const char* path = "/tmp/libiban_test_iband.sock";
+    pid_t daemon;
+    int fd = startDaemon(path, daemon);
+    REQUIRE(fd >= 0);
+
+    // the responses exceed the socket buffers but not the high water mark of
+    // the daemon, so most of them are still queued when the input ends
+    const size_t count = 80000;
+    std::string requests;
+    for (uint32_t id = 0; id < count; id++) {
+        REQUIRE(IBAN::appendRequest(requests, id, {"DE89370400440532013000"}));
+    }
+    size_t sent = 0;
+    while (sent < requests.size()) {
+        ssize_t result = send(fd, requests.data() + sent, requests.size() - sent, 0);
+        REQUIRE(result > 0);
+        sent += static_cast<size_t>(result);
+    }
+    REQUIRE(shutdown(fd, SHUT_WR) == 0);
+    // let the daemon see the end of the input before any response is read
+    usleep(200000);
+
+    std::string responses;
+    char buffer[1 << 16];
+    ssize_t result;
+    while ((result = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        responses.append(buffer, static_cast<size_t>(result));
+    }
+    close(fd);
+    kill(daemon, SIGTERM);
+    waitpid(daemon, nullptr, 0);
+    unlink(path);
+
+    // every request is answered in order before the daemon closes
+    size_t pos = 0;
+    uint32_t expected = 0;
+    std::vector<IBAN::ValidationCode> codes;
+    while (size_t frame = IBAN::findFrame(responses.data() + pos, responses.size() - pos)) {
+        REQUIRE(frame != IBAN::malformedFrame);
+        uint32_t id = 0;
+        REQUIRE(IBAN::parseResponse(responses.data() + pos + IBAN::frameHeaderLength,
+                                    frame - IBAN::frameHeaderLength, id, codes));
+        REQUIRE(id == expected++);
+        REQUIRE(codes.size() == 1);
+        REQUIRE(codes[0] == IBAN::ValidationCode::Valid);
+        pos += frame;
+    }
+    REQUIRE(pos == responses.size());
+    REQUIRE(expected == count);
+}
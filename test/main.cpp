@@ -33,9 +33,43 @@
  */
 
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "catch.hpp"
 #include "../src/libiban.h"
 #include "../src/utils.h"
+#include "../src/scrubber.h"
+#include "../src/incremental.h"
+#include "../src/literal.h"
+#include "../src/validator.h"
+#include "../src/national.h"
+#include "../src/conversion.h"
+#include "../src/rfreference.h"
+#include "../src/lei.h"
+#include "../src/bic.h"
+#include "../src/mappedfile.h"
+#include "../src/painscanner.h"
+#include "../src/camtscanner.h"
+#include "../src/mtscanner.h"
+#include "../src/csvscanner.h"
+#include "../src/jsonlscanner.h"
+#include "../src/pipeline.h"
+#include "../src/ring.h"
+#include "../src/threadpool.h"
+#include "../src/filereader.h"
+#include "../src/asyncvalidator.h"
+#include "../src/protocol.h"
+#include "../src/sharedmemory.h"
 
 // Test case for trim function in utils.h
 TEST_CASE("trim", "[utils]") {
@@ -307,10 +341,12 @@ TEST_CASE("validate", "[libiban]") {
     for (const auto& str : valid) {
         auto num = IBAN::IBAN::createFromString(str);
         REQUIRE(num.validate());
+        REQUIRE(IBAN::IBAN::validateString(str.data(), str.length()));
     }
     for (const auto& str : invalid) {
         auto num = IBAN::IBAN::createFromString(str);
         REQUIRE(!num.validate());
+        REQUIRE(!IBAN::IBAN::validateString(str.data(), str.length()));
     }
 }
 
@@ -334,3 +370,1378 @@ TEST_CASE("generateIBAN", "[libiban]") {
         REQUIRE(ex.what());
     }
 }
+
+TEST_CASE("getRemainder", "[utils]") {
+    std::string iban = "DE89370400440532013000";
+    std::string rearranged = iban.substr(4) + iban.substr(0, 4);
+    REQUIRE(getRemainder(rearranged.data(), rearranged.length()) ==
+            getReminderForIBANString(makeNumerical(rearranged)));
+    REQUIRE(getIBANRemainder(iban.data(), iban.length()) == 1);
+    REQUIRE(getRemainder("12-3", 4) == -1);
+}
+
+TEST_CASE("Scrubber", "[scrubber]") {
+    IBAN::Scrubber scrubber;
+    std::string log = "from DE89370400440532013000 to GB82 WEST 1234 5698 7654 32, "
+                      "ref DE89370400440532013001 id XDE89370400440532013000";
+    scrubber.scrub(&log[0], log.length(), true);
+    REQUIRE(log == "from DE****************3000 to GB** **** **** **** **54 32, "
+                   "ref DE89370400440532013001 id XDE89370400440532013000");
+    REQUIRE(scrubber.getMaskedCount() == 2);
+
+    // IBAN split across two blocks
+    IBAN::Scrubber split(0, 0, '#');
+    std::string first = "account: DE89 3704 00";
+    std::string second = "44 0532 0130 00\n";
+    size_t done = split.scrub(&first[0], first.length(), false);
+    REQUIRE(done == 9);
+    std::string rest = first.substr(done) + second;
+    REQUIRE(split.scrub(&rest[0], rest.length(), true) == rest.length());
+    REQUIRE(first.substr(0, done) + rest ==
+            "account: #### #### #### #### #### ##\n");
+}
+
+TEST_CASE("suggestCorrections", "[libiban]") {
+    std::vector<std::string> mistyped = {
+        "DE89370400440532013001", "DE89370400440523013000",
+        "GB82WEST12345698765423", "GB28WEST12345698765432",
+        "ED89370400440532013000",
+    };
+    std::vector<std::string> expected = {
+        "DE89370400440532013000", "DE89370400440532013000",
+        "GB82WEST12345698765432", "GB82WEST12345698765432",
+        "DE89370400440532013000",
+    };
+    static const std::string alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    for (size_t i = 0; i < mistyped.size(); i++) {
+        auto iban = IBAN::IBAN::createFromString(mistyped[i]);
+        auto suggestions = IBAN::IBAN::suggestCorrections(iban);
+        auto correct = IBAN::IBAN::createFromString(expected[i]);
+        REQUIRE(std::find(suggestions.begin(), suggestions.end(), correct) !=
+                suggestions.end());
+
+        // compare with brute force validation of every candidate
+        std::vector<std::string> bruteForce;
+        for (size_t k = 0; k < mistyped[i].length(); k++) {
+            for (auto ch : alphabet) {
+                std::string candidate = mistyped[i];
+                if (candidate[k] == ch) {
+                    continue;
+                }
+                candidate[k] = ch;
+                if (IBAN::IBAN::validateString(candidate.data(), candidate.length())) {
+                    bruteForce.push_back(candidate);
+                }
+            }
+        }
+        for (size_t k = 0; k + 1 < mistyped[i].length(); k++) {
+            std::string candidate = mistyped[i];
+            if (candidate[k] == candidate[k + 1]) {
+                continue;
+            }
+            std::swap(candidate[k], candidate[k + 1]);
+            if (IBAN::IBAN::validateString(candidate.data(), candidate.length())) {
+                bruteForce.push_back(candidate);
+            }
+        }
+        REQUIRE(suggestions.size() == bruteForce.size());
+        for (const auto& suggestion : suggestions) {
+            REQUIRE(suggestion.validate());
+            REQUIRE(std::find(bruteForce.begin(), bruteForce.end(),
+                              suggestion.getMachineForm()) != bruteForce.end());
+        }
+    }
+}
+
+TEST_CASE("IncrementalValidator", "[incremental]") {
+    IBAN::IncrementalValidator validator;
+    std::string input = "DE89 3704 0044 0532 0130 0";
+    for (auto ch : input) {
+        REQUIRE(validator.push(ch) == IBAN::ValidationState::Incomplete);
+    }
+    REQUIRE(validator.push('0') == IBAN::ValidationState::Valid);
+    REQUIRE(validator.getLength() == 22);
+
+    // too long
+    REQUIRE(validator.push('1') == IBAN::ValidationState::Invalid);
+    REQUIRE(validator.getErrorPosition() == 22);
+    REQUIRE(validator.pop() == IBAN::ValidationState::Valid);
+
+    // wrong checksum
+    REQUIRE(validator.pop() == IBAN::ValidationState::Incomplete);
+    REQUIRE(validator.push('1') == IBAN::ValidationState::Invalid);
+    REQUIRE(validator.getErrorPosition() == 2);
+
+    // structural errors
+    validator.reset();
+    REQUIRE(validator.push("D3", 2) == IBAN::ValidationState::Invalid);
+    REQUIRE(validator.getErrorPosition() == 1);
+    validator.reset();
+    REQUIRE(validator.push("XX", 2) == IBAN::ValidationState::Invalid);
+    validator.reset();
+    REQUIRE(validator.push("gb82 west 1234 5698 7654 3", 26) ==
+            IBAN::ValidationState::Incomplete);
+    REQUIRE(validator.push('2') == IBAN::ValidationState::Valid);
+    validator.reset();
+    REQUIRE(validator.push("DE89 3704 0044 05/", 18) == IBAN::ValidationState::Invalid);
+    REQUIRE(validator.getErrorPosition() == 14);
+}
+
+TEST_CASE("computeCheckDigits", "[libiban]") {
+    REQUIRE(IBAN::IBAN::computeCheckDigits("DE", "370400440532013000") == "89");
+    REQUIRE(IBAN::IBAN::computeCheckDigits("GB", "WEST12345698765432") == "82");
+    REQUIRE(IBAN::IBAN::computeCheckDigits("NO", "86011117947") == "93");
+    REQUIRE_THROWS_AS(IBAN::IBAN::computeCheckDigits("XX", "1234"),
+                      const IBAN::IBANInvalidCountryCodeException&);
+    REQUIRE_THROWS_AS(IBAN::IBAN::computeCheckDigits("DE", "3704/0044"),
+                      const IBAN::IBANParseException&);
+
+    std::string bbans = "370400440532013000210501700012345678"
+                        "1005000000242906613704004405320-3000";
+    char checkDigits[8];
+    REQUIRE(IBAN::IBAN::computeCheckDigits("DE", bbans.data(), 18, 4,
+                                           checkDigits) == 1);
+    REQUIRE(std::string(checkDigits, 8) == "89680200");
+
+    auto broken = IBAN::IBAN::createFromString("DE00370400440532013000");
+    auto repaired = broken.withCorrectChecksum();
+    REQUIRE(!broken.validate());
+    REQUIRE(repaired.validate());
+    REQUIRE(repaired.getChecksum() == "89");
+}
+
+TEST_CASE("enumerateCompletions", "[libiban]") {
+    std::vector<IBAN::IBAN> found;
+    auto collect = [&found](const IBAN::IBAN& iban) { found.push_back(iban); };
+
+    size_t count = IBAN::IBAN::enumerateCompletions("DE89 3704 00?4 0532 ?130 00", collect);
+    REQUIRE(count == found.size());
+    REQUIRE(std::find(found.begin(), found.end(),
+                      IBAN::IBAN::createFromString("DE89370400440532013000")) != found.end());
+
+    // compare with brute force validation of every fill
+    static const std::string alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::vector<std::string> patterns = {
+        "GB82WEST1234569876543?", "?E89370400440532013000",
+        "DE?937040044053201300?", "GB82W?ST12345?98765?32",
+    };
+    for (const auto& pattern : patterns) {
+        found.clear();
+        count = IBAN::IBAN::enumerateCompletions(pattern, collect);
+        std::vector<size_t> unknown;
+        for (size_t k = 0; k < pattern.length(); k++) {
+            if (pattern[k] == '?') {
+                unknown.push_back(k);
+            }
+        }
+        size_t expected = 0;
+        std::string candidate = pattern;
+        std::function<void(size_t)> fill = [&](size_t i) {
+            if (i == unknown.size()) {
+                if (IBAN::IBAN::validateString(candidate.data(), candidate.length())) {
+                    expected++;
+                    REQUIRE(std::find(found.begin(), found.end(),
+                            IBAN::IBAN::createFromString(candidate)) != found.end());
+                }
+                return;
+            }
+            for (auto ch : alphabet) {
+                candidate[unknown[i]] = ch;
+                fill(i + 1);
+            }
+        };
+        fill(0);
+        REQUIRE(count == expected);
+    }
+
+    REQUIRE(IBAN::IBAN::enumerateCompletions("DE89370400440532013000", collect) == 1);
+    REQUIRE_THROWS_AS(IBAN::IBAN::enumerateCompletions("DE89-3704", collect),
+                      const IBAN::IBANParseException&);
+}
+
+TEST_CASE("IBAN literals", "[literal]") {
+    constexpr auto settlement = IBAN_LITERAL("DE89370400440532013000");
+    constexpr auto readable = IBAN_LITERAL("gb82 west 1234 5698 7654 32");
+    static_assert(settlement.length() == 22, "length of literal");
+    static_assert(settlement.getCheckDigits() == 89, "check digits of literal");
+    static_assert(readable[4] == 'W', "character of literal");
+    static_assert(readable.getBBAN()[0] == 'W', "BBAN of literal");
+    static_assert(IBAN::validateLiteral("NO9386011117947", 15), "valid literal");
+    static_assert(!IBAN::validateLiteral("DE89370400440532013001", 22), "invalid checksum");
+    static_assert(!IBAN::validateLiteral("NO9386011117948", 15), "invalid checksum");
+    static_assert(!IBAN::validateLiteral("XX9386011117947", 15), "invalid country");
+    static_assert(!IBAN::validateLiteral("NO93860111179", 13), "invalid length");
+    static_assert(!IBAN::validateLiteral("NO088601111794A", 15), "invalid format");
+    static_assert(IBAN::lookupCountryLength('D', 'E') == 22, "registry lookup");
+
+    IBAN::IBAN iban = settlement;
+    REQUIRE(iban.getMachineForm() == "DE89370400440532013000");
+    REQUIRE(std::string(settlement.getMachineForm()) == "DE89370400440532013000");
+    REQUIRE(static_cast<IBAN::IBAN>(readable).getHumanReadable() ==
+            "GB82 WEST 1234 5698 7654 32");
+    REQUIRE(static_cast<IBAN::IBAN>(readable) == IBAN::IBAN::createFromString("GB82WEST12345698765432"));
+
+    // outside of constant expressions the IBAN is validated at compile time, too
+    IBAN::IBAN norwegian = IBAN_LITERAL("NO93 8601 1117 947");
+    REQUIRE(norwegian.getBBAN() == "86011117947");
+    REQUIRE(norwegian.validate());
+
+    // literals cannot be created without validating them
+    static_assert(!std::is_constructible<IBAN::IBANLiteral, const char*, size_t,
+                                         IBAN::LiteralCheck<true>>::value,
+                  "unchecked constructor of literal");
+    REQUIRE_THROWS_AS(IBAN::IBANLiteral::create("garbage", IBAN::LiteralCheck<true>()),
+                      const std::invalid_argument&);
+
+    for (const auto& entry : IBAN::countryRegistry) {
+        REQUIRE(IBAN::IBAN::m_countryCodes.at(entry.code) == entry.length);
+    }
+}
+
+TEST_CASE("Validator", "[validator]") {
+    static_assert(IBAN::Validator<IBAN::Country::DE>::length == 22, "length of DE");
+    static_assert(IBAN::getFormatLength("4a14n") == 18, "format length");
+    static_assert(IBAN::getFormatClass("4a14n", 3) == 'a', "format class");
+    static_assert(IBAN::getFormatClass("4a14n", 4) == 'n', "format class");
+
+    typedef IBAN::Validator<IBAN::Country::DE> ValidatorDE;
+    REQUIRE(ValidatorDE::validate("DE89370400440532013000", 22));
+    REQUIRE(ValidatorDE::validate("de89370400440532013000", 22));
+    REQUIRE(!ValidatorDE::validate("DE89370400440532013001", 22));
+    REQUIRE(!ValidatorDE::validate("GB82WEST12345698765432", 22));
+    REQUIRE(!ValidatorDE::validate("DE8937040044053201300", 21));
+    // correct checksum, but letters are not allowed in German BBANs
+    REQUIRE(!ValidatorDE::validate("DE0537040044053201300A", 22));
+    REQUIRE(!IBAN::IBAN::createFromString("DE0537040044053201300A").validate());
+
+    REQUIRE(IBAN::Validator<IBAN::Country::GB>::validate("GB82WEST12345698765432", 22));
+    REQUIRE(IBAN::getValidator('G', 'B') == &IBAN::Validator<IBAN::Country::GB>::validate);
+    REQUIRE(IBAN::getValidator('X', 'X') == nullptr);
+    REQUIRE(IBAN::validateMachineForm("NO9386011117947", 15));
+    REQUIRE(!IBAN::validateMachineForm("NO088601111794A", 15));
+}
+
+TEST_CASE("German check digit methods", "[national]") {
+    REQUIRE(IBAN::getGermanMethodIndex("00") == 0);
+    REQUIRE(IBAN::getGermanMethodIndex("13") == 13);
+    REQUIRE(IBAN::getGermanMethodIndex("E4") == 144);
+    REQUIRE(IBAN::getGermanMethodIndex("F0") == -1);
+    REQUIRE(IBAN::getGermanMethodIndex("0") == -1);
+
+    using IBAN::NationalCheckResult;
+    REQUIRE(IBAN::checkGermanAccount(0, "0009290701") == NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkGermanAccount(0, "0539290858") == NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkGermanAccount(0, "0539290859") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(13, "0532013000") == NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkGermanAccount(13, "0532113000") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(9, "1234567890") == NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkGermanAccount(52, "1234567890") == NationalCheckResult::Unsupported);
+    REQUIRE(IBAN::checkGermanAccount(0, "00092907A1") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::isGermanMethodSupported(144));
+    REQUIRE(!IBAN::isGermanMethodSupported(52));
+    REQUIRE(!IBAN::isGermanMethodSupported(150));
+
+    // test numbers published with the method catalogue
+    const std::vector<std::pair<std::string, std::string>> valid = {
+        {"17", "0446786040"}, {"22", "2394871426"}, {"24", "0000138301"},
+        {"26", "0520309001"}, {"27", "2847169488"}, {"28", "0019999000"},
+        {"31", "1000000524"}, {"35", "0000108443"}, {"36", "0000113178"},
+        {"37", "0000624315"}, {"42", "0000059498"}, {"43", "0006135244"},
+        {"44", "0000889006"}, {"45", "3545343232"}, {"46", "0235468612"},
+        {"47", "0001018000"}, {"50", "4000005001"}, {"51", "0001156071"},
+        {"51", "0001156136"}, {"51", "0001156078"}, {"51", "0001234567"},
+        {"51", "0000340968"}, {"51", "0000201178"}, {"51", "0001009588"},
+        {"51", "0101356073"}, {"51", "0199100002"}, {"51", "0099100010"},
+        {"51", "2599100002"}, {"51", "0199100004"}, {"51", "2599100003"},
+        {"51", "3199204090"}, {"56", "0290545005"}, {"56", "9718304037"},
+        {"58", "1800881120"}, {"61", "2063099200"}, {"61", "0260760481"},
+        {"62", "5029076701"}, {"63", "0123456600"}, {"63", "0003500022"},
+        {"64", "1206473010"}, {"65", "1234567400"}, {"65", "1234567590"},
+        {"66", "0100154508"}, {"71", "7101234007"}, {"73", "0003503398"},
+        {"73", "0001340967"}, {"73", "0003503391"}, {"73", "0001340968"},
+        {"73", "0003503392"}, {"73", "0001340966"}, {"74", "0000001016"},
+        {"74", "0000026260"}, {"74", "0000242243"}, {"74", "0000242248"},
+        {"74", "0018002113"}, {"74", "1821200043"}, {"77", "0000010338"},
+        {"81", "0000646440"}, {"81", "0199100002"}, {"83", "0001156071"},
+        {"83", "0001156136"}, {"83", "0001156078"}, {"83", "0001234567"},
+        {"83", "0000156071"}, {"83", "0099100002"}, {"86", "0000340968"},
+        {"88", "0002525259"}, {"88", "0090013000"}, {"93", "6714790000"},
+        {"93", "0000671479"}, {"93", "1277830000"}, {"93", "0000127783"},
+        {"93", "1277910000"}, {"93", "0000127791"}, {"93", "3067540000"},
+        {"93", "0000306754"}, {"94", "6782533003"}, {"95", "6450060494"},
+        {"96", "0000254100"}, {"97", "0024010019"}, {"98", "9619439213"},
+        {"98", "3009800016"}, {"98", "5989800173"}, {"A0", "0521003287"},
+        {"A1", "0010030005"}, {"A1", "0010030997"}, {"A2", "3456789019"},
+        {"A2", "3456789012"}, {"A3", "9876543210"}, {"A5", "0000251437"},
+        {"A6", "0855000014"}, {"A6", "0000000017"}, {"A7", "0019010660"},
+        {"A8", "0007436661"}, {"A8", "0007436660"}, {"B1", "1434253150"},
+        {"B1", "7414398260"}, {"B2", "0020012357"}, {"B2", "8000990054"},
+        {"B3", "9635000101"}, {"B4", "9961230019"}, {"B4", "0000251437"},
+        {"B5", "0123456782"}, {"B5", "0130098767"}, {"B5", "0159006955"},
+        {"B7", "0700001529"}, {"C2", "2394871426"}, {"C3", "9000420530"},
+        {"C4", "0000292932"}, {"C7", "0003500022"}, {"C7", "0038150900"},
+        {"C8", "0123456789"}, {"D0", "6100272324"}, {"D3", "6019937007"},
+        {"E0", "0002610015"},
+    };
+    for (const std::pair<std::string, std::string>& entry : valid) {
+        INFO(entry.first << " " << entry.second);
+        int method = IBAN::getGermanMethodIndex(entry.first);
+        REQUIRE(IBAN::checkGermanAccount(method, entry.second.c_str()) == NationalCheckResult::Valid);
+    }
+    REQUIRE(IBAN::checkGermanAccount(17, "0446786140") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(56, "9718304038") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(63, "1123456600") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(51, "0099345678") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(51, "0099100110") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(51, "0199100040") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(74, "0000001011") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(74, "0000026265") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(74, "0018002118") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(74, "6160000024") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(88, "0002525250") == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanAccount(IBAN::getGermanMethodIndex("B5"), "0130098768") ==
+            NationalCheckResult::Invalid);
+
+    const std::string path = "blz_test.txt";
+    {
+        std::ofstream file(path);
+        file << "37040044" << std::string(142, ' ') << "13" << std::string(20, ' ') << "\n";
+        file << "10000000" << std::string(142, ' ') << "09" << std::string(20, ' ') << "\n";
+        file << "short line\n";
+    }
+    IBAN::BLZDirectory directory;
+    REQUIRE(directory.loadBundesbankFile(path) == 2);
+    std::remove(path.c_str());
+    REQUIRE_THROWS_AS(directory.loadBundesbankFile(path), const std::runtime_error&);
+    REQUIRE(directory.size() == 2);
+    REQUIRE(directory.getUnsupportedCount() == 0);
+    REQUIRE(directory.getMethod(37040044) == 13);
+    REQUIRE(directory.getMethod(12345678) == -1);
+    directory.add(12345678, "00");
+    REQUIRE(directory.getMethod(12345678) == 0);
+    REQUIRE_THROWS_AS(directory.add(12345678, "X1"), const std::invalid_argument&);
+    directory.add(87654321, "52");
+    REQUIRE(directory.getUnsupportedCount() == 1);
+
+    REQUIRE(IBAN::checkGermanBBAN(directory, "370400440532013000", 18) == NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkGermanBBAN(directory, "370400440532113000", 18) == NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkGermanBBAN(directory, "999999990532013000", 18) == NationalCheckResult::Unsupported);
+
+    const char* ibans = "DE89370400440532013000" "DE14123456780539290858" "DE89999999990532013000";
+    NationalCheckResult results[3];
+    IBAN::checkGermanIBANs(directory, ibans, 3, results);
+    REQUIRE(results[0] == NationalCheckResult::Valid);
+    REQUIRE(results[1] == NationalCheckResult::Valid);
+    REQUIRE(results[2] == NationalCheckResult::Unsupported);
+}
+
+TEST_CASE("National checks", "[national]") {
+    using IBAN::NationalCheckResult;
+    const std::vector<std::string> valid = {
+        "BE45096920886089", "BE68539007547034", "FR0220041000016219433J02076",
+        "FR1420041010050500013M02606", "IT43K0310412701000000820420",
+        "IT60X0542811101000000123456", "PT50003600409911001102673",
+        "PT50000201231234567890154", "ES1321000555370200853027",
+        "ES9121000418450200051332", "NO9386011117947", "NO0239916835985"
+    };
+    for (const auto& iban : valid) {
+        REQUIRE(IBAN::checkNationalDigits(iban.data(), iban.length()) ==
+                NationalCheckResult::Valid);
+        REQUIRE(IBAN::IBAN::createFromString(iban).validate(true));
+    }
+
+    // correct IBAN checksums, but wrong national check digits
+    const std::vector<std::string> invalid = {
+        "BE00539007547035", "FR0020041010050500013M02607",
+        "IT00X0542811101000000123457", "PT00000201231234567890155",
+        "ES0021000418450200051333", "ES0021000419450200051332",
+        "NO0086011117948"
+    };
+    for (const auto& bad : invalid) {
+        auto iban = IBAN::IBAN::createFromString(bad).withCorrectChecksum();
+        REQUIRE(iban.validate());
+        REQUIRE(!iban.validate(true));
+    }
+    REQUIRE(IBAN::checkItalianBBAN("x0542811101000000123456", 23) ==
+            NationalCheckResult::Valid);
+    REQUIRE(IBAN::checkItalianBBAN("10542811101000000123456", 23) ==
+            NationalCheckResult::Invalid);
+    REQUIRE(IBAN::checkFrenchBBAN("2004101005050001", 16) ==
+            NationalCheckResult::Invalid);
+
+    // countries without a registered check are accepted
+    REQUIRE(IBAN::checkNationalDigits("GB82WEST12345698765432", 22) ==
+            NationalCheckResult::Unsupported);
+    REQUIRE(IBAN::IBAN::createFromString("GB82WEST12345698765432").validate(true));
+
+    // custom checks can be plugged in and removed again
+    REQUIRE(IBAN::getNationalCheck('G', 'B') == nullptr);
+    IBAN::registerNationalCheck('G', 'B', [](const char*, size_t) {
+        return NationalCheckResult::Invalid;
+    });
+    REQUIRE(!IBAN::IBAN::createFromString("GB82WEST12345698765432").validate(true));
+    IBAN::registerNationalCheck('G', 'B', nullptr);
+    REQUIRE(IBAN::IBAN::createFromString("GB82WEST12345698765432").validate(true));
+    REQUIRE_THROWS_AS(IBAN::registerNationalCheck('1', 'B', nullptr),
+                      const std::invalid_argument&);
+
+    const char* batch = "BE68539007547034" "BE68539007547044" "BE45096920886089";
+    bool results[3];
+    REQUIRE(IBAN::IBAN::validateBatch(batch, 16, 3, results) == 2);
+    REQUIRE(results[0]);
+    REQUIRE(!results[1]);
+    REQUIRE(results[2]);
+    const std::string belgian =
+            IBAN::IBAN::createFromString("BE00539007547035").withCorrectChecksum().getMachineForm();
+    REQUIRE(IBAN::IBAN::validateBatch(belgian.data(), 16, 1, results) == 1);
+    REQUIRE(IBAN::IBAN::validateBatch(belgian.data(), 16, 1, results, true) == 0);
+    REQUIRE(!results[0]);
+
+    // unsupported national checks are reported instead of counted as valid
+    const std::string mixed = std::string("BE68539007547034") + belgian + "BE68539007547044";
+    NationalCheckResult national[3];
+    REQUIRE(IBAN::IBAN::checkNationalBatch(mixed.data(), 16, 3, national) == 1);
+    REQUIRE(national[0] == NationalCheckResult::Valid);
+    REQUIRE(national[1] == NationalCheckResult::Invalid);
+    REQUIRE(national[2] == NationalCheckResult::Invalid);
+    IBAN::ThreadPool pool(2);
+    REQUIRE(IBAN::IBAN::checkNationalBatch("GB82WEST12345698765432", 22, 1, national, pool) == 0);
+    REQUIRE(national[0] == NationalCheckResult::Unsupported);
+    REQUIRE(IBAN::IBAN::validateBatch("GB82WEST12345698765432", 22, 1, results, pool, true) == 1);
+}
+
+TEST_CASE("fromNational", "[conversion]") {
+    using IBAN::fromNational;
+    REQUIRE(fromNational("DE", "37040044", "", "532013000").getMachineForm() ==
+            "DE89370400440532013000");
+    REQUIRE(fromNational("FR", "20041", "01005", "0500013m026").getMachineForm() ==
+            "FR1420041010050500013M02606");
+    REQUIRE(fromNational("ES", "2100", "0418", "0200051332").getMachineForm() ==
+            "ES9121000418450200051332");
+    REQUIRE(fromNational("IT", "05428", "11101", "123456").getMachineForm() ==
+            "IT60X0542811101000000123456");
+    REQUIRE(fromNational("BE", "539", "", "0075470").getMachineForm() ==
+            "BE68539007547034");
+    REQUIRE(fromNational("PT", "0002", "0123", "1234567890-1").getMachineForm() ==
+            "PT50000201231234567890154");
+    REQUIRE(fromNational("GB", "WEST", "12-34-56", "98765432").getMachineForm() ==
+            "GB82WEST12345698765432");
+
+    REQUIRE(!IBAN::hasNationalLayout('U', 'S'));
+    REQUIRE_THROWS_AS(fromNational("US", "1", "", "1"),
+                      const IBAN::IBANInvalidCountryCodeException&);
+    REQUIRE_THROWS_AS(fromNational("DE", "370400441", "", "532013000"),
+                      const IBAN::IBANParseException&);
+    REQUIRE_THROWS_AS(fromNational("DE", "37040044", "1", "532013000"),
+                      const IBAN::IBANParseException&);
+    REQUIRE_THROWS_AS(fromNational("DE", "37040044", "", "53201300A"),
+                      const IBAN::IBANParseException&);
+    // the Norwegian account number carries its own check digit
+    REQUIRE(fromNational("NO", "8601", "", "1117947").getMachineForm() == "NO9386011117947");
+    REQUIRE_THROWS_AS(fromNational("NO", "8601", "", "1117948"),
+                      const IBAN::IBANParseException&);
+
+    // bank specific rules rewrite the BBAN before the check digits are computed
+    IBAN::registerConversionRule("DE", "10000000", [](char* bban, size_t) {
+        std::copy_n("37040044", 8, bban);
+        return true;
+    });
+    REQUIRE(fromNational("DE", "10000000", "", "532013000").getMachineForm() ==
+            "DE89370400440532013000");
+    IBAN::registerConversionRule("DE", "10000000", nullptr);
+    REQUIRE(fromNational("DE", "10000000", "", "532013000").getBBAN() ==
+            "100000000532013000");
+
+    std::istringstream input("DE;37040044;;532013000\r\nUS;1;;1\nbe;539;;0075470\n"
+                             "DE;37040044;;1;2\n");
+    std::ostringstream output;
+    REQUIRE(IBAN::convertNationalStream(input, output) == 2);
+    REQUIRE(output.str() == "DE89370400440532013000\n\nBE68539007547034\n\n");
+
+    char iban[34];
+    REQUIRE(IBAN::convertNational("GB", "WEST", 4, "123456", 6, "98765432", 8, iban) == 22);
+    REQUIRE(std::string(iban, 22) == "GB82WEST12345698765432");
+}
+
+TEST_CASE("RFReference", "[rfreference]") {
+    using IBAN::RFReference;
+    auto reference = RFReference::createFromString("RF18 5390 0754 7034");
+    REQUIRE(reference.validate());
+    REQUIRE(reference.getChecksum() == "18");
+    REQUIRE(reference.getReference() == "539007547034");
+    REQUIRE(reference.getMachineForm() == "RF18539007547034");
+    REQUIRE(reference.getHumanReadable() == "RF18 5390 0754 7034");
+    REQUIRE(!RFReference::createFromString("RF19539007547034").validate());
+    REQUIRE(RFReference::createFromString("rf712348231").validate());
+
+    REQUIRE(RFReference::generate("539007547034") == reference);
+    REQUIRE(RFReference::generate("abc").getMachineForm() == "RF45ABC");
+    REQUIRE(RFReference::generate("123456789012345678901").validate());
+    REQUIRE_THROWS_AS(RFReference::generate(""), const IBAN::RFParseException&);
+    REQUIRE_THROWS_AS(RFReference::generate("1234567890123456789012"),
+                      const IBAN::RFParseException&);
+    REQUIRE_THROWS_AS(RFReference::createFromString("RX18539007547034"),
+                      const IBAN::RFParseException&);
+    REQUIRE_THROWS_AS(RFReference::createFromString("RF1"),
+                      const IBAN::RFParseException&);
+    REQUIRE_THROWS_AS(RFReference::createFromString("RF18-539007547034"),
+                      const IBAN::RFParseException&);
+
+    REQUIRE(RFReference::validateString("RF18 5390 0754 7034", 19));
+    REQUIRE(!RFReference::validateString("RF18 5390 0754 7035", 19));
+    REQUIRE(!RFReference::validateString("DE89370400440532013000", 22));
+
+    // the same kernel serves IBANs and creditor references
+    REQUIRE(hasValidMod97Checksum("RF18539007547034", 16, 4));
+    REQUIRE(hasValidMod97Checksum("DE89370400440532013000", 22, 4));
+
+    const char* batch = "RF18539007547034     " "RF712348231          "
+                        "RF19539007547034     ";
+    bool results[3];
+    REQUIRE(RFReference::validateBatch(batch, 21, 3, results) == 2);
+    REQUIRE(results[0]);
+    REQUIRE(results[1]);
+    REQUIRE(!results[2]);
+}
+
+TEST_CASE("LEI", "[lei]") {
+    using IBAN::LEI;
+    const std::vector<std::string> valid = {
+        "5493001KJTIIGC8Y1R12", "7LTWFZYICNSX8D621K86", "529900T8BM49AURSDO55"
+    };
+    for (const auto& string : valid) {
+        auto lei = LEI::createFromString(string);
+        REQUIRE(lei.validate());
+        REQUIRE(lei.toString() == string);
+        REQUIRE(LEI::computeCheckDigits(string.substr(0, 18)) == string.substr(18));
+        REQUIRE(LEI::generate(string.substr(0, 18)) == lei);
+    }
+
+    auto lei = LEI::createFromString("5493 001K JTII GC8Y 1R12");
+    REQUIRE(lei.getLOUPrefix() == "5493");
+    REQUIRE(lei.getEntityCode() == "001KJTIIGC8Y1R");
+    REQUIRE(lei.getChecksum() == "12");
+    REQUIRE(!LEI::createFromString("5493001KJTIIGC8Y1R13").validate());
+    REQUIRE(LEI::generate("5493001kjtiigc8y1r").toString() == "5493001KJTIIGC8Y1R12");
+    REQUIRE_THROWS_AS(LEI::createFromString("5493001KJTIIGC8Y1R1"),
+                      const IBAN::LEIParseException&);
+    REQUIRE_THROWS_AS(LEI::createFromString("5493001KJTIIGC8Y1RA2"),
+                      const IBAN::LEIParseException&);
+    REQUIRE_THROWS_AS(LEI::computeCheckDigits("5493001KJTIIGC8Y1-"),
+                      const IBAN::LEIParseException&);
+
+    REQUIRE(LEI::validateString("5493001kjtiigc8y1r12", 20));
+    REQUIRE(!LEI::validateString("5493001KJTIIGC8Y1R21", 20));
+    REQUIRE(!LEI::validateString("5493001KJTIIGC8Y1R121", 21));
+
+    const char* batch = "5493001KJTIIGC8Y1R12\n" "7LTWFZYICNSX8D621K87\n"
+                        "529900T8BM49AURSDO55\n";
+    bool results[3];
+    REQUIRE(LEI::validateBatch(batch, 21, 3, results) == 2);
+    REQUIRE(results[0]);
+    REQUIRE(!results[1]);
+    REQUIRE(results[2]);
+}
+
+TEST_CASE("BIC", "[bic]") {
+    using IBAN::BIC;
+    auto bic = BIC::createFromString("cobadeffxxx");
+    REQUIRE(bic.toString() == "COBADEFFXXX");
+    REQUIRE(bic.getBankCode() == "COBA");
+    REQUIRE(bic.getCountryCode() == "DE");
+    REQUIRE(bic.getLocationCode() == "FF");
+    REQUIRE(bic.getBranchCode() == "XXX");
+    REQUIRE(!bic.isTestBIC());
+    REQUIRE(BIC::createFromString("NWBKGB2L").getBranchCode() == "XXX");
+    REQUIRE(BIC::createFromString("DEUTDEF0").isTestBIC());
+    REQUIRE_THROWS_AS(BIC::createFromString("COBADEFFXX"), const IBAN::BICParseException&);
+    REQUIRE_THROWS_AS(BIC::createFromString("COB1DEFF"), const IBAN::BICParseException&);
+    REQUIRE_THROWS_AS(BIC::createFromString("COBAD3FF"), const IBAN::BICParseException&);
+
+    REQUIRE(BIC::validateString(" NWBKGB2L ", 10));
+    REQUIRE(!BIC::validateString("NWBK GB2L", 9));
+    const char* bics = "COBADEFFXXX" "NWBKGB2L   " "NWBKGB2L-  ";
+    bool valid[3];
+    REQUIRE(BIC::validateBatch(bics, 11, 3, valid) == 2);
+    REQUIRE(!valid[2]);
+
+    auto iban = IBAN::IBAN::createFromString("DE89370400440532013000");
+    REQUIRE(IBAN::consistent(iban, bic));
+    REQUIRE(!IBAN::consistent(iban, BIC::createFromString("NWBKGB2L")));
+    REQUIRE(IBAN::consistent(IBAN::IBAN::createFromString("FR1420041010050500013M02606"),
+                             BIC::createFromString("BNPAGPGPXXX")));
+    REQUIRE(IBAN::checkConsistency("DE8937040044053201300", 21, "COBADEFF", 8) ==
+            IBAN::ConsistencyResult::Malformed);
+
+    IBAN::BankDirectory directory;
+    directory.add("DE", "37040044", "COBADEFFXXX");
+    directory.add("DE", "37040044", "COBADEFF370");
+    directory.add("GB", "WEST", "NWBKGB2L");
+    REQUIRE(directory.size() == 2);
+    REQUIRE_THROWS_AS(directory.add("US", "1", "COBADEFF"),
+                      const IBAN::IBANInvalidCountryCodeException&);
+    REQUIRE_THROWS_AS(directory.add("DE", "3704004", "COBADEFF"),
+                      const std::invalid_argument&);
+    REQUIRE(IBAN::consistent(iban, bic, &directory));
+    REQUIRE(!IBAN::consistent(iban, BIC::createFromString("DEUTDEFF"), &directory));
+    // banks unknown to the directory cannot be checked
+    REQUIRE(IBAN::consistent(IBAN::IBAN::createFromString("DE12500105170648489890"),
+                             BIC::createFromString("INGDDEFFXXX"), &directory));
+
+    const std::string path = "bic_test.txt";
+    {
+        std::ofstream file(path);
+        file << "DE;50010517;INGDDEFFXXX\nDE;5001051;INGDDEFFXXX\nnonsense\n";
+    }
+    REQUIRE(directory.loadFile(path) == 1);
+    std::remove(path.c_str());
+    REQUIRE(!IBAN::consistent(IBAN::IBAN::createFromString("DE12500105170648489890"),
+                              BIC::createFromString("COBADEFFXXX"), &directory));
+
+    const char* ibans = "DE89370400440532013000" "DE89370400440532013000"
+                        "GB82WEST12345698765432";
+    const char* pairs = "COBADEFF   " "DEUTDEFF   " "NWBKGB2LXXX";
+    IBAN::ConsistencyResult results[3];
+    REQUIRE(IBAN::checkConsistencyBatch(ibans, 22, pairs, 11, 3, results,
+                                        &directory) == 2);
+    REQUIRE(results[1] == IBAN::ConsistencyResult::BankMismatch);
+}
+
+TEST_CASE("PainScanner", "[painscanner]") {
+    const std::string document =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<Document xmlns=\"urn:iso:std:iso:20022:tech:xsd:pain.001.001.03\">"
+        "<CstmrCdtTrfInitn><!-- <IBAN>XX00</IBAN> -->"
+        "<PmtInf><PmtInfId>PMT-1</PmtInfId>"
+        "<DbtrAcct><Id><IBAN>DE89370400440532013000</IBAN></Id></DbtrAcct>"
+        "<DbtrAgt><FinInstnId><BIC>COBADEFFXXX</BIC></FinInstnId></DbtrAgt>"
+        "<CdtTrfTxInf><PmtId><EndToEndId>E2E-1</EndToEndId></PmtId>"
+        "<CdtrAgt><FinInstnId><BIC>NWBKGB2L</BIC></FinInstnId></CdtrAgt>"
+        "<CdtrAcct><Id><IBAN> GB82WEST12345698765433 </IBAN></Id></CdtrAcct>"
+        "</CdtTrfTxInf>"
+        "<CdtTrfTxInf><PmtId><EndToEndId>E2E-2</EndToEndId></PmtId>"
+        "<CdtrAgt><FinInstnId><p:BICFI>NWBK1B2L</p:BICFI></FinInstnId></CdtrAgt>"
+        "<CdtrAcct><Id><IBAN>GB82WEST12345698765432</IBAN></Id></CdtrAcct>"
+        "<RmtInf><Ustrd><![CDATA[<IBAN>invalid</IBAN>]]></Ustrd></RmtInf>"
+        "</CdtTrfTxInf></PmtInf>"
+        "<PmtInf><PmtInfId>PMT-2</PmtInfId><BIC/>"
+        "<DbtrAcct><Id><IBAN>DE89370400440532013001</IBAN></Id></DbtrAcct>"
+        "</PmtInf></CstmrCdtTrfInitn></Document>";
+
+    std::vector<std::string> failures;
+    IBAN::PainScanner scanner;
+    auto summary = scanner.scan(document.data(), document.length(),
+            [&](const IBAN::PaymentIdentifier& identifier) {
+                REQUIRE(!identifier.valid);
+                REQUIRE(document.compare(identifier.offset, identifier.length,
+                                         identifier.value, identifier.length) == 0);
+                failures.push_back(std::string(identifier.value, identifier.length) +
+                        "|" + std::string(identifier.paymentInfoId,
+                                          identifier.paymentInfoIdLength) +
+                        "|" + (identifier.endToEndId == nullptr ? "" :
+                               std::string(identifier.endToEndId,
+                                           identifier.endToEndIdLength)));
+            });
+    REQUIRE(summary.ibans == 4);
+    REQUIRE(summary.bics == 3);
+    REQUIRE(summary.invalid == 3);
+    REQUIRE(failures.size() == 3);
+    REQUIRE(failures[0] == "GB82WEST12345698765433|PMT-1|E2E-1");
+    REQUIRE(failures[1] == "NWBK1B2L|PMT-1|E2E-2");
+    REQUIRE(failures[2] == "DE89370400440532013001|PMT-2|");
+
+    const std::string path = "pain_test.xml";
+    {
+        std::ofstream file(path);
+        file << document;
+    }
+    size_t reported = 0;
+    summary = IBAN::PainScanner(true).scanFile(path,
+            [&](const IBAN::PaymentIdentifier&) { reported++; });
+    REQUIRE(reported == 7);
+    REQUIRE(summary.invalid == 3);
+    {
+        IBAN::MappedFile file(path);
+        REQUIRE(file.size() == document.length());
+        REQUIRE(std::string(file.data(), file.size()) == document);
+    }
+    std::remove(path.c_str());
+    REQUIRE_THROWS_AS(IBAN::MappedFile(path), const std::runtime_error&);
+}
+
+TEST_CASE("CamtScanner", "[camtscanner]") {
+    const std::string entry =
+        "<Ntry><Amt Ccy=\"EUR\">100.00</Amt><CdtDbtInd>CRDT</CdtDbtInd>"
+        "<NtryDtls><TxDtls><AmtDtls><TxAmt><Amt Ccy=\"USD\">1.00</Amt></TxAmt></AmtDtls>"
+        "<RltdPties><DbtrAcct><Id><IBAN>DE89370400440532013000</IBAN></Id></DbtrAcct>"
+        "<CdtrAcct><Id><IBAN>GB82WEST12345698765433</IBAN></Id></CdtrAcct>"
+        "</RltdPties></TxDtls></NtryDtls></Ntry>";
+    const std::string head =
+        "<?xml version=\"1.0\"?><Document><BkToCstmrStmt><Stmt>"
+        "<Acct><Id><IBAN>FR1420041010050500013M02606</IBAN></Id></Acct>";
+    const std::string tail = "</Stmt></BkToCstmrStmt></Document>";
+    const std::string document = head + entry +
+        "<Ntry><Amt>5</Amt><CdtDbtInd>DBIT</CdtDbtInd></Ntry>" + entry + tail;
+
+    std::vector<IBAN::CounterpartyAccount> accounts;
+    IBAN::CamtScanner scanner;
+    REQUIRE(scanner.scan(document.data(), document.length(),
+            [&](const IBAN::CounterpartyAccount& account) {
+                accounts.push_back(account);
+            }) == 3);
+    REQUIRE(accounts.size() == 4);
+    REQUIRE(accounts[0].entry == 0);
+    REQUIRE(accounts[0].role == IBAN::PartyRole::Debtor);
+    REQUIRE(accounts[0].valid);
+    REQUIRE(accounts[0].credit);
+    REQUIRE(std::string(accounts[0].iban, accounts[0].length) == "DE89370400440532013000");
+    REQUIRE(document.compare(accounts[0].offset, 22, "DE89370400440532013000") == 0);
+    REQUIRE(std::string(accounts[0].amount, accounts[0].amountLength) == "100.00");
+    REQUIRE(std::string(accounts[0].currency, accounts[0].currencyLength) == "EUR");
+    REQUIRE(accounts[1].role == IBAN::PartyRole::Creditor);
+    REQUIRE(!accounts[1].valid);
+    REQUIRE(accounts[2].entry == 2);
+    REQUIRE(accounts[3].entry == 2);
+
+    // large documents are split at entry boundaries and scanned in parallel
+    std::string large = head;
+    const size_t count = 15000;
+    for (size_t i = 0; i < count; i++) {
+        large += entry;
+    }
+    large += tail;
+    REQUIRE(large.length() > 4 * (1 << 20));
+    std::mutex mutex;
+    std::vector<size_t> seen(count, 0);
+    size_t valid = 0;
+    REQUIRE(IBAN::CamtScanner(4).scan(large.data(), large.length(),
+            [&](const IBAN::CounterpartyAccount& account) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[account.entry]++;
+                valid += account.valid ? 1 : 0;
+            }) == count);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t n) { return n == 2; }));
+    REQUIRE(valid == count);
+
+    // prefixed entries and entry tags inside comments and CDATA sections are
+    // numbered the same way in every part
+    std::string prefixed = entry;
+    prefixed.replace(prefixed.find("<Ntry>"), 6, "<ns:Ntry>");
+    prefixed.replace(prefixed.find("</Ntry>"), 7, "</ns:Ntry>");
+    std::string mixed = head + "<!-- <Ntry> --><![CDATA[<Ntry>]]>";
+    for (size_t i = 0; i < count; i++) {
+        mixed += i % 3 == 0 ? prefixed : entry;
+    }
+    mixed += tail;
+    std::fill(seen.begin(), seen.end(), 0);
+    size_t outside = 0;
+    REQUIRE(IBAN::CamtScanner(4).scan(mixed.data(), mixed.length(),
+            [&](const IBAN::CounterpartyAccount& account) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (account.entry < count) {
+                    seen[account.entry]++;
+                } else {
+                    outside++;
+                }
+            }) == count);
+    REQUIRE(outside == 0);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t n) { return n == 2; }));
+}
+
+TEST_CASE("MTScanner", "[mtscanner]") {
+    const std::string statement =
+        "{1:F01COBADEFFAXXX0000000000}{2:O9400000000000COBADEFFXXXX00000000000000000000N}{4:\r\n"
+        ":20:STMT1\r\n"
+        ":25:DE89370400440532013000EUR\r\n"
+        ":28C:1/1\r\n"
+        ":61:1701020102C100,00NTRFNONREF\r\n"
+        ":86:166?00GUTSCHRIFT?20SVWZ+Invoice 4711?30COBADEFF?31GB82WEST123456987654\r\n"
+        "32?32John Doe\r\n"
+        ":86:?31FR1420041010050500013M02606?32Jane Doe\r\n"
+        "-}\r\n";
+    const std::string payment =
+        "{1:F01COBADEFFAXXX0000000000}{4:\r\n"
+        ":20:PAY1\r\n"
+        ":50K:/DE89370400440532013001\r\n"
+        "JOHN DOE\r\n"
+        ":59:/GB82WEST12345698765432\r\n"
+        "JANE DOE\r\n"
+        ":70:DE89370400440532013000\r\n"
+        "-}";
+    const std::string data = statement + payment;
+
+    std::vector<IBAN::MTAccount> accounts;
+    std::vector<std::string> ibans;
+    REQUIRE(IBAN::MTScanner().scan(data.data(), data.length(),
+            [&](const IBAN::MTAccount& account) {
+                accounts.push_back(account);
+                ibans.push_back(std::string(account.iban, account.length));
+            }) == 2);
+    REQUIRE(accounts.size() == 5);
+    REQUIRE(accounts[0].message == 0);
+    REQUIRE(accounts[0].field == IBAN::MTField::Account);
+    REQUIRE(accounts[0].valid);
+    REQUIRE(ibans[0] == "DE89370400440532013000");
+    REQUIRE(data.compare(accounts[0].offset, 22, "DE89370400440532013000") == 0);
+    // the IBAN wrapped into the next line of the field is joined
+    REQUIRE(accounts[1].field == IBAN::MTField::Information);
+    REQUIRE(accounts[1].valid);
+    REQUIRE(ibans[1] == "GB82WEST12345698765432");
+    REQUIRE(data.compare(accounts[1].offset, 20, "GB82WEST123456987654") == 0);
+    REQUIRE(accounts[2].field == IBAN::MTField::Information);
+    REQUIRE(ibans[2] == "FR1420041010050500013M02606");
+    REQUIRE(accounts[3].message == 1);
+    REQUIRE(accounts[3].field == IBAN::MTField::OrderingCustomer);
+    REQUIRE(!accounts[3].valid);
+    REQUIRE(ibans[3] == "DE89370400440532013001");
+    REQUIRE(accounts[4].field == IBAN::MTField::Beneficiary);
+    REQUIRE(accounts[4].valid);
+
+    // files of many messages are split at message delimiters
+    std::string large;
+    const size_t count = 12000;
+    for (size_t i = 0; i < count; i++) {
+        large += statement;
+    }
+    REQUIRE(large.length() > 2 * (1 << 20));
+    std::mutex mutex;
+    std::vector<size_t> seen(count, 0);
+    REQUIRE(IBAN::MTScanner(4).scan(large.data(), large.length(),
+            [&](const IBAN::MTAccount& account) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[account.message]++;
+            }) == count);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t n) { return n == 3; }));
+
+    IBAN::ThreadPool pool(2);
+    REQUIRE(IBAN::MTScanner(pool).scan(large.data(), large.length(),
+            [&](const IBAN::MTAccount& account) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[account.message]++;
+            }) == count);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t n) { return n == 6; }));
+}
+
+TEST_CASE("CSVScanner", "[csvscanner]") {
+    const std::string data =
+        "name;iban;amount\r\n"
+        "\"Doe; John\";DE89 3704 0044 0532 0130 00;1.00\r\n"
+        "\"multi\nline\";\" GB82WEST12345698765432 \";2.00\r\n"
+        "short\n"
+        "x;DE89370400440532013001;3.00";
+
+    std::vector<IBAN::CSVField> fields;
+    IBAN::CSVScanner scanner(1, ';', true);
+    REQUIRE(scanner.scan(data.data(), data.length(),
+            [&](const IBAN::CSVField& field) {
+                fields.push_back(field);
+            }) == 4);
+    REQUIRE(fields[0].row == 0);
+    REQUIRE(fields[0].valid);
+    REQUIRE(std::string(fields[0].value, fields[0].length) ==
+            "DE89 3704 0044 0532 0130 00");
+    REQUIRE(std::string(fields[0].line, fields[0].lineLength) ==
+            "\"Doe; John\";DE89 3704 0044 0532 0130 00;1.00");
+    REQUIRE(fields[1].valid);
+    REQUIRE(std::string(fields[1].value, fields[1].length) == "GB82WEST12345698765432");
+    REQUIRE(!fields[2].valid);
+    REQUIRE(fields[2].length == 0);
+    REQUIRE(fields[3].row == 3);
+    REQUIRE(!fields[3].valid);
+
+    std::vector<unsigned char> bitmap;
+    REQUIRE(scanner.validateColumn(data.data(), data.length(), bitmap) == 4);
+    REQUIRE(bitmap.size() == 1);
+    REQUIRE(bitmap[0] == 0x03);
+
+    // large files are split at line breaks outside of quoted fields
+    std::string large = "iban,note\n";
+    const size_t count = 80000;
+    for (size_t i = 0; i < count; i++) {
+        large += i % 3 == 0 ? "DE89370400440532013000,\"a\nb\"\n" :
+                 "DE89370400440532013001,\"\"\"x\"\"\"\n";
+    }
+    REQUIRE(large.length() > 2 * (1 << 20));
+    IBAN::CSVScanner parallel(0, ',', true, 4);
+    REQUIRE(parallel.split(large.data(), large.length(), 4).size() == 2);
+    REQUIRE(parallel.validateColumn(large.data(), large.length(), bitmap) == count);
+    bool matches = true;
+    for (size_t i = 0; i < count; i++) {
+        matches = matches && ((bitmap[i / 8] >> (i % 8) & 1) == (i % 3 == 0 ? 1 : 0));
+    }
+    REQUIRE(matches);
+
+    // the chunks may be scanned on the workers of a pool
+    IBAN::ThreadPool pool(2);
+    std::vector<unsigned char> pooled;
+    REQUIRE(IBAN::CSVScanner(0, ',', true, pool).validateColumn(
+            large.data(), large.length(), pooled) == count);
+    REQUIRE(pooled == bitmap);
+    size_t chunks = 0;
+    for (const IBAN::WorkerStats& stats : pool.getStats()) {
+        chunks += stats.chunks;
+    }
+    REQUIRE(chunks > 0);
+}
+
+TEST_CASE("JSONLScanner", "[jsonlscanner]") {
+    const std::string data =
+        "{\"id\": 1, \"creditor\": {\"name\": \"A \\\"B\\\"\", \"account\": "
+        "{\"iban\": \"DE89370400440532013000\"}}, \"debtors\": "
+        "[{\"iban\": \"x\"}, {\"iban\": \"GB82 WEST 1234 5698 7654 32\"}]}\n"
+        "\n"
+        "{\"creditor\": {\"account\": {\"iban\": \"DE89370400440532013001\"}}, "
+        "\"debtors\": [], \"note\": [1, {\"a\": \"}\"}, true]}\r\n"
+        "{\"creditor\": {\"account\": {\"iban\": 42}}}\n"
+        "{\"creditor\": {\"account\": \n";
+
+    IBAN::JSONLScanner scanner({"$.creditor.account.iban", "$.debtors[1].iban"});
+    std::vector<IBAN::JSONLine> lines;
+    std::vector<std::vector<IBAN::JSONField>> fields;
+    REQUIRE(scanner.scan(data.data(), data.length(),
+            [&](const IBAN::JSONLine& line) {
+                lines.push_back(line);
+                fields.emplace_back(line.fields, line.fields + line.count);
+            }) == 5);
+    REQUIRE(lines.size() == 4);
+    REQUIRE(lines[0].line == 0);
+    REQUIRE(!lines[0].malformed);
+    REQUIRE(fields[0][0].found);
+    REQUIRE(fields[0][0].valid);
+    REQUIRE(std::string(fields[0][0].value, fields[0][0].length) == "DE89370400440532013000");
+    REQUIRE(data.compare(fields[0][0].offset, 22, "DE89370400440532013000") == 0);
+    REQUIRE(fields[0][1].valid);
+    REQUIRE(lines[1].line == 2);
+    REQUIRE(!lines[1].malformed);
+    REQUIRE(fields[1][0].found);
+    REQUIRE(!fields[1][0].valid);
+    REQUIRE(!fields[1][1].found);
+    REQUIRE(!fields[2][0].found);
+    REQUIRE(!lines[2].malformed);
+    REQUIRE(lines[3].line == 4);
+    REQUIRE(lines[3].malformed);
+
+    REQUIRE_THROWS_AS(IBAN::JSONLScanner({"$.a..b"}), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(IBAN::JSONLScanner({"$.a[x]"}), const std::invalid_argument&);
+
+    // large documents are split at line breaks
+    std::string large;
+    const size_t count = 40000;
+    for (size_t i = 0; i < count; i++) {
+        large += "{\"creditor\": {\"account\": {\"iban\": \"DE89370400440532013000\"}}}\n";
+    }
+    REQUIRE(large.length() > 2 * (1 << 20));
+    std::mutex mutex;
+    std::vector<size_t> seen(count, 0);
+    REQUIRE(IBAN::JSONLScanner({"$.creditor.account.iban"}, 4).scan(
+            large.data(), large.length(), [&](const IBAN::JSONLine& line) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen[line.line] += line.fields[0].valid ? 1 : 0;
+            }) == count);
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](size_t n) { return n == 1; }));
+}
+
+TEST_CASE("Rings", "[pipeline]") {
+    IBAN::SPSCRing<int> single(3);
+    int value = 0;
+    REQUIRE(!single.tryPop(value));
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(single.tryPush(i));
+    }
+    REQUIRE(!single.tryPush(4));
+    REQUIRE(single.tryPop(value));
+    REQUIRE(value == 0);
+
+    // every element pushed by one of the producers is popped exactly once
+    IBAN::MPMCRing<size_t> shared(16);
+    const size_t perThread = 20000;
+    std::atomic<size_t> popped(0), sum(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 1; i <= perThread; i++) {
+                while (!shared.tryPush(t * perThread + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&]() {
+            size_t element;
+            while (popped.load() < 4 * perThread) {
+                if (shared.tryPop(element)) {
+                    sum += element;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const size_t total = 4 * perThread;
+    REQUIRE(popped.load() == total);
+    REQUIRE(sum.load() == total * (total + 1) / 2);
+}
+
+TEST_CASE("Pipeline", "[pipeline]") {
+    const std::string valid = "DE89 3704 0044 0532 0130 00";
+    const std::string invalid = "DE89370400440532013001";
+    const size_t count = 50000;
+    std::atomic<size_t> staged(0);
+    IBAN::Pipeline pipeline(100, 8);
+    pipeline.addStage([&](IBAN::IBANBatch& batch) {
+        staged += batch.views.size();
+    }, 2).addValidationStage(4);
+
+    size_t next = 0, validCount = 0;
+    bool ordered = true;
+    REQUIRE(pipeline.run([&](IBAN::Pipeline::Emitter& emitter) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& iban = i % 5 == 0 ? invalid : valid;
+            emitter.emit(iban.data(), iban.length());
+        }
+    }, [&](const IBAN::IBANBatch& batch) {
+        ordered = ordered && batch.sequence == next++;
+        for (size_t i = 0; i < batch.results.size(); i++) {
+            size_t index = batch.sequence * 100 + i;
+            ordered = ordered && batch.results[i] == (index % 5 == 0 ? 0 : 1);
+        }
+        validCount += batch.valid;
+    }) == count);
+    REQUIRE(ordered);
+    REQUIRE(next == count / 100);
+    REQUIRE(staged.load() == count);
+    REQUIRE(validCount == count / 5 * 4);
+
+    // scanners emit from the source thread
+    const std::string message =
+        "{1:F01BANKDEFFXXXX0000000000}{4:\r\n:25:DE89370400440532013000\r\n-}";
+    size_t scanned = 0;
+    IBAN::Pipeline().addValidationStage(2).run([&](IBAN::Pipeline::Emitter& emitter) {
+        IBAN::MTScanner().scan(message.data(), message.length(),
+                               [&](const IBAN::MTAccount& account) {
+            emitter.emit(account.iban, account.length);
+        });
+    }, [&](const IBAN::IBANBatch& batch) {
+        scanned += batch.valid;
+    });
+    REQUIRE(scanned == 1);
+}
+
+TEST_CASE("ThreadPool", "[threadpool]") {
+    IBAN::ThreadPool pool(IBAN::ThreadPoolConfig{4, {0}});
+    REQUIRE(pool.getThreadCount() == 4);
+
+    // every index is processed exactly once even if the chunks of the
+    // first worker are much more expensive than the others
+    const size_t count = 2000;
+    std::vector<std::atomic<unsigned>> processed(count);
+    for (auto& value : processed) {
+        value = 0;
+    }
+    pool.parallelFor(count, 10, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (i < count / 4) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            processed[i]++;
+        }
+    });
+    REQUIRE(std::all_of(processed.begin(), processed.end(),
+                        [](const std::atomic<unsigned>& n) { return n.load() == 1; }));
+    std::vector<IBAN::WorkerStats> stats = pool.getStats();
+    REQUIRE(stats.size() == 4);
+    size_t items = 0, steals = 0;
+    for (auto& entry : stats) {
+        items += entry.items;
+        steals += entry.steals;
+        REQUIRE(entry.utilization <= 1.0);
+    }
+    REQUIRE(items == count);
+    REQUIRE(steals > 0);
+    pool.resetStats();
+    REQUIRE(pool.getStats()[0].chunks == 0);
+
+    REQUIRE_THROWS_AS(pool.parallelFor(10, 1, [](size_t begin, size_t) {
+        if (begin == 5) {
+            throw std::runtime_error("failed");
+        }
+    }), const std::runtime_error&);
+
+    // jobs of concurrent callers do not interfere
+    std::vector<std::atomic<size_t>> sums(4);
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < sums.size(); caller++) {
+        sums[caller] = 0;
+        callers.emplace_back([&pool, &sums, caller]() {
+            for (int round = 0; round < 20; round++) {
+                pool.parallelFor(100000, 7, [&sums, caller](size_t begin, size_t end) {
+                    sums[caller] += end - begin;
+                });
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    REQUIRE(std::all_of(sums.begin(), sums.end(),
+                        [](const std::atomic<size_t>& n) { return n.load() == 2000000; }));
+
+    // batch functions on a pool match the sequential ones
+    std::string ibans, bbans;
+    const size_t batch = 10000;
+    for (size_t i = 0; i < batch; i++) {
+        ibans += i % 3 == 0 ? "DE89370400440532013001" : "DE89370400440532013000";
+        bbans += "370400440532013000";
+    }
+    std::unique_ptr<bool[]> results(new bool[batch]);
+    REQUIRE(IBAN::IBAN::validateBatch(ibans.data(), 22, batch, results.get(), pool) ==
+            batch - (batch + 2) / 3);
+    REQUIRE(results[1]);
+    REQUIRE(!results[3]);
+    std::string digits(2 * batch, ' ');
+    REQUIRE(IBAN::IBAN::computeCheckDigits("DE", bbans.data(), 18, batch, &digits[0], pool) == 0);
+    REQUIRE(digits.substr(2 * (batch - 1)) == "89");
+}
+
+TEST_CASE("FileReader", "[filereader]") {
+    // files larger than a buffer are read in several chunks
+    std::vector<std::string> paths, contents;
+    for (size_t i = 0; i < 5; i++) {
+        std::string path = "libiban_test_read_" + std::to_string(i) + ".txt";
+        std::string content(i * 5000, static_cast<char>('a' + i));
+        std::ofstream(path, std::ios::binary) << content;
+        paths.push_back(path);
+        contents.push_back(content);
+    }
+    paths.push_back("libiban_test_missing.txt");
+
+    for (bool useUring : {true, false}) {
+        std::vector<std::string> read(paths.size());
+        std::vector<size_t> lastChunks(paths.size(), 0);
+        std::vector<int> errors(paths.size(), 0);
+        bool ordered = true;
+        IBAN::FileReader reader(4096, 3, useUring);
+        REQUIRE(reader.readFiles(paths, [&](IBAN::FileChunk& chunk) {
+            ordered = ordered && chunk.offset == read[chunk.file].size();
+            read[chunk.file].append(chunk.data, chunk.length);
+            lastChunks[chunk.file] += chunk.last ? 1 : 0;
+            errors[chunk.file] = chunk.error;
+        }) == 50000);
+        REQUIRE(ordered);
+        for (size_t i = 0; i < contents.size(); i++) {
+            REQUIRE(read[i] == contents[i]);
+            REQUIRE(lastChunks[i] == 1);
+            REQUIRE(errors[i] == 0);
+        }
+        REQUIRE(lastChunks.back() == 1);
+        REQUIRE(errors.back() == ENOENT);
+    }
+    for (size_t i = 0; i < contents.size(); i++) {
+        std::remove(paths[i].c_str());
+    }
+}
+
+TEST_CASE("AsyncValidator", "[asyncvalidator]") {
+    // submissions from many threads are collected into full batches
+    std::atomic<size_t> valid(0), completed(0);
+    {
+        IBAN::AsyncValidator validator(64, std::chrono::microseconds(1000000));
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&, t]() {
+                for (size_t i = 0; i < 64; i++) {
+                    const char* iban = i % 4 == t ? "GB82 WEST 1234 5698 7654 32" :
+                                       i % 2 == 0 ? "DE89370400440532013000" :
+                                                    "DE89370400440532013001";
+                    validator.submit(iban, std::strlen(iban), [&](bool result) {
+                        valid += result ? 1 : 0;
+                        completed++;
+                    });
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        while (completed.load() < 256) {
+            std::this_thread::yield();
+        }
+        REQUIRE(validator.getBatchCount() == 4);
+    }
+    REQUIRE(valid.load() == 64 + 96);
+
+    // a single submission is completed after the deadline
+    IBAN::AsyncValidator validator(1000, std::chrono::microseconds(200));
+    std::future<bool> result = validator.submit("DE89370400440532013000", 22);
+    REQUIRE(result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(result.get());
+    REQUIRE(!validator.submit("DE89 3704 0044 0532 0130 00 0000 0000 0000", 42).get());
+
+    // flushing without pending IBANs does not cut the deadline of the next one
+    {
+        IBAN::AsyncValidator waiting(1000, std::chrono::microseconds(10000000));
+        waiting.flush();
+        std::future<bool> delayed = waiting.submit("DE89370400440532013000", 22);
+        REQUIRE(delayed.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+        waiting.flush();
+        REQUIRE(delayed.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        REQUIRE(waiting.getBatchCount() == 1);
+    }
+
+    // completions run on the given executor
+    std::vector<std::function<void()>> queued;
+    std::mutex mutex;
+    bool called = false;
+    {
+        IBAN::AsyncValidator queuing(16, std::chrono::microseconds(100000),
+                                     [&](std::function<void()> task) {
+                                         std::lock_guard<std::mutex> lock(mutex);
+                                         queued.push_back(task);
+                                     });
+        queuing.submit("DE89370400440532013000", 22, [&](bool) { called = true; });
+        queuing.flush();
+    }
+    REQUIRE(!called);
+    REQUIRE(queued.size() == 1);
+    queued[0]();
+    REQUIRE(called);
+}
+
+TEST_CASE("Validation protocol", "[protocol]") {
+    const std::string wrongKey = IBAN::IBAN::createFromString(
+            "FR0020041010050500013M02607").withCorrectChecksum().getMachineForm();
+    std::string requests;
+    REQUIRE(IBAN::appendRequest(requests, 7, {"DE89 3704 0044 0532 0130 00",
+                                              "DE89370400440532013001",
+                                              "FR1420041010050500013M02606",
+                                              wrongKey, std::string(40, 'A')}, true));
+    REQUIRE(IBAN::appendRequest(requests, 8, {}));
+    REQUIRE(!IBAN::appendRequest(requests, 9, {std::string(256, 'A')}));
+
+    // pipelined requests are answered in order
+    REQUIRE(IBAN::findFrame(requests.data(), 3) == 0);
+    size_t first = IBAN::findFrame(requests.data(), requests.length());
+    REQUIRE(first > 0);
+    REQUIRE(IBAN::findFrame(requests.data(), first - 1) == 0);
+    std::string responses;
+    REQUIRE(IBAN::handleRequest(requests.data() + 4, first - 4, responses));
+    size_t second = IBAN::findFrame(requests.data() + first, requests.length() - first);
+    REQUIRE(first + second == requests.length());
+    REQUIRE(IBAN::handleRequest(requests.data() + first + 4, second - 4, responses));
+
+    uint32_t id = 0;
+    std::vector<IBAN::ValidationCode> codes;
+    size_t frame = IBAN::findFrame(responses.data(), responses.length());
+    REQUIRE(IBAN::parseResponse(responses.data() + 4, frame - 4, id, codes));
+    REQUIRE(id == 7);
+    REQUIRE(codes.size() == 5);
+    REQUIRE(codes[0] == IBAN::ValidationCode::Valid);
+    REQUIRE(codes[1] == IBAN::ValidationCode::Invalid);
+    REQUIRE(codes[2] == IBAN::ValidationCode::Valid);
+    REQUIRE(codes[3] == IBAN::ValidationCode::NationalInvalid);
+    REQUIRE(codes[4] == IBAN::ValidationCode::Malformed);
+    REQUIRE(IBAN::parseResponse(responses.data() + frame + 4,
+                                responses.length() - frame - 4, id, codes));
+    REQUIRE(id == 8);
+    REQUIRE(codes.empty());
+
+    // truncated requests and oversized frames are rejected
+    REQUIRE(!IBAN::handleRequest(requests.data() + 4, first - 5, responses));
+    const char oversized[] = {'\xff', '\xff', '\xff', '\x7f'};
+    REQUIRE(IBAN::findFrame(oversized, 4) == IBAN::malformedFrame);
+}
+
+TEST_CASE("Shared memory ring", "[sharedmemory]") {
+    REQUIRE_THROWS_AS(IBAN::SharedMemoryServer("/libiban_test_ring", 3),
+                      const std::invalid_argument&);
+    REQUIRE_THROWS_AS(IBAN::SharedMemoryClient("/libiban_test_missing"),
+                      const std::runtime_error&);
+
+    IBAN::SharedMemoryServer server("/libiban_test_ring", 4);
+    std::vector<IBAN::ValidationCode> codes;
+    {
+        IBAN::SharedMemoryClient client("/libiban_test_ring");
+        REQUIRE_THROWS_AS(IBAN::SharedMemoryClient("/libiban_test_ring"),
+                          const std::runtime_error&);
+        REQUIRE(client.peek(0) == nullptr);
+        REQUIRE(!client.receive(codes, 0));
+
+        // the ring holds as many requests as it has slots
+        const std::string wrongKey = IBAN::IBAN::createFromString(
+                "FR0020041010050500013M02607").withCorrectChecksum().getMachineForm();
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(client.submit({"DE89 3704 0044 0532 0130 00", "DE89370400440532013001",
+                                   wrongKey, std::string(40, 'A')}, i % 2 == 1));
+        }
+        REQUIRE(!client.submit({"DE89370400440532013000"}));
+        REQUIRE(client.getPendingCount() == 4);
+        REQUIRE(server.wait(0));
+        REQUIRE(server.poll() == 4);
+        REQUIRE(server.poll() == 0);
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(client.receive(codes, 0));
+            REQUIRE(codes.size() == 4);
+            REQUIRE(codes[0] == IBAN::ValidationCode::Valid);
+            REQUIRE(codes[1] == IBAN::ValidationCode::Invalid);
+            REQUIRE(codes[2] == (i % 2 == 1 ? IBAN::ValidationCode::NationalInvalid
+                                            : IBAN::ValidationCode::Valid));
+            REQUIRE(codes[3] == IBAN::ValidationCode::Malformed);
+        }
+        REQUIRE(client.getPendingCount() == 0);
+
+        // zero-copy requests are written into the slot directly
+        IBAN::SharedMemorySlot* slot = client.acquire();
+        REQUIRE(slot != nullptr);
+        std::memcpy(slot->ibans[0], "GB82WEST12345698765432", 22);
+        slot->lengths[0] = 22;
+        slot->count = 1;
+        slot->flags = 0;
+        client.commit();
+        REQUIRE(server.poll() == 1);
+        const IBAN::SharedMemorySlot* response = client.peek(0);
+        REQUIRE(response != nullptr);
+        REQUIRE(response->codes[0] == IBAN::ValidationCode::Valid);
+        client.release();
+    }
+
+    // a client that terminates without detaching is replaced, once the
+    // server answered the requests it left behind
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        IBAN::SharedMemoryClient* leaked = new IBAN::SharedMemoryClient("/libiban_test_ring");
+        leaked->submit({"DE89370400440532013000"});
+        _exit(0);
+    }
+    int status = 0;
+    REQUIRE(waitpid(child, &status, 0) == child);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE_THROWS_AS(IBAN::SharedMemoryClient("/libiban_test_ring"),
+                      const std::runtime_error&);
+    REQUIRE(server.poll() == 1);
+
+    // a detached ring accepts a new client, which may wait for the server
+    IBAN::SharedMemoryClient client("/libiban_test_ring");
+    std::atomic<bool> stop(false);
+    std::thread worker([&server, &stop]() {
+        while (!stop) {
+            if (server.wait(10)) {
+                server.poll();
+            }
+        }
+    });
+    size_t valid = 0;
+    for (int i = 0; i < 1000; i++) {
+        REQUIRE(client.submit({"DE89370400440532013000", "DE89370400440532013001"}));
+        REQUIRE(client.receive(codes, 5000));
+        valid += codes[0] == IBAN::ValidationCode::Valid &&
+                 codes[1] == IBAN::ValidationCode::Invalid;
+    }
+    stop = true;
+    worker.join();
+    REQUIRE(valid == 1000);
+}
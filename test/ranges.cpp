@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        ranges.cpp
+ * \brief       Test file for the optional C++20 layer
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * This file tests the range adaptors and generators of \p ranges.h and the
+ * C++20 form of the literal \p _iban. It is compiled with C++20, unlike the
+ * main test file.
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+
+#include <ranges>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include "../src/ranges.h"
+#include "../src/literal.h"
+
+TEST_CASE("Range adaptors", "[ranges]") {
+    const std::string text =
+        "DE89 3704 0044 0532 0130 00\r\n"
+        "DE89370400440532013001\n"
+        "\n"
+        "gb82west12345698765432";
+
+    std::vector<std::string> valid;
+    for (const IBAN::ParsedIBAN& iban : text | IBAN::views::lines |
+                                        IBAN::views::parse | IBAN::views::valid) {
+        valid.emplace_back(iban.machineForm());
+    }
+    REQUIRE(valid.size() == 2);
+    REQUIRE(valid[0] == "DE89370400440532013000");
+    REQUIRE(valid[1] == "GB82WEST12345698765432");
+
+    auto parsed = text | IBAN::views::lines | IBAN::views::parse;
+    REQUIRE(std::ranges::distance(parsed) == 4);
+    auto first = *parsed.begin();
+    REQUIRE(first.source() == "DE89 3704 0044 0532 0130 00");
+    REQUIRE(first.countryCode() == "DE");
+    REQUIRE(first.toIBAN().getHumanReadable() == "DE89 3704 0044 0532 0130 00");
+    REQUIRE(!IBAN::ParsedIBAN("DE89370400440532013000DE89370400440532013000").valid());
+}
+
+TEST_CASE("IBAN generator", "[ranges]") {
+    size_t count = 0;
+    for (const IBAN::IBAN& iban : IBAN::generateIBANs("DE") | std::views::take(5)) {
+        REQUIRE(iban.getCountryCode() == "DE");
+        REQUIRE(iban.validate());
+        count++;
+    }
+    REQUIRE(count == 5);
+
+    // the generator composes with the other adaptors
+    auto machineForms = IBAN::generateIBANs("FR") |
+            std::views::transform([](const IBAN::IBAN& iban) {
+                return iban.getMachineForm();
+            }) | std::views::take(3);
+    for (const std::string& machineForm : machineForms) {
+        REQUIRE(IBAN::ParsedIBAN(machineForm).valid());
+    }
+}
+
+TEST_CASE("IBAN literal operator", "[literal]") {
+    using namespace IBAN::literals;
+    constexpr auto account = "DE89 3704 0044 0532 0130 00"_iban;
+    static_assert(account.length() == 22);
+    static_assert(account.getCheckDigits() == 89);
+    IBAN::IBAN iban = "gb82west12345698765432"_iban;
+    REQUIRE(iban.getMachineForm() == "GB82WEST12345698765432");
+}
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iban-count.cpp
+ * \brief       Command line tool counting the IBANs in many files
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * Counts the valid IBANs in each of many files, which are read with many
+ * reads in flight (io_uring where available), and prints the counts.
+ *
+ * Usage: iban-count [-q depth] [-b size] [-P] [-f list] [file...]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../src/filereader.h"
+#include "../src/scrubber.h"
+
+static_assert(IBAN::Scrubber::maxCarry <= IBAN::FileReader::headroom,
+              "the carry of the scrubber must fit in front of a chunk");
+
+/// State of a file being scanned
+struct FileState {
+    /// Finds the IBANs of the file
+    IBAN::Scrubber scrubber;
+    /// The bytes of the previous chunk not yet processed by the scrubber
+    char carry[IBAN::Scrubber::maxCarry];
+    /// The number of bytes in \p carry
+    size_t carryLength;
+};
+
+/**
+ * Prints usage information to standard error.
+ *
+ * @param name The name of the executable
+ */
+static void usage(const char* name) {
+    std::fprintf(stderr, "Usage: %s [-q depth] [-b size] [-P] [-f list] [file...]\n"
+            "  -q  number of reads in flight (default: 64)\n"
+            "  -b  size of the read buffers in KiB (default: 1024)\n"
+            "  -P  read with pread() instead of io_uring\n"
+            "  -f  read the paths of the files from list, one per line\n", name);
+}
+
+int main(int argc, char** argv) {
+    unsigned depth = 64;
+    size_t bufferSize = 1 << 20;
+    bool useUring = true;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "-q" || arg == "-b" || arg == "-f") && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (arg == "-q") {
+                depth = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+            } else if (arg == "-b") {
+                bufferSize = std::strtoul(value, nullptr, 10) * 1024;
+            } else {
+                std::ifstream list(value);
+                if (!list) {
+                    std::perror(value);
+                    return 1;
+                }
+                std::string line;
+                while (std::getline(list, line)) {
+                    if (!line.empty()) {
+                        paths.push_back(line);
+                    }
+                }
+            }
+        } else if (arg == "-P") {
+            useUring = false;
+        } else if (arg[0] != '-') {
+            paths.push_back(arg);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // the scrubber masks the IBANs in the read buffers, which are not
+    // needed afterwards, and counts them
+    std::vector<FileState> states(paths.size(), FileState{IBAN::Scrubber(), {}, 0});
+    bool failed = false;
+    size_t total = 0;
+    IBAN::FileReader reader(bufferSize, depth, useUring);
+    reader.readFiles(paths, [&](IBAN::FileChunk& chunk) {
+        if (chunk.error != 0) {
+            std::fprintf(stderr, "%s: %s\n", paths[chunk.file].c_str(),
+                         std::strerror(chunk.error));
+            failed = true;
+            return;
+        }
+        FileState& state = states[chunk.file];
+        char* data = chunk.data - state.carryLength;
+        std::memcpy(data, state.carry, state.carryLength);
+        size_t length = state.carryLength + chunk.length;
+        size_t done = state.scrubber.scrub(data, length, chunk.last);
+        state.carryLength = length - done;
+        std::memcpy(state.carry, data + done, state.carryLength);
+        if (chunk.last) {
+            size_t count = state.scrubber.getMaskedCount();
+            total += count;
+            std::printf("%zu %s\n", count, paths[chunk.file].c_str());
+        }
+    });
+    if (paths.size() > 1) {
+        std::printf("%zu total\n", total);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iban-csv.cpp
+ * \brief       Command line tool validating an IBAN column of CSV files
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * Validates the IBANs of one column of a CSV file in parallel. Either writes
+ * the file with two appended columns (status and IBAN in machine form) to
+ * standard output, or a validity bitmap with one bit per row to a file.
+ *
+ * Usage: iban-csv -c column [-d separator] [-H] [-j threads] [-a cpus] [-s]
+ *                 [-b bitmap] file
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/csvscanner.h"
+#include "../src/mappedfile.h"
+#include "../src/threadpool.h"
+
+/// Approximate size of the chunks converted by a worker at once
+static const size_t chunkSize = 1 << 22;
+
+/// Number of chunks per worker converted before the output is written
+static const size_t chunksPerWorker = 4;
+
+/**
+ * Prints usage information to standard error.
+ *
+ * @param name The name of the executable
+ */
+static void usage(const char* name) {
+    std::fprintf(stderr, "Usage: %s -c column [-d separator] [-H] [-j threads] [-a cpus] [-s]\n"
+            "       [-b bitmap] file\n"
+            "  -c  index of the IBAN column, counted from 0\n"
+            "  -d  field separator (default: ,)\n"
+            "  -H  the first row is a header\n"
+            "  -j  number of threads (default: number of hardware threads)\n"
+            "  -a  comma separated list of CPUs to pin the threads to\n"
+            "  -s  print the utilization of the threads\n"
+            "  -b  write a validity bitmap (bit i %% 8 of byte i / 8 for row i)\n"
+            "      to the file instead of the annotated CSV\n", name);
+}
+
+/**
+ * Appends a row with the status and the IBAN in machine form to a buffer.
+ *
+ * @param field The field of the IBAN column
+ * @param separator The field separator
+ * @param output The buffer
+ */
+static void appendRow(const IBAN::CSVField& field, char separator,
+                      std::string& output) {
+    output.append(field.line, field.lineLength);
+    output.push_back(separator);
+    output.append(field.valid ? "valid" : "invalid");
+    output.push_back(separator);
+    if (field.valid) {
+        for (size_t i = 0; i < field.length; i++) {
+            if (field.value[i] != ' ') {
+                output.push_back(static_cast<char>(
+                        std::toupper(static_cast<unsigned char>(field.value[i]))));
+            }
+        }
+    }
+    output.push_back('\n');
+}
+
+/**
+ * Parses a comma separated list of CPU numbers.
+ *
+ * @param list The list
+ * @return The CPU numbers
+ */
+static std::vector<int> parseCPUs(const char* list) {
+    std::vector<int> cpus;
+    char* end = nullptr;
+    for (const char* pos = list; *pos != '\0'; pos = *end == ',' ? end + 1 : end) {
+        cpus.push_back(static_cast<int>(std::strtol(pos, &end, 10)));
+        if (end == pos) {
+            break;
+        }
+    }
+    return cpus;
+}
+
+/**
+ * Writes a bitmap to a file.
+ *
+ * @param path The path of the file
+ * @param bitmap The bitmap
+ * @return \p true on success
+ */
+static bool writeBitmap(const char* path, const std::vector<unsigned char>& bitmap) {
+    std::FILE* output = std::fopen(path, "wb");
+    if (output == nullptr) {
+        std::perror(path);
+        return false;
+    }
+    bool written = std::fwrite(bitmap.data(), 1, bitmap.size(), output) == bitmap.size();
+    if (std::fclose(output) != 0 || !written) {
+        std::perror(path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Prints the utilization of the workers of a pool to standard error.
+ *
+ * @param pool The pool
+ */
+static void printUtilization(IBAN::ThreadPool& pool) {
+    std::vector<IBAN::WorkerStats> stats = pool.getStats();
+    for (size_t i = 0; i < stats.size(); i++) {
+        std::fprintf(stderr, "thread %zu: %zu chunks, %zu steals, %.1f%% busy\n",
+                     i, stats[i].chunks, stats[i].steals,
+                     100.0 * stats[i].utilization);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t column = 0;
+    char separator = ',';
+    bool header = false, haveColumn = false, printStats = false;
+    unsigned threads = 0;
+    std::vector<int> cpus;
+    const char* path = nullptr;
+    const char* bitmapPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "-c" || arg == "-d" || arg == "-j" || arg == "-a" || arg == "-b") &&
+                i + 1 < argc) {
+            const char* value = argv[++i];
+            if (arg == "-c") {
+                column = std::strtoul(value, nullptr, 10);
+                haveColumn = true;
+            } else if (arg == "-j") {
+                threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+            } else if (arg == "-b") {
+                bitmapPath = value;
+            } else if (arg == "-a") {
+                cpus = parseCPUs(value);
+            } else if (std::strlen(value) == 1 && value[0] != '"' && value[0] != '\n') {
+                separator = value[0];
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-H") {
+            header = true;
+        } else if (arg == "-s") {
+            printStats = true;
+        } else if (arg[0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!haveColumn || path == nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    try {
+        IBAN::MappedFile file(path);
+        // both modes run on the pool, so -a and -s apply to either
+        IBAN::ThreadPool pool(IBAN::ThreadPoolConfig{threads, cpus});
+        IBAN::CSVScanner scanner(column, separator, header, pool);
+
+        if (bitmapPath != nullptr) {
+            std::vector<unsigned char> bitmap;
+            size_t rows = scanner.validateColumn(file.data(), file.size(), bitmap);
+            size_t valid = 0;
+            for (unsigned char byte : bitmap) {
+                valid += static_cast<size_t>(__builtin_popcount(byte));
+            }
+            std::fprintf(stderr, "%zu rows, %zu valid\n", rows, valid);
+            if (printStats) {
+                printUtilization(pool);
+            }
+            return writeBitmap(bitmapPath, bitmap) ? 0 : 1;
+        }
+
+        // the chunks are converted in rounds of a few chunks per worker and
+        // written in order, which bounds the memory used for the output;
+        // workers finishing early steal chunks of slower ones
+        const size_t round = threads * chunksPerWorker;
+        std::vector<IBAN::CSVChunk> chunks = scanner.split(
+                file.data(), file.size(),
+                std::max<size_t>(round, file.size() / chunkSize));
+        if (header && file.size() > 0) {
+            const void* end = std::memchr(file.data(), '\n', file.size());
+            size_t length = end == nullptr ? file.size() :
+                    static_cast<size_t>(static_cast<const char*>(end) - file.data());
+            if (length > 0 && file.data()[length - 1] == '\r') {
+                length--;
+            }
+            std::string line(file.data(), length);
+            line += std::string(1, separator) + "iban_status" + separator + "iban\n";
+            std::fwrite(line.data(), 1, line.size(), stdout);
+        }
+        std::vector<std::string> outputs(round);
+        for (size_t first = 0; first < chunks.size(); first += round) {
+            size_t count = std::min(round, chunks.size() - first);
+            pool.parallelFor(count, 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    std::string& output = outputs[i];
+                    const IBAN::CSVChunk& chunk = chunks[first + i];
+                    output.clear();
+                    output.reserve(chunk.end - chunk.begin + chunk.rows * 48);
+                    scanner.scanChunk(file.data(), chunk,
+                                      [&](const IBAN::CSVField& field) {
+                        appendRow(field, separator, output);
+                    });
+                }
+            });
+            for (size_t i = 0; i < count; i++) {
+                if (std::fwrite(outputs[i].data(), 1, outputs[i].size(), stdout) !=
+                        outputs[i].size()) {
+                    std::perror("write");
+                    return 1;
+                }
+            }
+        }
+        if (printStats) {
+            std::fflush(stdout);
+            printUtilization(pool);
+        }
+    } catch (const std::runtime_error& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
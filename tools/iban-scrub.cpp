@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iban-scrub.cpp
+ * \brief       Command line tool masking IBANs in text streams
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * Reads a text stream from a file or from standard input, masks all valid
+ * IBANs and writes the result to standard output.
+ *
+ * Usage: iban-scrub [-l leading] [-t trailing] [-m char] [file]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/scrubber.h"
+
+/// Size of the blocks read from the input stream
+static const size_t blockSize = 1 << 20;
+
+/**
+ * Prints usage information to standard error.
+ *
+ * @param name The name of the executable
+ */
+static void usage(const char* name) {
+    std::fprintf(stderr, "Usage: %s [-l leading] [-t trailing] [-m char] [file]\n"
+            "  -l  number of leading characters to keep (default: 2)\n"
+            "  -t  number of trailing characters to keep (default: 4)\n"
+            "  -m  character used for masking (default: *)\n", name);
+}
+
+int main(int argc, char** argv) {
+    size_t leading = 2, trailing = 4;
+    char maskChar = '*';
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "-l" || arg == "-t" || arg == "-m") && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (arg == "-l") {
+                leading = std::strtoul(value, nullptr, 10);
+            } else if (arg == "-t") {
+                trailing = std::strtoul(value, nullptr, 10);
+            } else if (std::strlen(value) == 1) {
+                maskChar = value[0];
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg[0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::FILE* input = stdin;
+    if (path != nullptr) {
+        input = std::fopen(path, "rb");
+        if (input == nullptr) {
+            std::perror(path);
+            return 1;
+        }
+    }
+
+    IBAN::Scrubber scrubber(leading, trailing, maskChar);
+    std::vector<char> buffer(blockSize + IBAN::Scrubber::maxCarry);
+    size_t carry = 0;
+    bool final = false;
+    while (!final) {
+        size_t read = std::fread(buffer.data() + carry, 1, blockSize, input);
+        final = read < blockSize;
+        size_t length = carry + read;
+        size_t done = scrubber.scrub(buffer.data(), length, final);
+        if (std::fwrite(buffer.data(), 1, done, stdout) != done) {
+            std::perror("write");
+            return 1;
+        }
+        carry = length - done;
+        std::memmove(buffer.data(), buffer.data() + done, carry);
+    }
+
+    if (std::ferror(input)) {
+        std::perror(path != nullptr ? path : "stdin");
+        return 1;
+    }
+    if (input != stdin) {
+        std::fclose(input);
+    }
+    return 0;
+}
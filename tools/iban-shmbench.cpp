@@ -0,0 +1,244 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iban-shmbench.cpp
+ * \brief       Command line tool measuring the latency of validation requests
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * Sends batches of IBANs one at a time and prints the distribution of the
+ * round trip times. By default, the batches are sent through a shared memory
+ * ring to a server process forked by the tool; \p -m uses the ring of a
+ * running \p iband and \p -s its Unix domain socket instead, for comparison.
+ *
+ * Usage: iban-shmbench [-n batches] [-b size] [-m name | -s socket]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../src/protocol.h"
+#include "../src/sharedmemory.h"
+
+/**
+ * Prints usage information to standard error.
+ *
+ * @param name The name of the executable
+ */
+static void usage(const char* name) {
+    std::fprintf(stderr, "Usage: %s [-n batches] [-b size] [-m name | -s socket]\n"
+            "  -n  number of batches to send (default: 100000)\n"
+            "  -b  number of IBANs per batch (default: 16, at most 64)\n"
+            "  -m  use the shared memory object of a running iband\n"
+            "  -s  use the Unix domain socket of a running iband\n", name);
+}
+
+/**
+ * Connects to a Unix domain socket.
+ *
+ * @param path The path of the socket
+ * @return The connection or -1
+ */
+static int connectUnix(const char* path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Sends a request through a socket and waits for its response.
+ *
+ * @param fd The connection
+ * @param request The request frame
+ * @param buffer Buffer for the response
+ * @param codes Receives the result codes
+ * @return \p false if the connection failed
+ */
+static bool roundTrip(int fd, const std::string& request, std::string& buffer,
+                      std::vector<IBAN::ValidationCode>& codes) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+            static_cast<ssize_t>(request.size())) {
+        return false;
+    }
+    buffer.clear();
+    size_t frame = 0;
+    char block[4096];
+    while ((frame = IBAN::findFrame(buffer.data(), buffer.size())) == 0) {
+        ssize_t result = recv(fd, block, sizeof(block), 0);
+        if (result <= 0) {
+            return false;
+        }
+        buffer.append(block, static_cast<size_t>(result));
+    }
+    uint32_t id = 0;
+    return frame != IBAN::malformedFrame &&
+           IBAN::parseResponse(buffer.data() + IBAN::frameHeaderLength,
+                               frame - IBAN::frameHeaderLength, id, codes);
+}
+
+int main(int argc, char** argv) {
+    size_t batches = 100000, batchSize = 16;
+    const char* sharedMemoryName = nullptr;
+    const char* socketPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "-n" || arg == "-b" || arg == "-m" || arg == "-s") && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (arg == "-n") {
+                batches = std::strtoul(value, nullptr, 10);
+            } else if (arg == "-b") {
+                batchSize = std::strtoul(value, nullptr, 10);
+            } else if (arg == "-m") {
+                sharedMemoryName = value;
+            } else {
+                socketPath = value;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (batches == 0 || batchSize == 0 || batchSize > IBAN::slotCapacity ||
+            (sharedMemoryName != nullptr && socketPath != nullptr)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char* samples[] = {"DE89370400440532013000", "GB82WEST12345698765432",
+                             "FR1420041010050500013M02606", "DE89370400440532013001"};
+    std::vector<std::string> ibans;
+    for (size_t i = 0; i < batchSize; i++) {
+        ibans.push_back(samples[i % 4]);
+    }
+
+    // without a running daemon, a forked child answers the requests
+    std::string name = sharedMemoryName != nullptr ? sharedMemoryName
+                       : "/iban-shmbench-" + std::to_string(getpid());
+    std::unique_ptr<IBAN::SharedMemoryServer> server;
+    pid_t child = -1;
+    std::unique_ptr<IBAN::SharedMemoryClient> client;
+    int fd = -1;
+    try {
+        if (socketPath != nullptr) {
+            fd = connectUnix(socketPath);
+            if (fd < 0) {
+                std::perror(socketPath);
+                return 1;
+            }
+        } else {
+            if (sharedMemoryName == nullptr) {
+                server.reset(new IBAN::SharedMemoryServer(name));
+                child = fork();
+                if (child < 0) {
+                    std::perror("fork");
+                    return 1;
+                }
+                if (child == 0) {
+                    while (true) {
+                        if (server->wait(-1)) {
+                            server->poll();
+                        }
+                    }
+                }
+            }
+            client.reset(new IBAN::SharedMemoryClient(name));
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::string request, buffer;
+    IBAN::appendRequest(request, 0, ibans);
+    std::vector<IBAN::ValidationCode> codes;
+    std::vector<double> latencies;
+    latencies.reserve(batches);
+    size_t valid = 0;
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < batches && !failed; i++) {
+        auto before = std::chrono::steady_clock::now();
+        if (client) {
+            failed = !client->submit(ibans) || !client->receive(codes, 1000);
+        } else {
+            failed = !roundTrip(fd, request, buffer, codes);
+        }
+        auto after = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+        valid += static_cast<size_t>(std::count(codes.begin(), codes.end(),
+                                                IBAN::ValidationCode::Valid));
+    }
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    client.reset();
+    if (child > 0) {
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (failed) {
+        std::fprintf(stderr, "request %zu failed\n", latencies.size());
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1,
+                                  static_cast<size_t>(p * static_cast<double>(latencies.size())))];
+    };
+    std::printf("%s: %zu batches of %zu IBANs, %zu valid\n",
+                socketPath != nullptr ? "socket" : "shared memory", batches, batchSize, valid);
+    std::printf("throughput: %.0f batches/s, %.0f IBANs/s\n",
+                static_cast<double>(batches) / seconds,
+                static_cast<double>(batches * batchSize) / seconds);
+    std::printf("latency (us): p50 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+                percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+    return 0;
+}
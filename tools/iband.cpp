@@ -0,0 +1,444 @@
+/*
+ * MIT License
+ * Copyright (c) 2017 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file        iband.cpp
+ * \brief       Validation daemon serving local clients
+ * \author      Kevin Kirchner
+ * \date        2017
+ * \copyright   MIT LICENSE
+ *
+ * Listens on a Unix domain socket (and optionally on a TCP port of the
+ * loopback interface) and validates batches of IBANs sent with the binary
+ * protocol declared in \p protocol.h. Clients may pipeline requests; all
+ * complete requests received on a connection are answered with a single
+ * write. Every thread runs an epoll loop of its own. With \p -m, a further
+ * thread answers requests of a co-located client through the shared memory
+ * ring declared in \p sharedmemory.h.
+ *
+ * Usage: iband [-s socket] [-p port] [-j threads] [-m name]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../src/protocol.h"
+#include "../src/sharedmemory.h"
+
+/// Size of the blocks read from a connection
+static const size_t readSize = 1 << 16;
+
+/// Size of the pending responses above which a connection is not read from
+static const size_t outputHighWater = 1 << 20;
+
+/// Maximum size of the unprocessed input of a connection: one incomplete
+/// frame of maximum size plus one block
+static const size_t inputLimit = IBAN::frameHeaderLength + IBAN::maxPayloadLength + readSize;
+
+static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "the stop flag is set by a signal handler");
+
+/// Set by the signal handler to stop the daemon, read by every thread
+static std::atomic<bool> stopRequested(false);
+
+/// State of a client connection
+struct Connection {
+    /// Received data not yet processed
+    std::string input;
+    /// Responses not yet written
+    std::string output;
+    /// Number of bytes of \p output already written
+    size_t written;
+    /// The events the connection is registered for
+    uint32_t events;
+    /// Whether the client shut down its side, so only responses are written
+    bool inputClosed;
+};
+
+/**
+ * Prints usage information to standard error.
+ *
+ * @param name The name of the executable
+ */
+static void usage(const char* name) {
+    std::fprintf(stderr, "Usage: %s [-s socket] [-p port] [-j threads] [-m name]\n"
+            "  -s  path of the Unix domain socket (default: /tmp/iband.sock)\n"
+            "  -p  also listen on this TCP port of the loopback interface\n"
+            "  -j  number of threads (default: number of hardware threads)\n"
+            "  -m  also serve the shared memory object with this name\n", name);
+}
+
+/**
+ * Stops the daemon on SIGINT and SIGTERM.
+ */
+static void handleSignal(int) {
+    stopRequested.store(true);
+}
+
+/**
+ * Creates a non-blocking listening Unix domain socket.
+ *
+ * @param path The path of the socket
+ * @return The socket or -1
+ */
+static int listenUnix(const char* path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(fd, SOMAXCONN) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Creates a non-blocking listening TCP socket on the loopback interface.
+ *
+ * @param port The port
+ * @return The socket or -1
+ */
+static int listenTCP(unsigned short port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int enable = 1;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+            bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(fd, SOMAXCONN) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Writes as much of the pending responses of a connection as possible.
+ *
+ * @param fd The connection
+ * @param connection The state of the connection
+ * @return \p false if the connection failed
+ */
+static bool flushOutput(int fd, Connection& connection) {
+    while (connection.written < connection.output.size()) {
+        ssize_t result = send(fd, connection.output.data() + connection.written,
+                              connection.output.size() - connection.written,
+                              MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.written += static_cast<size_t>(result);
+    }
+    connection.output.clear();
+    connection.written = 0;
+    return true;
+}
+
+/**
+ * Answers all complete requests received on a connection.
+ *
+ * @param connection The state of the connection
+ * @return \p false if a request was malformed
+ */
+static bool answerRequests(Connection& connection) {
+    // answer every complete request, so pipelined requests share a write
+    size_t pos = 0;
+    while (true) {
+        size_t frame = IBAN::findFrame(connection.input.data() + pos,
+                                       connection.input.size() - pos);
+        if (frame == 0) {
+            break;
+        }
+        if (frame == IBAN::malformedFrame ||
+                !IBAN::handleRequest(connection.input.data() + pos + IBAN::frameHeaderLength,
+                                     frame - IBAN::frameHeaderLength, connection.output)) {
+            return false;
+        }
+        pos += frame;
+    }
+    connection.input.erase(0, pos);
+    return true;
+}
+
+/**
+ * Reads from a connection and answers all complete requests. Reading stops
+ * while more than \p outputHighWater bytes of responses are pending, so a
+ * client that does not read its responses cannot make the daemon buffer
+ * without bound; the input never exceeds \p inputLimit. At the end of the
+ * input the connection is marked as half closed and kept until its responses
+ * are written.
+ *
+ * @param fd The connection
+ * @param connection The state of the connection
+ * @return \p false if the connection is broken
+ */
+static bool handleInput(int fd, Connection& connection) {
+    // the input holds at most one incomplete frame, so a block always fits
+    while (connection.output.size() - connection.written <= outputHighWater &&
+           connection.input.size() + readSize <= inputLimit) {
+        size_t size = connection.input.size();
+        connection.input.resize(size + readSize);
+        ssize_t result = recv(fd, &connection.input[size], readSize, 0);
+        connection.input.resize(size + static_cast<size_t>(std::max<ssize_t>(result, 0)));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result == 0) {
+            connection.inputClosed = true;
+            break;
+        }
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        if (!answerRequests(connection)) {
+            return false;
+        }
+    }
+    return flushOutput(fd, connection);
+}
+
+/**
+ * Returns the events a connection waits for: readable unless its input ended
+ * or too many responses are pending, writable while responses are pending.
+ *
+ * @param connection The state of the connection
+ * @return The epoll events
+ */
+static uint32_t getEvents(const Connection& connection) {
+    size_t pending = connection.output.size() - connection.written;
+    bool reading = !connection.inputClosed && pending <= outputHighWater;
+    return (reading ? EPOLLIN | EPOLLRDHUP : 0u) | (pending > 0 ? EPOLLOUT : 0u);
+}
+
+/**
+ * Runs the epoll loop of a thread.
+ *
+ * @param listeners The listening sockets
+ */
+static void serve(const std::vector<int>& listeners) {
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll < 0) {
+        std::perror("epoll_create1");
+        return;
+    }
+    for (int listener : listeners) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        // only one of the threads is woken for a new connection
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.fd = listener;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+    }
+
+    std::unordered_map<int, Connection> connections;
+    std::vector<epoll_event> events(256);
+    while (!stopRequested) {
+        int count = epoll_wait(epoll, events.data(), static_cast<int>(events.size()), 200);
+        for (int i = 0; i < count; i++) {
+            int fd = events[static_cast<size_t>(i)].data.fd;
+            bool listener = false;
+            for (int candidate : listeners) {
+                listener = listener || candidate == fd;
+            }
+            if (listener) {
+                int client;
+                while ((client = accept4(fd, nullptr, nullptr,
+                                         SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    int enable = 1;
+                    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                    epoll_event event;
+                    std::memset(&event, 0, sizeof(event));
+                    event.events = EPOLLIN | EPOLLRDHUP;
+                    event.data.fd = client;
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, client, &event);
+                    connections[client] = Connection{"", "", 0, EPOLLIN | EPOLLRDHUP, false};
+                }
+                continue;
+            }
+
+            Connection& connection = connections[fd];
+            bool alive = (events[static_cast<size_t>(i)].events & (EPOLLERR | EPOLLHUP)) == 0;
+            if (alive && (events[static_cast<size_t>(i)].events & EPOLLOUT) != 0) {
+                alive = flushOutput(fd, connection);
+            }
+            if (alive && !connection.inputClosed &&
+                    (events[static_cast<size_t>(i)].events & (EPOLLIN | EPOLLRDHUP)) != 0) {
+                alive = handleInput(fd, connection);
+            }
+            // a half closed connection is closed once its responses are written
+            if (!alive || (connection.inputClosed && connection.output.empty())) {
+                epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                connections.erase(fd);
+                continue;
+            }
+            uint32_t wanted = getEvents(connection);
+            if (wanted != connection.events) {
+                epoll_event event;
+                std::memset(&event, 0, sizeof(event));
+                event.events = wanted;
+                event.data.fd = fd;
+                epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &event);
+                connection.events = wanted;
+            }
+        }
+    }
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    close(epoll);
+}
+
+/**
+ * Answers the requests written into a shared memory ring.
+ *
+ * @param server The server of the ring
+ */
+static void serveSharedMemory(IBAN::SharedMemoryServer* server) {
+    while (!stopRequested) {
+        if (server->wait(200)) {
+            server->poll();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* socketPath = "/tmp/iband.sock";
+    unsigned long port = 0;
+    unsigned threads = 0;
+    const char* sharedMemoryName = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if ((arg == "-s" || arg == "-p" || arg == "-j" || arg == "-m") && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (arg == "-s") {
+                socketPath = value;
+            } else if (arg == "-p") {
+                port = std::strtoul(value, nullptr, 10);
+            } else if (arg == "-m") {
+                sharedMemoryName = value;
+            } else {
+                threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (port > 65535) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<int> listeners;
+    int unixSocket = listenUnix(socketPath);
+    if (unixSocket < 0) {
+        std::perror(socketPath);
+        return 1;
+    }
+    listeners.push_back(unixSocket);
+    if (port != 0) {
+        int tcpSocket = listenTCP(static_cast<unsigned short>(port));
+        if (tcpSocket < 0) {
+            std::perror("tcp");
+            return 1;
+        }
+        listeners.push_back(tcpSocket);
+    }
+    std::unique_ptr<IBAN::SharedMemoryServer> sharedMemory;
+    if (sharedMemoryName != nullptr) {
+        try {
+            sharedMemory.reset(new IBAN::SharedMemoryServer(sharedMemoryName));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handleSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(serve, std::cref(listeners));
+    }
+    if (sharedMemory) {
+        workers.emplace_back(serveSharedMemory, sharedMemory.get());
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (int listener : listeners) {
+        close(listener);
+    }
+    unlink(socketPath);
+    return 0;
+}